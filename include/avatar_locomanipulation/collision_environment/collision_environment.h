@@ -7,9 +7,33 @@
 #include <avatar_locomanipulation/models/robot_model.hpp>
 // Directed Vectors
 #include <avatar_locomanipulation/collision_environment/directed_vectors.hpp>
+// Signed Distance Fields
+#include <avatar_locomanipulation/collision_environment/signed_distance_field.hpp>
+// Capsule Proxies
+#include <avatar_locomanipulation/collision_environment/collision_proxies.hpp>
 #include <math.h>
 
 
+// Narrowphase result of a collision pair kept between queries for temporal coherence.
+// The nearest points are in world frame at the link placements oMfirst and oMsecond of the query,
+// first_point lies on pair.first and second_point on pair.second.
+struct PairDistanceCache{
+public:
+  bool valid = false;
+  double distance;
+  Eigen::Vector3d first_point;
+  Eigen::Vector3d second_point;
+  pinocchio::SE3 oMfirst;
+  pinocchio::SE3 oMsecond;
+};
+
+// Sphere of the sphere set approximating a collision body, expressed in the frame of the body
+struct CollisionSphere{
+public:
+  Eigen::Vector3d center;
+  double radius;
+};
+
 
 class CollisionEnvironment
 {
@@ -44,6 +68,84 @@ private:
   // subsequently appends object onto end of appended
   void append_models();
 
+  // Row i holds the collision pair index of collision body i with every other body of appended,
+  // -1 if the two bodies are not a collision pair: collision_pair_table[i*num_collision_links + j]
+  std::vector<int> collision_pair_table;
+  int num_collision_links = 0;
+
+  // Collision body name (i.e. rightPalm_0) to its geometry id in appended
+  std::map<std::string, int> collision_name_to_id;
+
+  // Rebuilds collision_pair_table and collision_name_to_id from appended->geomModel
+  // called by append_models every time appended is rebuilt
+  void build_collision_pair_tables();
+
+  // Axis aligned bounding box of each collision body in its own frame, as center and half extents
+  std::vector<Eigen::Vector3d> local_aabb_centers;
+  std::vector<Eigen::Vector3d> local_aabb_half_extents;
+
+  // Radius about the collision body frame origin containing its local AABB
+  std::vector<double> link_bounding_radii;
+
+  // Distance cache indexed by collision pair index, see enable_distance_cache
+  std::vector<PairDistanceCache> pair_distance_cache;
+  bool use_distance_cache = false;
+  int num_cached_pairs = 0;
+
+  // Upper bound of the displacement of any point of a collision body since it was at the placement oMg_cached
+  double get_link_motion_bound(int link_id, const pinocchio::SE3 & oMg_cached);
+
+  // Broadphase settings and counters
+  bool use_broadphase = false;
+  double broadphase_cutoff = 0.25;
+  int num_culled_pairs = 0;
+  int num_evaluated_pairs = 0;
+
+  // Narrowphase distance query of one collision pair of find_near_points. Appends the near points to the outputs
+  void compute_near_points(int interest_link_id, int from_link_id, int pair_index, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points);
+
+  // Refits the world AABB of a collision body from its local AABB and appended->geomData->oMg
+  void get_world_aabb(int link_id, Eigen::Vector3d & center, Eigen::Vector3d & half_extents);
+
+  // Signed distance fields of the object collision bodies indexed by geometry id, null for robot links
+  std::vector< std::shared_ptr<SignedDistanceField> > object_sdfs;
+  // Sphere sets of the collision bodies indexed by geometry id, used to query the distance fields
+  std::vector< std::vector<CollisionSphere> > link_sphere_sets;
+
+  bool use_object_sdf = false;
+  double sdf_resolution = 0.02;
+  double sdf_padding = 0.3;
+  std::string sdf_cache_directory = THIS_PACKAGE_PATH"sdf_cache/";
+  int num_sdf_pairs = 0;
+
+  // Builds (or loads from the cache) the distance fields of the object collision bodies
+  void build_object_sdfs();
+  // Covers the local AABB of each collision body with spheres along its longest axis
+  void build_link_sphere_sets();
+
+  // Distance query of a pair with one object body with a distance field. Appends the near points to the outputs
+  void compute_near_points_sdf(int interest_link_id, int from_link_id, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points);
+
+  // Capsule proxies by collision body name, as loaded from the proxy file
+  std::map<std::string, std::vector<CollisionCapsule> > proxy_library;
+  // Capsule proxies indexed by geometry id, empty for bodies without proxies
+  std::vector< std::vector<CollisionCapsule> > link_proxies;
+
+  bool use_proxy_geometry = false;
+  int num_proxy_pairs = 0;
+
+  // Resolves proxy_library to geometry ids, called by build_collision_pair_tables and load_link_proxies
+  void build_link_proxies();
+  // Logs a warning for each robot collision body without a proxy
+  void warn_links_without_proxies();
+
+  // Closed-form distance query of a pair of bodies that both have proxies. Appends the near points to the outputs
+  void compute_near_points_proxy(int interest_link_id, int from_link_id, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points);
+
+  // Temporary containers of the integer id find_near_points
+  std::vector<int> tmp_list_ids, tmp_from_ids;
+  std::vector<Eigen::Vector3d> tmp_from_near_points, tmp_to_near_points;
+
 
 
   // Input: empty map string to string
@@ -113,6 +215,76 @@ public:
   //         - (Empty) map from names of "from"collision links to nearest points on the "to" objects
   void find_near_points(std::string & interest_link, const std::vector<std::string>  & list, std::map<std::string, Eigen::Vector3d> & from_near_points, std::map<std::string, Eigen::Vector3d> & to_near_points);
 
+  // Same as above with collision bodies given by their ids. Only the pairs of interest_link_id with the links in list_ids
+  // are visited. Links of list_ids which do not form a collision pair with interest_link_id are skipped.
+  // Outputs: - ids of the "from" links for which near points were found, in the order of list_ids
+  //          - nearest points on those "from" links and on the "to" link, aligned with from_ids
+  void find_near_points(int interest_link_id, const std::vector<int> & list_ids, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points);
+
+  // Integer id API. Ids are geometry ids of the appended model. They stay valid until a new object is added.
+  // Returns -1 if the collision body does not exist
+  int get_collision_link_id(const std::string & link_name);
+  // Unknown collision bodies are skipped
+  void get_collision_link_ids(const std::vector<std::string> & link_names, std::vector<int> & link_ids);
+  // Returns the collision pair index of two collision bodies, -1 if they are not a collision pair
+  int get_collision_pair_index(int link_id_a, int link_id_b);
+
+  // Broadphase of find_near_points. A pair whose world AABBs are farther apart than the cutoff is culled: its
+  // narrowphase distance query is skipped and it yields no near points. The AABB distance is a lower bound of
+  // the link distance, so with a cutoff above safety_dist_collision the culled pairs never contribute to the
+  // collision potential. If every pair of a query is culled, the pair with the closest AABBs is still evaluated.
+  // Default: disabled, with a cutoff of 0.25 once enabled
+  void enable_broadphase(bool enable);
+  void set_broadphase_cutoff(double cutoff_in);
+
+  // Temporal coherence cache of the narrowphase. Each pair keeps its latest distance and link placements. A pair is
+  // only re-evaluated once its cached distance minus the motion bound of its two links drops below the largest safety
+  // distance. Otherwise its cached near points are moved with the links: they remain points of the links, farther
+  // apart than the safety distance, so the collision potential is unchanged. Re-evaluations warm start GJK with the
+  // previous guess of the pair when hpp-fcl supports it. Default: disabled
+  void enable_distance_cache(bool enable);
+  void clear_distance_cache();
+
+  // Voxelized signed distance fields of the environment objects. When enabled, every object collision body added
+  // with add_new_object gets a distance field in its own frame, built at load time or loaded from the cache directory.
+  // Pairs between an object body and a robot link are then answered by trilinear lookups of the sphere set of the
+  // robot link instead of the narrowphase. Mesh objects have no signed field and keep the narrowphase.
+  // Default: disabled, 0.02m voxels, 0.3m padding, THIS_PACKAGE_PATH/sdf_cache/
+  void enable_object_sdf(bool enable);
+  void set_object_sdf_parameters(double resolution_in, double padding_in, const std::string & cache_directory_in);
+
+  // Proxy geometry of the robot links. When enabled, pairs of collision bodies that both have capsule proxies are answered
+  // by closed-form capsule distances instead of GJK on the collision geometry. Bodies without proxies keep their geometry.
+  // Disable the proxies to validate a final solution against the collision meshes. Default: disabled
+  void enable_proxy_geometry(bool enable);
+  bool using_proxy_geometry();
+
+  // Loads the capsule proxies of the collision bodies, i.e. THIS_PACKAGE_PATH"models/valkyrie_collision_proxies.yaml"
+  // Robot bodies missing from the file are logged with a warning and their pairs fall back to the collision mesh
+  bool load_link_proxies(const std::string & filename);
+
+  // Fits capsule proxies to the collision geometry of every robot collision body and saves them to filename
+  bool fit_link_proxies(const std::string & filename);
+
+  /* get_point_jacobians
+  Input: - the robot model, with its kinematics and jacobians updated at the configuration of the directed vector
+         - a directed vector
+  Output: - the world frame jacobians (3 x nv) of dvec.from_point and dvec.to_point, rigidly attached to the frames
+            dvec.from and dvec.to. Frames that are not part of robot_model (i.e. object frames) have a zero jacobian.
+  The jacobian of dvec.magnitude is dvec.direction^T (J_to - J_from).
+  */
+  void get_point_jacobians(std::shared_ptr<RobotModel> & robot_model, const DirectedVectors & dvec, Eigen::MatrixXd & J_from, Eigen::MatrixXd & J_to);
+
+  // Counters of pairs culled by the broadphase, pairs evaluated by the narrowphase, pairs served by the distance cache,
+  // pairs answered by the distance fields and pairs answered by the proxies
+  int get_num_culled_pairs();
+  int get_num_evaluated_pairs();
+  int get_num_cached_pairs();
+  int get_num_sdf_pairs();
+  int get_num_proxy_pairs();
+  void reset_pair_counters();
+  void print_pair_counters();
+
 
   // Given a frame name from a task it will build the directed vectors to that link
   // Input: - Relevant frame name from the task_selfcollision
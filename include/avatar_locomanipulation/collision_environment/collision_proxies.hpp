@@ -0,0 +1,51 @@
+#ifndef ALM_COLLISION_PROXIES_H
+#define ALM_COLLISION_PROXIES_H
+
+#include <Configuration.h> // Package Path
+#include <avatar_locomanipulation/enable_pinocchio_with_hpp_fcl.h> // Enable HPP FCL
+#include "pinocchio/multibody/geometry.hpp"
+
+#include <Eigen/Dense>
+#include <map>
+#include <string>
+#include <vector>
+
+// Capsule proxy of a collision body, expressed in the frame of the body.
+// The capsule is the set of points within radius of the segment [a, b]. It is a sphere when a = b.
+struct CollisionCapsule{
+public:
+  Eigen::Vector3d a;
+  Eigen::Vector3d b;
+  double radius;
+};
+
+// Proxy geometry of the collision bodies: per body capsule sets that cover the collision geometry,
+// with closed-form distances. The proxy files map collision body names (i.e. rightPalm_0) to their capsules.
+namespace collision_proxies{
+  // Covers a collision geometry with capsules. Spheres, capsules and cylinders are covered exactly by one capsule,
+  // boxes by one capsule (or parallel strips for flat boxes) along their longest axis, meshes by one capsule
+  // along the principal axis of their vertices. Returns false if the geometry type is unknown and its AABB was used.
+  bool fit_geometry(const pinocchio::fcl::CollisionGeometry & geometry, std::vector<CollisionCapsule> & capsules);
+
+  // Smallest capsule about the line center + t*axis containing all points, or the bounding sphere about center
+  // if it has a smaller volume
+  void fit_points(const std::vector<Eigen::Vector3d> & points, const Eigen::Vector3d & center, const Eigen::Vector3d & axis, CollisionCapsule & capsule);
+
+  // Closest points of the segments [p1, q1] and [p2, q2]
+  void closest_points_segments(const Eigen::Vector3d & p1, const Eigen::Vector3d & q1, const Eigen::Vector3d & p2, const Eigen::Vector3d & q2,
+                               Eigen::Vector3d & c1, Eigen::Vector3d & c2);
+
+  /* capsule_set_distance
+  Input: - the capsule sets of two bodies and the world placements of the bodies
+  Output: - the nearest points (world frame) on the surfaces of the closest pair of capsules
+          - returns the signed distance between the two sets, negative when they penetrate
+  */
+  double capsule_set_distance(const std::vector<CollisionCapsule> & capsules_1, const pinocchio::SE3 & oM1,
+                              const std::vector<CollisionCapsule> & capsules_2, const pinocchio::SE3 & oM2,
+                              Eigen::Vector3d & near_point_1, Eigen::Vector3d & near_point_2);
+
+  bool save_proxies(const std::string & filename, const std::map<std::string, std::vector<CollisionCapsule> > & proxies);
+  bool load_proxies(const std::string & filename, std::map<std::string, std::vector<CollisionCapsule> > & proxies);
+}
+
+#endif
@@ -16,6 +16,9 @@ public:
   	// If two links are in collision, rather than near collision, this is set true
   	//  and the safety_distance is set to 0.15. When not in collision, safety distance is the 0.075
   	bool using_worldFramePose;
+	// near points (world frame) on the from and to links the vector was built from
+	Eigen::Vector3d from_point;
+	Eigen::Vector3d to_point;
 };
 
 
@@ -0,0 +1,29 @@
+#ifndef ALM_FCL_MESH_VERTICES_H
+#define ALM_FCL_MESH_VERTICES_H
+
+#include <avatar_locomanipulation/enable_pinocchio_with_hpp_fcl.h> // Enable HPP FCL
+#include "pinocchio/multibody/geometry.hpp"
+#include "hpp/fcl/BVH/BVH_model.h"
+
+#include <Eigen/Dense>
+
+// hpp-fcl >= 3 stores the mesh vertices in a shared std::vector instead of a raw array
+#ifdef HPP_FCL_VERSION_AT_LEAST
+#if HPP_FCL_VERSION_AT_LEAST(3,0,0)
+#define FCL_MESH_VERTICES_SHARED_VECTOR
+#endif
+#endif
+
+namespace fcl_mesh{
+  // Vertex i of the mesh, in the frame of the mesh
+  inline Eigen::Vector3d get_vertex(const pinocchio::fcl::BVHModelBase & mesh, int i){
+#ifdef FCL_MESH_VERTICES_SHARED_VECTOR
+    const pinocchio::fcl::Vec3f & vertex = (*mesh.vertices)[i];
+#else
+    const pinocchio::fcl::Vec3f & vertex = mesh.vertices[i];
+#endif
+    return Eigen::Vector3d(vertex[0], vertex[1], vertex[2]);
+  }
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef ALM_SIGNED_DISTANCE_FIELD_H
+#define ALM_SIGNED_DISTANCE_FIELD_H
+
+#include <Configuration.h> // Package Path
+#include <avatar_locomanipulation/enable_pinocchio_with_hpp_fcl.h> // Enable HPP FCL
+#include "pinocchio/multibody/geometry.hpp"
+
+#include <Eigen/Dense>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// Voxelized distance field of a static collision geometry, expressed in the frame of the geometry.
+// Distances are sampled at the voxel corners over the local AABB of the geometry padded by a margin,
+// and queried with trilinear interpolation. Queries outside the grid add the distance to the grid.
+//
+// Fields are cached on disk in cache_directory/sdf_<key>.bin, where the key hashes the geometry content
+// (type, local AABB and mesh vertices) together with the resolution and padding.
+class SignedDistanceField{
+public:
+  SignedDistanceField();
+  ~SignedDistanceField();
+
+  /* build
+  Input: - distance function of a point in the geometry frame. Negative inside the geometry.
+         - local AABB of the geometry
+         - voxel size and margin around the AABB
+  */
+  void build(const std::function<double(const Eigen::Vector3d &)> & distance_function,
+             const Eigen::Vector3d & aabb_min, const Eigen::Vector3d & aabb_max, double resolution_in, double padding_in);
+
+  /* buildFromGeometry
+  Samples the hpp-fcl distance of the geometry to a point. The field is signed for shapes (box, cylinder, ...) for which
+  hpp-fcl reports the penetration depth. For meshes it is the unsigned distance to the surface.
+  If cache_directory is not empty, the field is loaded from the cache when available and saved to it otherwise.
+  Returns true if the field was loaded from the cache.
+  */
+  bool buildFromGeometry(const pinocchio::fcl::CollisionGeometry & geometry, double resolution_in, double padding_in, const std::string & cache_directory);
+
+  // Key of a geometry for the disk cache
+  static uint64_t computeGeometryKey(const pinocchio::fcl::CollisionGeometry & geometry, double resolution_in, double padding_in);
+
+  bool save(const std::string & filename);
+  // Only succeeds if the stored key matches key_in
+  bool load(const std::string & filename, uint64_t key_in);
+
+  // Distance at a point in the geometry frame
+  double getDistance(const Eigen::Vector3d & p_local);
+  // Distance and its gradient (geometry frame) at a point in the geometry frame
+  double getDistanceAndGradient(const Eigen::Vector3d & p_local, Eigen::Vector3d & gradient);
+
+  bool isBuilt();
+  uint64_t getKey();
+  double getResolution();
+  int getNumVoxels();
+
+private:
+  double getValue(int i, int j, int k);
+
+  uint64_t key = 0;
+  Eigen::Vector3d origin; // position of the voxel (0,0,0)
+  double resolution = 0.0;
+  int dims[3] = {0, 0, 0};
+  std::vector<float> values; // x fastest
+};
+
+#endif
@@ -33,6 +33,10 @@ public:
   void setManipulationType(int type);
   int getManipulationType();
 
+  // Returns an independent copy with its own interpolators (reloaded from the waypoint yaml files),
+  // so that each thread can evaluate the manipulation function concurrently.
+  std::shared_ptr<ManipulationFunction> clone();
+
 private:
   void common_initialization();
 
@@ -10,6 +10,7 @@
 #include <Configuration.h>
 #include <avatar_locomanipulation/models/robot_model.hpp>
 #include <avatar_locomanipulation/ik_module/ik_module.hpp>
+#include <avatar_locomanipulation/ik_module/batch_ik_solver.hpp>
 #include <avatar_locomanipulation/walking/walking_pattern_generator.hpp>
 #include <avatar_locomanipulation/walking/config_trajectory_generator.hpp>
 
@@ -38,6 +39,23 @@
 #define CASE_STANCE_RIGHT_FOOT 1 // Right foot stance left foot swing
 #define CASE_STANCE_DOUBLE_SUPPORT 2 // No transition
 
+// Randomized task references and IK starting configuration of a starting configuration candidate
+class StartingConfigCandidate{
+public:
+	Footstep left_footstep;
+	Footstep right_footstep;
+
+	Eigen::Vector3d swing_foot_pos;
+	Eigen::Quaterniond swing_foot_ori;
+	double swing_foot_theta_angle = 0.0;
+
+	Eigen::Vector3d pelvis_pos;
+	Eigen::Quaterniond pelvis_ori;
+
+	Eigen::VectorXd joint_pos;
+	Eigen::VectorXd q_ik_start;
+};
+
 class FeasibilityDataGenerator{
 public:
 	FeasibilityDataGenerator();
@@ -54,8 +72,12 @@ public:
 
     // Randomly generate a number from a specified interval
 	double generateRandMinMax(const double min, const double max);
-	// Generate random starting configuration 
+	// Generate random starting configuration. One candidate is sampled per thread and their IKs are solved as a batch.
+	// The first candidate, in sampling order, which converges with the CoM height within limits is used.
     bool randomizeStartingConfiguration();
+    // Number of threads used to solve the starting configuration IKs. Default 1.
+    // Must be called after setRobotModel()
+    void setNumThreads(int num_threads_in);
     // Sets the starting IK configuration
 	void setStartingIKConfig(const Eigen::VectorXd & q_ik_start_in);
 	// Randomize the foot landing configuration
@@ -106,6 +128,12 @@ public:
 	std::vector< std::shared_ptr<Task> > vec_task_stack;
 	std::shared_ptr<Task> ik_task_stack;
 
+	// Starting configuration IK batch solver. Worker 0 is ik_start_config_module on robot_model.
+	// The other workers solve the same task stack on RobotModelContexts of robot_model.
+	BatchIKSolver start_config_solver;
+	std::vector< std::shared_ptr<IKModule> > ik_start_config_worker_modules;
+	int num_threads = 1;
+
 	// Task References
 	Eigen::VectorXd joint_pos;
 	
@@ -188,6 +216,18 @@ public:
 	Eigen::VectorXd q_rand;
 
 
+	// Starting configuration candidates of the latest randomizeStartingConfiguration() call
+	std::vector<StartingConfigCandidate> start_config_candidates;
+	std::vector<int> start_config_job_candidates; // candidate index of each job
+	std::vector<BatchIKJob> start_config_jobs;
+	std::vector<BatchIKResult> start_config_results;
+
+	// Randomizes the task references and the IK starting configuration. Returns false if the hands are behind the pelvis.
+	bool sampleStartingConfigCandidate(StartingConfigCandidate & candidate);
+	// Sets the task space members to the candidate
+	void setStartingConfigCandidate(const StartingConfigCandidate & candidate);
+	void createStartConfigWorkers();
+
 	void getFeetVertexList();
 	void getRandomPelvisLocation(Eigen::Vector3d & pelvis_out);
 	std::vector<Eigen::Vector3d> foot_contact_list_3d;
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <avatar_locomanipulation/helpers/IOUtilities.hpp>
+#include <avatar_locomanipulation/helpers/NeuralNetModel.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Deterministic forward pass with a topology fixed at compile time.
+// NeuralNetModel::SetFixedNetwork() routes double precision Infer() calls through it.
+class FixedNeuralNetBase {
+   public:
+    virtual ~FixedNeuralNetBase() {}
+    // One datum per row, same layout as NeuralNetModel::Infer
+    virtual void Infer(const Eigen::Ref<const Eigen::MatrixXd>& input,
+                       Eigen::Ref<Eigen::MatrixXd> output) const = 0;
+    virtual int GetNumInput() const = 0;
+    virtual int GetNumOutput() const = 0;
+};
+
+// Dense layer with fixed-size parameters. The weight is stored transposed so
+// that a single datum is evaluated as a fixed-size matrix-vector product.
+template <int In, int Out>
+class FixedLayer {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Eigen::Matrix<double, In, 1> InputType;
+    typedef Eigen::Matrix<double, Out, 1> OutputType;
+
+    FixedLayer() : act_fn_(None) {
+        weight_t_.setZero();
+        bias_.setZero();
+    }
+
+    // Returns false if the layer dimensions differ from the template
+    bool SetParameters(Layer& layer) {
+        if ((layer.GetNumInput() != In) || (layer.GetNumOutput() != Out)) {
+            return false;
+        }
+        weight_t_ = layer.GetWeight().transpose();
+        bias_ = layer.GetBias().row(0).transpose();
+        act_fn_ = layer.GetActivationFunction();
+        return true;
+    }
+
+    void GetOutput(const InputType& input, OutputType& output) const {
+        output.noalias() = weight_t_ * input;
+        output += bias_;
+        switch (act_fn_) {
+            case ActivationFunction::Tanh:
+                output.array() = output.array().tanh();
+                break;
+            case ActivationFunction::ReLU:
+                output = output.cwiseMax(0.);
+                break;
+            case ActivationFunction::Sigmoid:
+                output.array() = (1. + (-output.array()).exp()).inverse();
+                break;
+            default:
+                break;
+        }
+    }
+
+   private:
+    Eigen::Matrix<double, Out, In> weight_t_;
+    OutputType bias_;
+    ActivationFunction act_fn_;
+};
+
+// Chain of fixed layers In -> Out -> Rest...
+template <int In, int Out, int... Rest>
+class FixedLayerChain {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef FixedLayerChain<Out, Rest...> NextType;
+    enum {
+        InputSize = In,
+        NumLayer = 1 + NextType::NumLayer,
+        NumOutput = NextType::NumOutput
+    };
+
+    bool SetParameters(std::vector<Layer>& layers, int idx) {
+        return layer_.SetParameters(layers[idx]) &&
+               next_.SetParameters(layers, idx + 1);
+    }
+
+    void Evaluate(const Eigen::Matrix<double, In, 1>& input,
+                  Eigen::Matrix<double, NumOutput, 1>& output) const {
+        Eigen::Matrix<double, Out, 1> hidden;
+        layer_.GetOutput(input, hidden);
+        next_.Evaluate(hidden, output);
+    }
+
+   private:
+    FixedLayer<In, Out> layer_;
+    NextType next_;
+};
+
+template <int In, int Out>
+class FixedLayerChain<In, Out> {
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    enum { InputSize = In, NumLayer = 1, NumOutput = Out };
+
+    bool SetParameters(std::vector<Layer>& layers, int idx) {
+        return layer_.SetParameters(layers[idx]);
+    }
+
+    void Evaluate(const Eigen::Matrix<double, In, 1>& input,
+                  Eigen::Matrix<double, Out, 1>& output) const {
+        layer_.GetOutput(input, output);
+    }
+
+   private:
+    FixedLayer<In, Out> layer_;
+};
+
+// Network with layer sizes Dims = <In, Hidden..., Out>, e.g. the deployed
+// feasibility classifier is FixedNeuralNet<32, 64, 64, 64, 1>.
+// Every datum is evaluated with fixed-size products, which the compiler can
+// unroll and vectorize. Intended for small layers: each weight matrix must
+// fit within Eigen's fixed-size allocation limit.
+//
+// Usage:
+//   std::shared_ptr< FixedNeuralNet<32, 64, 64, 64, 1> > fixed_net = FixedNeuralNet<32, 64, 64, 64, 1>::Create(node);
+//   nn_model->SetFixedNetwork(fixed_net); // keeps the dynamic path if fixed_net is null
+template <int... Dims>
+class FixedNeuralNet : public FixedNeuralNetBase {
+    static_assert(sizeof...(Dims) >= 2,
+                  "FixedNeuralNet needs at least an input and an output size");
+
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef FixedLayerChain<Dims...> ChainType;
+    enum {
+        InputSize = ChainType::InputSize,
+        NumLayer = ChainType::NumLayer,
+        NumOutput = ChainType::NumOutput
+    };
+
+    FixedNeuralNet() : b_loaded_(false) {}
+    virtual ~FixedNeuralNet() {}
+
+    // Loads the parameters from the same yaml format as NeuralNetModel.
+    // Returns false if the stored topology does not match Dims.
+    bool Load(const myYAML::Node& node) {
+        int num_layer;
+        int act_fn;
+        Eigen::MatrixXd w, b;
+        std::vector<Layer> layers;
+        try {
+            myUtils::readParameter(node, "num_layer", num_layer);
+            if (num_layer != NumLayer) {
+                std::cout << "[FixedNeuralNet] Expected " << NumLayer
+                          << " layers but the model has " << num_layer
+                          << std::endl;
+                return false;
+            }
+            for (int idx_layer = 0; idx_layer < num_layer; ++idx_layer) {
+                myUtils::readParameter(node, "w" + std::to_string(idx_layer), w);
+                myUtils::readParameter(node, "b" + std::to_string(idx_layer), b);
+                myUtils::readParameter(node, "act_fn" + std::to_string(idx_layer),
+                                       act_fn);
+                layers.push_back(
+                    Layer(w, b, static_cast<ActivationFunction>(act_fn)));
+            }
+        } catch (std::runtime_error& e) {
+            std::cout << "Error reading parameter [" << e.what()
+                      << "] at file: [" << __FILE__ << "]" << std::endl
+                      << std::endl;
+            return false;
+        }
+        return SetLayers(layers);
+    }
+
+    // Copies the parameters of already loaded layers, e.g. NeuralNetModel::GetLayers().
+    // Returns false if the layer dimensions do not match Dims.
+    bool SetLayers(std::vector<Layer> layers) {
+        b_loaded_ = false;
+        if (static_cast<int>(layers.size()) != NumLayer) {
+            std::cout << "[FixedNeuralNet] Expected " << NumLayer
+                      << " layers but got " << layers.size() << std::endl;
+            return false;
+        }
+        if (!chain_.SetParameters(layers, 0)) {
+            std::cout << "[FixedNeuralNet] Layer dimensions do not match the "
+                         "compiled topology"
+                      << std::endl;
+            return false;
+        }
+        b_loaded_ = true;
+        return true;
+    }
+
+    bool IsLoaded() const { return b_loaded_; }
+
+    // Returns a loaded network or a null pointer if the topology does not match
+    static std::shared_ptr<FixedNeuralNet> Create(const myYAML::Node& node) {
+        std::shared_ptr<FixedNeuralNet> net(new FixedNeuralNet());
+        if (!net->Load(node)) {
+            net.reset();
+        }
+        return net;
+    }
+
+    static std::shared_ptr<FixedNeuralNet> Create(
+        const std::vector<Layer>& layers) {
+        std::shared_ptr<FixedNeuralNet> net(new FixedNeuralNet());
+        if (!net->SetLayers(layers)) {
+            net.reset();
+        }
+        return net;
+    }
+
+    virtual void Infer(const Eigen::Ref<const Eigen::MatrixXd>& input,
+                       Eigen::Ref<Eigen::MatrixXd> output) const {
+        Eigen::Matrix<double, InputSize, 1> datum;
+        Eigen::Matrix<double, NumOutput, 1> pred;
+        for (int row = 0; row < input.rows(); ++row) {
+            datum = input.row(row).transpose();
+            chain_.Evaluate(datum, pred);
+            output.row(row) = pred.transpose();
+        }
+    }
+
+    virtual int GetNumInput() const { return InputSize; }
+    virtual int GetNumOutput() const { return NumOutput; }
+
+   private:
+    ChainType chain_;
+    bool b_loaded_;
+};
@@ -3,9 +3,15 @@
 #include <Eigen/Dense>
 #include <avatar_locomanipulation/helpers/IOUtilities.hpp>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 enum ActivationFunction { None = 0, Tanh = 1, ReLU = 2, LeakyReLU = 3, Sigmoid = 4};
+// Arithmetic used by NeuralNetModel::Infer
+enum InferencePrecision { DoublePrecision = 0, SinglePrecision = 1, Int8Quantized = 2 };
+
+// Compile-time topology network, see FixedNeuralNet.hpp
+class FixedNeuralNetBase;
 
 class Layer {
    public:
@@ -13,6 +19,23 @@ class Layer {
           ActivationFunction act_fn);
     virtual ~Layer();
     Eigen::MatrixXd GetOutput(const Eigen::MatrixXd& input);
+    // Writes the layer output to output (num_data x num_output) without allocating.
+    // The bias add and the activation are applied in place on the product.
+    void GetOutput(const Eigen::Ref<const Eigen::MatrixXd>& input,
+                   Eigen::Ref<Eigen::MatrixXd> output) const;
+    // Single precision version using a float copy of the parameters
+    void GetOutput(const Eigen::Ref<const Eigen::MatrixXf>& input,
+                   Eigen::Ref<Eigen::MatrixXf> output) const;
+    // Symmetric int8 post-training quantization. Weights are scaled per output
+    // and inputs with a single scale covering [-input_range, input_range].
+    void Quantize(double input_range);
+    bool IsQuantized() { return b_quantized_; }
+    // Int8 version. The input is quantized into input_q, the integer product is
+    // accumulated in acc and the dequantized result written to output.
+    void GetOutputQuantized(const Eigen::Ref<const Eigen::MatrixXf>& input,
+                            Eigen::Ref<Eigen::MatrixXi> input_q,
+                            Eigen::Ref<Eigen::MatrixXi> acc,
+                            Eigen::Ref<Eigen::MatrixXf> output) const;
     int GetNumInput() { return num_input_; }
     int GetNumOutput() { return num_output_; }
     Eigen::MatrixXd GetWeight() { return weight_; }
@@ -22,6 +45,14 @@ class Layer {
    private:
     Eigen::MatrixXd weight_;
     Eigen::MatrixXd bias_;
+    Eigen::RowVectorXd bias_row_;
+    Eigen::MatrixXf weight_f_;
+    Eigen::RowVectorXf bias_row_f_;
+    // Quantized weights in [-127, 127], widened to int for the integer product
+    Eigen::MatrixXi weight_q_;
+    float input_scale_;
+    Eigen::RowVectorXf output_scale_;
+    bool b_quantized_;
     int num_input_;
     int num_output_;
     ActivationFunction act_fn_;
@@ -38,6 +69,30 @@ class NeuralNetModel {
     std::vector<Layer> GetLayers() { return layers_; }
     Eigen::MatrixXd GetOutput(const Eigen::MatrixXd& input);
     Eigen::MatrixXd GetOutput(const Eigen::MatrixXd& input, int idx);
+    // Deterministic forward pass (the mean output for stochastic models).
+    // Layer outputs are kept in per-model workspaces which only grow when a
+    // larger batch than any previous one is given, so repeated queries do not allocate.
+    // Not safe to call concurrently on the same model.
+    void Infer(const Eigen::Ref<const Eigen::MatrixXd>& input,
+               Eigen::Ref<Eigen::MatrixXd> output);
+
+    // Routes double precision Infer() calls through a fixed-topology network
+    // holding the same parameters. A null pointer or a network whose input and
+    // output sizes differ from this model keeps the dynamic path.
+    bool SetFixedNetwork(std::shared_ptr<FixedNeuralNetBase> fixed_net);
+    bool HasFixedNetwork() { return fixed_net_ != nullptr; }
+
+    // Int8Quantized requires Calibrate() to have been called.
+    void SetInferencePrecision(InferencePrecision precision);
+    InferencePrecision GetInferencePrecision() { return precision_; }
+    // Quantizes every layer using the activation ranges of a double forward
+    // pass over the calibration inputs (one normalized datum per row).
+    void Calibrate(const Eigen::Ref<const Eigen::MatrixXd>& calibration_input);
+    // Prints the output drift of the single precision and int8 modes against
+    // the double model over the inputs, including how many binary decisions at
+    // the threshold change.
+    void ReportPrecisionDrift(const Eigen::Ref<const Eigen::MatrixXd>& input,
+                              double threshold = 0.5);
     void GetOutput(const Eigen::MatrixXd& _input,
                    const Eigen::VectorXd& _lb,
                    const Eigen::VectorXd& _ub,
@@ -59,6 +114,16 @@ class NeuralNetModel {
     int num_output_;
     int num_layer_;
     std::vector<Layer> layers_;
+    void ReserveWorkspaces_(int num_data);
+    std::vector<Eigen::MatrixXd> workspaces_;
+    std::vector<Eigen::MatrixXf> workspaces_f_;
+    std::vector<Eigen::MatrixXi> workspaces_q_;
+    std::vector<Eigen::MatrixXi> workspaces_acc_;
+    Eigen::MatrixXf input_f_;
+    int workspace_rows_;
+    InferencePrecision precision_;
+    bool b_calibrated_;
+    std::shared_ptr<FixedNeuralNetBase> fixed_net_;
     bool b_stochastic_;
     Eigen::VectorXd logstd_;
     Eigen::VectorXd std_;
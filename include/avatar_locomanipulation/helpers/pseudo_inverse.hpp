@@ -4,6 +4,13 @@
 #include <Eigen/Dense>
 #include <Eigen/SVD>
 #include <vector>
+#include <string>
+
+// Pseudo inverse backends of PseudoInverseSolver
+#define PINV_JACOBI_SVD 0 // JacobiSVD of J*Winv*J^T with singular values below the tolerance set to 0
+#define PINV_DAMPED_LEAST_SQUARES 1 // LDLT of J*Winv*J^T + damping^2*I. Fastest, biased near singularities
+#define PINV_COD 2 // Minimum norm solve with a CompleteOrthogonalDecomposition of J*Winv*J^T
+#define PINV_BDCSVD 3 // Same as PINV_JACOBI_SVD using a BDCSVD
 
 namespace math_utils{ 
   void pseudoInverse(const Eigen::MatrixXd & A,
@@ -31,5 +38,54 @@ namespace math_utils{
                           Eigen::MatrixXd & Jinv, 
                           double tolerance);
 
+  // Computes (weighted) pseudo inverses Jinv = Winv*J^T*(J*Winv*J^T)^+ with a selectable backend.
+  // Decompositions and intermediate products are kept between calls and are only
+  // reallocated when the size of J changes. Keeps the number of calls and the time spent.
+  class PseudoInverseSolver{
+  public:
+    PseudoInverseSolver();
+    PseudoInverseSolver(int method_in);
+    ~PseudoInverseSolver();
+
+    // Sets PINV_JACOBI_SVD, PINV_DAMPED_LEAST_SQUARES, PINV_COD or PINV_BDCSVD. Default: PINV_JACOBI_SVD
+    void setMethod(int method_in);
+    int getMethod() const;
+    // Damping used by PINV_DAMPED_LEAST_SQUARES. Default: 1e-2
+    void setDamping(double damping_in);
+
+    // Unweighted pseudo inverse. Equivalent to Winv = I without forming the product with Winv
+    void compute(const Eigen::MatrixXd & J, Eigen::MatrixXd & Jinv, double tolerance);
+    // Weighted pseudo inverse
+    void compute(const Eigen::MatrixXd & J, const Eigen::MatrixXd & Winv, Eigen::MatrixXd & Jinv, double tolerance);
+
+    // Timing statistics
+    int getNumCalls() const;
+    double getTotalTime() const; // seconds
+    double getAverageTime() const; // seconds
+    void resetStats();
+    std::string getMethodName() const;
+
+  private:
+    // Computes Jinv = WJt*(lambda)^+ once WJt and lambda have been formed
+    void solveLambda(Eigen::MatrixXd & Jinv, double tolerance);
+
+    int method;
+    double damping;
+
+    int num_calls;
+    double total_time;
+
+    Eigen::MatrixXd WJt; // Winv*J^T
+    Eigen::MatrixXd lambda; // J*Winv*J^T
+    Eigen::MatrixXd lambda_inv;
+    Eigen::MatrixXd Jinv_t;
+    Eigen::VectorXd singular_values_inv;
+
+    Eigen::JacobiSVD<Eigen::MatrixXd> jacobi_svd;
+    Eigen::BDCSVD<Eigen::MatrixXd> bdc_svd;
+    Eigen::LDLT<Eigen::MatrixXd> ldlt;
+    Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> cod;
+  };
+
 }
 #endif
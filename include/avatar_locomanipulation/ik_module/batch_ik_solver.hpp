@@ -0,0 +1,134 @@
+#ifndef ALM_BATCH_IK_SOLVER_H
+#define ALM_BATCH_IK_SOLVER_H
+
+#include <avatar_locomanipulation/models/robot_model.hpp>
+#include <avatar_locomanipulation/ik_module/ik_module.hpp>
+#include <avatar_locomanipulation/tasks/task.hpp>
+#include <vector>
+#include <memory>
+
+// Reference of a single task in a BatchIKJob. task_idx indexes the reference tasks of the workers.
+class BatchIKTaskReference{
+public:
+	BatchIKTaskReference();
+	BatchIKTaskReference(int task_idx_in, const Eigen::VectorXd & vec_ref_in);
+	BatchIKTaskReference(int task_idx_in, const Eigen::Quaterniond & quat_ref_in);
+	BatchIKTaskReference(int task_idx_in, const Eigen::VectorXd & vec_ref_in, const Eigen::Quaterniond & quat_ref_in);
+	~BatchIKTaskReference();
+
+	int task_idx = 0;
+	bool use_vec_ref = false;
+	bool use_quat_ref = false;
+	Eigen::VectorXd vec_ref;
+	Eigen::Quaterniond quat_ref;
+};
+
+// An independent IK problem: a starting configuration and the task references to solve for
+class BatchIKJob{
+public:
+	BatchIKJob();
+	BatchIKJob(const Eigen::VectorXd & q_seed_in);
+	~BatchIKJob();
+
+	void addReference(int task_idx, const Eigen::VectorXd & vec_ref_in);
+	void addReference(int task_idx, const Eigen::Quaterniond & quat_ref_in);
+	void addReference(int task_idx, const Eigen::VectorXd & vec_ref_in, const Eigen::Quaterniond & quat_ref_in);
+
+	Eigen::VectorXd q_seed;
+	std::vector<BatchIKTaskReference> references;
+};
+
+// Solution and diagnostics of a BatchIKJob
+class BatchIKResult{
+public:
+	BatchIKResult();
+	~BatchIKResult();
+
+	bool convergence = false; // same as the return value of IKModule::solveIK
+	int solve_result = 0; // IK_OPTIMAL_SOL, IK_SUBOPTIMAL_SOL, IK_MAX_ITERATIONS_HIT, IK_MAX_MINOR_ITER_HIT or IK_CANCELLED
+	double total_error_norm = 0.0;
+	std::vector<double> task_error_norms;
+	Eigen::VectorXd q_sol;
+	int num_iters = 0;
+	int num_minor_iters = 0;
+	double solve_time = 0.0; // seconds
+	int worker_idx = -1; // worker which solved the job. Only informative, the result does not depend on it
+	int seed_idx = -1; // multi-start only: index of the seed the result was obtained from
+};
+
+// IK problem owned by one thread. The robot model must not be shared with other workers, e.g. use a
+// RobotModelContext per worker. The tasks in reference_tasks receive the job references and must be
+// bound to robot_model, as must every task in the hierarchy of ik_module.
+class BatchIKWorker{
+public:
+	BatchIKWorker();
+	BatchIKWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<IKModule> ik_module_in, const std::vector< std::shared_ptr<Task> > & reference_tasks_in);
+	~BatchIKWorker();
+
+	std::shared_ptr<RobotModel> robot_model;
+	std::shared_ptr<IKModule> ik_module;
+	std::vector< std::shared_ptr<Task> > reference_tasks;
+};
+
+// Solves many independent IK problems concurrently. Each worker holds an identical IK problem built on its
+// own robot model data, and jobs are distributed over the workers with OpenMP.
+//
+// The result of a job only depends on the job: every job of a batch must set the same task references
+// (same task indices and reference types) so that no reference is carried over from a job previously
+// solved by the same worker. Results are stored in job order.
+//
+// Usage:
+//   for(int i = 0; i < num_threads; i++){
+//     std::shared_ptr<RobotModel> context(new RobotModelContext(robot_model));
+//     // build the tasks and the IK module on context
+//     batch_solver.addWorker(context, ik_module, {rpalm_task});
+//   }
+//   batch_solver.solve(jobs, results);
+class BatchIKSolver{
+public:
+	BatchIKSolver();
+	~BatchIKSolver();
+
+	// Adds a worker. Prepares the IK data structures of its module.
+	void addWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<IKModule> ik_module_in, const std::vector< std::shared_ptr<Task> > & reference_tasks_in);
+	void clearWorkers();
+	int getNumWorkers();
+
+	// Solves all jobs. results[i] is the solution of jobs[i]. Returns the number of converged jobs.
+	int solve(const std::vector<BatchIKJob> & jobs, std::vector<BatchIKResult> & results);
+
+	// Multi-start IK. Solves job from every seed concurrently, ignoring job.q_seed. The first solve whose first task
+	// converges cancels the others and is returned. If no seed converges, the result with the smallest first task
+	// error is returned (lowest seed index on ties). result.seed_idx reports the winning seed.
+	// Returns true if the first task converged.
+	// Which converged seed wins depends on thread timing when several seeds converge.
+	bool solveMultiStart(const BatchIKJob & job, const std::vector<Eigen::VectorXd> & seeds, BatchIKResult & result);
+	// Results of every seed of the latest multi-start solve. Cancelled seeds have solve_result = IK_CANCELLED
+	const std::vector<BatchIKResult> & getLastMultiStartResults();
+
+	// Builds num_seeds seeds: q_warm, q_nominal, then q_warm with the joints (not the floating base) perturbed
+	// uniformly by up to +-perturbation and clamped to the joint limits. Reproducible for a given random_seed.
+	static void generateSeeds(std::shared_ptr<RobotModel> & robot_model_in, const Eigen::VectorXd & q_warm, const Eigen::VectorXd & q_nominal,
+	                          int num_seeds, double perturbation, unsigned int random_seed, std::vector<Eigen::VectorXd> & seeds);
+
+	// Throughput of the latest batch
+	double getLastBatchTime(); // wall time in seconds
+	int getLastNumJobs();
+	void printLastBatchStats();
+
+private:
+	// Checks that the jobs can be applied to the workers and all set the same references
+	bool checkJobs(const std::vector<BatchIKJob> & jobs);
+	void setReferences(BatchIKWorker & worker, const BatchIKJob & job);
+
+	std::vector<BatchIKWorker> workers;
+	std::vector<BatchIKResult> multi_start_results;
+
+	double last_batch_time = 0.0;
+	int last_num_jobs = 0;
+	int last_num_converged = 0;
+	double last_total_solve_time = 0.0;
+	int last_total_iters = 0;
+};
+
+#endif
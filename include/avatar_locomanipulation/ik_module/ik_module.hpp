@@ -5,15 +5,49 @@
 #include <avatar_locomanipulation/tasks/task.hpp>
 #include <avatar_locomanipulation/helpers/pseudo_inverse.hpp>
 #include <iostream>
+#include <atomic>
 
 #define IK_OPTIMAL_SOL 1	// SUCCESS ||f(x)|| <= error_tol
 #define IK_SUBOPTIMAL_SOL 2 // SUCCESS ||grad(f(x))|| <= grad_tol
 #define IK_MAX_ITERATIONS_HIT 3 // iter >= MAX_ITERS 
 #define IK_MAX_MINOR_ITER_HIT 4  // k_step <= k_step_min
+#define IK_CANCELLED 5 // the cancel flag was raised by another thread
+
+#define IK_SOLVER_LINE_SEARCH 0 // Pseudo inverse step with a backtracking line search
+#define IK_SOLVER_LEVENBERG_MARQUARDT 1 // Damped step with an adaptive damping (trust region)
 
 #define IK_VERBOSITY_LOW 0 // No printouts
 #define IK_VERBOSITY_HIGH 1 // Printout task errors each iterations
 
+// Solver parameters of an IKModule, i.e. everything but the task hierarchy and the solver state.
+// Used to set up several IK modules identically.
+class IKParameters{
+public:
+	double singular_values_threshold = 1e-4;
+	int max_iters = 100;
+	int max_minor_iters = 30;
+	double k_step = 1.0;
+	double beta = 0.8;
+	double error_tol = 1e-3;
+	double grad_tol = 1e-12;
+	bool inertia_weighted = false;
+	double inertia_update_threshold = 0.0;
+	bool sequential_descent = false;
+	bool backtrack_with_current_task_error = true;
+	bool check_prev_violations = false;
+	bool return_when_first_task_converges = false;
+	bool incremental_nullspace = true;
+	bool kinematics_only_line_search = true;
+	int solver_mode = IK_SOLVER_LINE_SEARCH;
+	double lm_damping_scale_init = 1.0;
+	double lm_damping_bias = 1e-6;
+	double lm_damping_scale_max = 1e3;
+	int pinv_method = PINV_JACOBI_SVD;
+	std::vector<int> task_pinv_methods; // per task level, see setPseudoInverseMethod(task_idx, ...)
+	double pinv_damping = 1e-2;
+	int verbosity_level = IK_VERBOSITY_HIGH;
+};
+
 class IKModule{
 public:
 	IKModule();
@@ -69,6 +103,14 @@ public:
 	void setGradTol(double & grad_tol_in);
 	// Whether or not the inertia matrix is used for a weighted pseudoinverse. Default: false
 	void setEnableInertiaWeighting(bool inertia_weighted_in);
+	// The inverse inertia matrix of the inertia weighting is cached and only recomputed when q_start differs from the
+	// configuration it was computed at by more than this threshold (infinity norm). Applies across iterations and solves.
+	// Default: 0.0, i.e. recomputed whenever q_start changes
+	void setInertiaUpdateThreshold(double inertia_update_threshold_in);
+	// Forces the recomputation of the inverse inertia matrix at the next iteration
+	void invalidateInertiaCache();
+	// Number of inverse inertia matrix computations since the last resetIterationCounts()
+	int getNumInertiaUpdates();
 
 	// if true: use dq in the order of task hierarchy and only include next tasks when higher priority tasks have converged
 	// if false: uses the total_dq for all the tasks in the hierarchy.
@@ -87,18 +129,80 @@ public:
 	// if false : continues to satisfy lower priority tasks
 	void setReturnWhenFirstTaskConverges(bool return_when_first_task_converges_in);
 
+	// if true: the accumulated null space projector N_0*...*N_{k-1} is carried from one priority level to the next
+	//          with a rank task_dim update. O(k*nv^2*task_dim) per iteration
+	// if false: the product of null spaces is rebuilt for every priority level. O(k^2*nv^3) per iteration
+	// Default: true
+	void setIncrementalNullspace(bool incremental_nullspace_in);
+
+	// if true: trial steps of the backtracking line search only update the frame placements and the CoM position.
+	//          The Jacobians are computed once per accepted major iteration.
+	// if false: every trial step performs a full kinematics update
+	// Default: true
+	void setKinematicsOnlyLineSearch(bool kinematics_only_line_search_in);
+
+	// Sets the descent method to IK_SOLVER_LINE_SEARCH or IK_SOLVER_LEVENBERG_MARQUARDT.
+	// IK_SOLVER_LEVENBERG_MARQUARDT uses damped least squares pseudo inverses on every task level. The damping
+	// shrinks after successful steps and grows after rejected steps instead of backtracking along a fixed direction.
+	// Default: IK_SOLVER_LINE_SEARCH
+	void setSolverMode(int solver_mode_in);
+	// Sets the damping of IK_SOLVER_LEVENBERG_MARQUARDT. The damping of each iteration is
+	//   damping^2 = scale^2 * 0.5*f^2 + bias^2
+	// where f is the error norm being minimized, so that the step approaches a Gauss-Newton step as the error vanishes.
+	// scale starts at scale_init, shrinks after good steps and grows after rejected steps. The solver stops with
+	// IK_MAX_MINOR_ITER_HIT once scale exceeds scale_max. Default: 1.0, 1e-6, 1e3
+	void setLevenbergMarquardtDamping(double scale_init_in, double bias_in, double scale_max_in);
+
+	// Flag polled once per major iteration. When it becomes true, solveIK returns false with IK_CANCELLED
+	// and the latest configuration. Used to stop the remaining solves of a multi-start IK. nullptr disables it.
+	void setCancelFlag(std::atomic<bool> * cancel_flag_in);
+
+	// Iteration counts of the latest solve and accumulated since the last reset
+	int getLastNumIterations();
+	int getLastNumMinorIterations();
+	int getTotalNumIterations();
+	int getTotalNumMinorIterations();
+	int getTotalNumSolves();
+	void resetIterationCounts();
+
+	// Sets the pseudo inverse backend of all task levels to PINV_JACOBI_SVD, PINV_DAMPED_LEAST_SQUARES, PINV_COD or PINV_BDCSVD.
+	// Default: PINV_JACOBI_SVD
+	void setPseudoInverseMethod(int pinv_method_in);
+	// Sets the pseudo inverse backend of the task at task_idx in the hierarchy. Kept until the hierarchy is cleared.
+	void setPseudoInverseMethod(int task_idx, int pinv_method_in);
+	// Sets the damping of PINV_DAMPED_LEAST_SQUARES. Default: 1e-2
+	void setPseudoInverseDamping(double damping_in);
+	// Prints the number of calls and the average time of the pseudo inverse of each task level
+	void printPseudoInverseStats();
+	void resetPseudoInverseStats();
+
 	// returns the error tolerance for the problem
 	double getErrorTol();
 
+	// Gets or sets all the solver parameters at once
+	IKParameters getParameters();
+	void setParameters(const IKParameters & parameters);
+
 	// Print the latest solution results
 	void printSolutionResults();
 
 
 private:
+	// Levenberg-Marquardt variant of solveIK
+	bool solveIKLevenbergMarquardt(int & solve_result, double & total_error_norm_out, Eigen::VectorXd & q_sol);
+	// Sets all task levels to damped least squares with the given damping
+	void setLevenbergMarquardtPseudoInverses(double damping);
+	// Restores the pseudo inverse method and damping of each task level
+	void restorePseudoInverseSettings();
+	// Returns the error norm used for accepting a step
+	double computeMeritFunction(const int & task_idx_to_minimize);
+
 	// Updates all of the task Jacobians
 	void updateTaskJacobians();
 	// Compute all the pseudo inverses
 	void computePseudoInverses();
+	// Compute all the pseudo inverses carrying the accumulated null space forward one level at a time
+	void computePseudoInversesIncremental();
 	// Compute all the task errors
 	void computeTaskErrors();
 	// Compute all of dq
@@ -134,17 +238,21 @@ private:
 
 	Eigen::MatrixXd I_ ; // Identity Matrix
 	Eigen::MatrixXd Ntmp_ ; // Temporary Null Space Matrix
+	Eigen::MatrixXd Nacc_ ; // Accumulated Null Space Matrix N_0*N_1*...*N_{k-1} of the incremental hierarchy
 
 	std::vector<Eigen::MatrixXd> J_; // Task Jacobian
 	std::vector<Eigen::MatrixXd> N_; // Task Nullspace
 	std::vector<Eigen::MatrixXd> JN_; // Projected Task Jacobian
 	std::vector<Eigen::MatrixXd> JNpinv_; // Projected Task Jacobian Pseudo Inverse
+	std::vector<Eigen::MatrixXd> NaccJNpinv_; // Accumulated Null Space times the Projected Task Jacobian Pseudo Inverse
 	std::vector<Eigen::VectorXd> dx_; // Task Errors
 	std::vector<double> dx_norms_; // Task Error Norms
 
-	// Sets the svd options and a list of SVDs
-	unsigned int svdOptions = Eigen::ComputeThinU | Eigen::ComputeThinV;
-	std::vector< Eigen::JacobiSVD<Eigen::MatrixXd> > svd_list_; // List of SVD for pseudoinverses
+	// Pseudo inverse solver of each task level. Keeps the decomposition workspaces between iterations
+	std::vector<math_utils::PseudoInverseSolver> pinv_solvers_;
+	std::vector<int> task_pinv_methods_; // Pseudo inverse method of each task level
+	int pinv_method = PINV_JACOBI_SVD; // Pseudo inverse method of task levels without their own setting
+	double pinv_damping = 1e-2;
 
 	// IK parameters
 	double singular_values_threshold = 1e-4; // Cut off value to treat singular values as 0.0
@@ -156,6 +264,14 @@ private:
 	double grad_tol = 1e-12;//6; // Gradient descent tolerance for suboptimality
 	bool inertia_weighted_ = false;
 
+	// Cached inverse inertia matrix used as the pseudo inverse weight and the configuration it was computed at
+	Eigen::MatrixXd Ainv_;
+	Eigen::VectorXd q_inertia_;
+	bool inertia_cache_valid_ = false;
+	double inertia_update_threshold = 0.0;
+	int num_inertia_updates_ = 0;
+	void updateInertiaWeight();
+
 
 	// if true: use dq in the order of task hierarchy and only include next tasks when higher priority tasks have converged
 	// if false: uses the total_dq for all the tasks in the hierarchy.
@@ -173,6 +289,31 @@ private:
 	// if false: the solver tries to satisfy lower priority tasks further
 	bool return_when_first_task_converges = false;
 
+	// if true: updates the accumulated null space projector one priority level at a time
+	// if false: rebuilds the product of null spaces for each priority level
+	bool incremental_nullspace = true;
+
+	// if true: line search trial steps skip the Jacobian computations
+	// if false: line search trial steps perform a full kinematics update
+	bool kinematics_only_line_search = true;
+
+	// Descent method
+	int solver_mode = IK_SOLVER_LINE_SEARCH;
+	double lm_damping_scale_init = 1.0;
+	double lm_damping_bias = 1e-6;
+	double lm_damping_scale_max = 1e3;
+
+	// Set by another thread to stop the solve
+	std::atomic<bool> * cancel_flag = nullptr;
+	bool cancelRequested();
+
+	// Iteration counters
+	int num_iters_ = 0; // major iterations of the latest solve
+	int num_minor_iters_ = 0; // trial steps of the latest solve
+	int total_num_iters_ = 0;
+	int total_num_minor_iters_ = 0;
+	int total_num_solves_ = 0;
+
 	// Errors and Error gradient values:
 	double total_error_norm = 0.0;
 	double f_q = 0.0;
@@ -4,6 +4,7 @@
 #include <Configuration.h>
 #include <avatar_locomanipulation/models/robot_model.hpp>
 #include <avatar_locomanipulation/ik_module/ik_module.hpp>
+#include <avatar_locomanipulation/ik_module/batch_ik_solver.hpp>
 
 // Default Task Types
 #include <avatar_locomanipulation/tasks/task_6dpose.hpp>
@@ -50,6 +51,14 @@ public:
   // Computes a stance given the desired references.
   bool computeStance(Eigen::VectorXd & q_out);
 
+  // Computes a stance from each starting configuration with the same desired references. The IKs are solved concurrently
+  // with setNumThreads() threads. q_out_list[i] and convergence_list[i] are the result of q_start_list[i].
+  // Returns the number of converged stances.
+  int computeStances(const std::vector<Eigen::VectorXd> & q_start_list, std::vector<Eigen::VectorXd> & q_out_list, std::vector<bool> & convergence_list);
+
+  // Number of threads used by computeStances(). Default 1. Must be called after setRobotModel()
+  void setNumThreads(int num_threads_in);
+
 
 	// Member Functions
 	IKModule stance_ik_module;
@@ -128,10 +137,25 @@ public:
   std::vector<double> task_error_norms;
   Eigen::VectorXd q_sol;
 
+  // Snap to floor and stance IK results of the latest computeStances() call
+  std::vector<BatchIKResult> snap_to_floor_results;
+  std::vector<BatchIKResult> stance_results;
+
 private:
   void default_initialization();
   void createTaskStack();
 
+  // Rebuilds the tasks of this object and of the worker stance generators and registers them in the batch solvers
+  void prepareBatchSolvers();
+  // Job with the references of the current tasks and the base and posture references from q_start_in
+  void createStanceJob(const Eigen::VectorXd & q_start_in, BatchIKJob & job);
+  std::vector< std::shared_ptr<Task> > getReferenceTasks();
+
+  // Worker 0 uses the IK modules of this object, the other workers use the IK modules of worker_generators
+  BatchIKSolver snap_to_floor_solver;
+  BatchIKSolver stance_solver;
+  std::vector< std::shared_ptr<ValkyrieStanceGeneration> > worker_generators;
+
   bool use_right_hand = false;
   bool use_left_hand = false;
 
@@ -33,31 +33,62 @@
 #include <map>
 #include <iostream>
 #include <boost/shared_ptr.hpp>
+#include <memory>
+#include <algorithm>
 
 // Macros
 #define VAL_MODEL_NUM_FLOATING_JOINTS 7 // 3 for x,y,z and 4 for qx, qy, qz, qw
 #define VAL_MODEL_JOINT_INDX_OFFSET 2 //pinocchio attaches a universe joint and a root joint that we need to remove
 
+// Frame resolved once by RobotModel::getFrameHandle() so that queries in the IK and trajectory loops
+// do not search the frame names. Valid for every RobotModel sharing the same pinocchio Model,
+// including RobotModelContexts.
+class FrameHandle{
+public:
+  FrameHandle();
+  std::string name;
+  pinocchio::FrameIndex index;
+  bool valid;
+};
+
+// Joint resolved once by RobotModel::getJointHandle().
+class JointHandle{
+public:
+  JointHandle();
+  std::string name;
+  pinocchio::JointIndex id;
+  int q_index; // same as getJointIndex(name)
+  int q_index_no_floating_joints; // same as getJointIndexNoFloatingJoints(name)
+  bool valid;
+};
+
 
 class RobotModel{
 private:
-  
+  // Storage of the kinematic and geometry models. Shared with any RobotModelContext built from this model.
+  std::shared_ptr<pinocchio::Model> model_storage;
+  std::shared_ptr<pinocchio::GeometryModel> geom_model_storage;
+
   // private temporary index value holders. Prevents memory allocation on runtime
   pinocchio::FrameIndex tmp_frame_index;
   pinocchio::JointIndex tmp_joint_index;
   void buildPinocchioModel(const std::string & filename);
   void buildPinocchioGeomModel(const std::string & filename, const std::string & meshDir);
+
+  bool srdf_bool = false;
+
+protected:
+  // Binds to models owned by another RobotModel
+  RobotModel(const std::shared_ptr<pinocchio::Model> & model_in, const std::shared_ptr<pinocchio::GeometryModel> & geom_model_in);
   void commonInitialization(bool geom_data_flag=false);
 
   bool updateGeomWithKinematics = false;
 
-  bool srdf_bool = false;
-
 public:
 
   std::string srdf_filename;
-  pinocchio::Model model;
-  pinocchio::GeometryModel geomModel;
+  pinocchio::Model & model;
+  pinocchio::GeometryModel & geomModel;
   pinocchio::fcl::CollisionResult result;
   pinocchio::fcl::DistanceResult dresult;
   std::vector<pinocchio::fcl::Contact> contacts;
@@ -104,6 +135,19 @@ public:
   */
   void updateFullKinematics(const Eigen::VectorXd & q_update);
 
+  /* updateKinematicsPlacements
+  Input: a vector of configuration with dimension model.nq to update the kinematics.
+  Only updates the joint and frame placements and the CoM position. The joint Jacobians and J_com
+  are left untouched. Sufficient for evaluating task errors, e.g. during a line search.
+  */
+  void updateKinematicsPlacements(const Eigen::VectorXd & q_update);
+
+  /* updateKinematicsJacobians
+  Computes the joint Jacobians and J_com at q_current. Together with updateKinematicsPlacements 
+  this is equivalent to updateFullKinematics.
+  */
+  void updateKinematicsJacobians();
+
   // updates the kinematic derivatives
   void updateKinematicsDerivatives(const Eigen::VectorXd & q_update, const Eigen::VectorXd & qdot_update, const Eigen::VectorXd & qddot_update);
 
@@ -117,12 +161,14 @@ public:
           then the rotational components: [(wx/dq)^T , (wy/dq)^T, (wz/dq)^T]^T
   */
   void get6DTaskJacobian(const std::string & frame_name, Eigen::MatrixXd & J_out);
+  void get6DTaskJacobian(const FrameHandle & frame, Eigen::MatrixXd & J_out);
 
   /* get6DTaskJacobianDot
   Input: the frame name.
   Output: the 6D task jacobian dot (6 x model.nv) expressed in world frame.
   */
   void get6DTaskJacobianDot(const std::string & frame_name, Eigen::MatrixXd & Jdot_out);
+  void get6DTaskJacobianDot(const FrameHandle & frame, Eigen::MatrixXd & Jdot_out);
 
 
   /* get6DTaskJacobianLocal
@@ -132,12 +178,14 @@ public:
           then the rotational components: [(wx/dq)^T , (wy/dq)^T, (wz/dq)^T]^T
   */
   void get6DTaskJacobianLocal(const std::string & frame_name, Eigen::MatrixXd & J_out);
+  void get6DTaskJacobianLocal(const FrameHandle & frame, Eigen::MatrixXd & J_out);
 
   /* get6DTaskJacobianDotLocal
   Input: the frame name.
   Output: the 6D task jacobian dot (6 x model.nv) expressed in world frame.
   */
   void get6DTaskJacobianDotLocal(const std::string & frame_name, Eigen::MatrixXd & Jdot_out);
+  void get6DTaskJacobianDotLocal(const FrameHandle & frame, Eigen::MatrixXd & Jdot_out);
 
 
   /* getFrameWorldPose
@@ -146,6 +194,20 @@ public:
   */
 
   void getFrameWorldPose(const std::string & name, Eigen::Vector3d & pos, Eigen::Quaternion<double> & ori);
+  void getFrameWorldPose(const FrameHandle & frame, Eigen::Vector3d & pos, Eigen::Quaternion<double> & ori);
+
+  /* getFrameHandle
+  Input: the frame name.
+  Output: the resolved frame. Prints an error and returns an invalid handle if the frame does not exist.
+  */
+  FrameHandle getFrameHandle(const std::string & frame_name);
+
+  /* getJointHandle
+  Input: the joint name.
+  Output: the resolved joint with its configuration indices. Prints an error and returns an invalid handle 
+          if the joint does not exist.
+  */
+  JointHandle getJointHandle(const std::string & joint_name);
 
   /* getJointIndex
   Input std::string name
@@ -157,6 +219,8 @@ public:
       this function should return 7.
   */
   int getJointIndex(const std::string & name); 
+  // The handle must be valid. Invalid handles have a q_index of -1.
+  int getJointIndex(const JointHandle & joint); 
 
   /* getJointIndexNoFloatingJoints
   Input std::string name
@@ -167,6 +231,7 @@ public:
       this function should return 0.
   */
   int getJointIndexNoFloatingJoints(const std::string & name); 
+  int getJointIndexNoFloatingJoints(const JointHandle & joint); 
 
   /* getDimQ();
   Output: The dimension of the configuration space
@@ -179,6 +244,8 @@ public:
 
   // Tangent space forward integration given q_start, qdot*dt 
   void forwardIntegrate(const Eigen::VectorXd & q_start, const Eigen::VectorXd & qdotDt, Eigen::VectorXd & q_post);
+  // Tangent space difference such that forwardIntegrate(q_start, qdotDt, q_end) recovers q_end. Dimension model.nv
+  void configDifference(const Eigen::VectorXd & q_start, const Eigen::VectorXd & q_end, Eigen::VectorXd & qdotDt);
 
   // Computes the inertia matrix dim(model.nv x model.nv) given configuration and stores the result.
   void computeInertiaMatrix(const Eigen::VectorXd & q);
@@ -213,7 +280,72 @@ public:
 
   void printJointNames();
   void printFrameNames();
-  
+
+  friend class RobotModelContext;
+  friend class ReducedRobotModel;
+};
+
+// Per-thread kinematics workspace of a RobotModel. The context shares the pinocchio Model and
+// GeometryModel of the source model and owns its own Data, GeometryData, current configuration and
+// stored quantities (CoM, Jacobians, inertia matrices), so that tasks, IK modules and trajectory
+// generators bound to different contexts can run concurrently.
+// The shared models must not be modified while any context is in use.
+class RobotModelContext: public RobotModel{
+public:
+  RobotModelContext(const std::shared_ptr<RobotModel> & robot_model_in);
+  ~RobotModelContext();
+
+private:
+  // Keeps the source model alive as long as this context
+  std::shared_ptr<RobotModel> source_model;
+};
+
+// Robot model with a subset of the joints locked at fixed values, built with pinocchio::buildReducedModel.
+// Tasks, IK modules and trajectory generators bound to a reduced model only see the remaining joints,
+// so their Jacobians and projections are (6 + n_unlocked) wide instead of model.nv.
+// Frames and joints keep their names; a task referring to a locked joint is invalid on the reduced model.
+//
+// Usage:
+//   std::shared_ptr<ReducedRobotModel> reduced(new ReducedRobotModel(valkyrie, {"lowerNeckPitch", "neckYaw", "upperNeckPitch"}, q_full));
+//   reduced->fullToReducedConfig(q_full, q_red);
+//   // build the tasks and the IK module on reduced and solve for q_red
+//   reduced->reducedToFullConfig(q_red_sol, q_full_sol);
+class ReducedRobotModel: public RobotModel{
+public:
+  /* ReducedRobotModel
+  Input: the full model, the names of the joints to lock and a full configuration (dimension full model.nq)
+         providing the values of the locked joints. Unknown joint names are ignored with an error message.
+         Geometry is reduced as well if the full model has geometry data.
+  */
+  ReducedRobotModel(const std::shared_ptr<RobotModel> & full_model_in, const std::vector<std::string> & locked_joint_names_in, const Eigen::VectorXd & q_full_reference_in);
+  ~ReducedRobotModel();
+
+  // Mappings between the configurations and velocities of the full and the reduced model.
+  // Locked joints take their reference value (configurations) or zero (velocities) in the full vectors.
+  void fullToReducedConfig(const Eigen::VectorXd & q_full, Eigen::VectorXd & q_reduced);
+  void reducedToFullConfig(const Eigen::VectorXd & q_reduced, Eigen::VectorXd & q_full);
+  void fullToReducedVelocity(const Eigen::VectorXd & qdot_full, Eigen::VectorXd & qdot_reduced);
+  void reducedToFullVelocity(const Eigen::VectorXd & qdot_reduced, Eigen::VectorXd & qdot_full);
+
+  std::shared_ptr<RobotModel> getFullModel();
+  const std::vector<std::string> & getLockedJointNames();
+  // full configuration given to the constructor
+  const Eigen::VectorXd & getFullReferenceConfig();
+  // reduced configuration index -> full configuration index
+  const std::vector<int> & getConfigIndexMap();
+  // reduced velocity index -> full velocity index
+  const std::vector<int> & getVelocityIndexMap();
+
+private:
+  void buildIndexMaps();
+
+  std::shared_ptr<RobotModel> full_model;
+  std::vector<std::string> locked_joint_names;
+  std::vector<pinocchio::JointIndex> locked_joint_ids; // in the full model
+  Eigen::VectorXd q_full_reference;
+
+  std::vector<int> q_reduced_to_full;
+  std::vector<int> v_reduced_to_full;
 };
 
 #endif 
@@ -11,6 +11,7 @@
 #include <queue>
 #include <algorithm>
 #include <set>
+#include <unordered_set>
 #include <stdlib.h>
 #include <memory>
 #include <cstdlib>
@@ -25,6 +26,8 @@
 
 #include <chrono>
 
+#include <avatar_locomanipulation/planners/lattice_key.hpp>
+
 using namespace std;
 #define A_STAR_SET_TYPE_OPEN 0
 #define A_STAR_SET_TYPE_CLOSED 1
@@ -37,6 +40,8 @@ namespace planner{
 
 	class NodePtr_Compare_Fcost;
 	class NodePtr_Compare_key;
+	class NodePtr_Hash_key;
+	class NodePtr_Equal_key;
 
 	class Node {
 	public:
@@ -47,10 +52,13 @@ namespace planner{
 		double f_score;
 		shared_ptr<Node> parent;
 		int step_num;
-		string key;
+		LatticeKey key;
 
         bool isStartNode = false;
 
+		// Position of this node inside the open set heap. -1 if it is not in the open set.
+		int open_set_index = -1;
+
 	};
 
 	
@@ -66,6 +74,55 @@ namespace planner{
 		bool operator() (const shared_ptr<Node> & lhs, const shared_ptr<Node> &rhs) const;
 	};
 
+	class NodePtr_Hash_key{
+	public:
+		NodePtr_Hash_key();
+		std::size_t operator() (const shared_ptr<Node> & node) const;
+	private:
+		LatticeKeyHash key_hash;
+	};
+
+	class NodePtr_Equal_key{
+	public:
+		NodePtr_Equal_key();
+		bool operator() (const shared_ptr<Node> & lhs, const shared_ptr<Node> &rhs) const;
+	};
+
+	// Set of nodes in which membership is determined by the lattice key of the node
+	typedef std::unordered_set< std::shared_ptr<Node>, NodePtr_Hash_key, NodePtr_Equal_key> NodeKeySet;
+
+	// Binary min-heap of nodes ordered by f_score. Each node stores its heap position
+	// so that membership checks are O(1) and removals and key updates are O(log n).
+	class IndexedNodeHeap{
+	public:
+		IndexedNodeHeap();
+		~IndexedNodeHeap();
+
+		void push(const shared_ptr<Node> & node);
+		// Removes and returns the node at the given heap position. Position 0 is the minimum f_score node.
+		shared_ptr<Node> remove(const int index);
+		shared_ptr<Node> pop();
+		// Restores the heap ordering after the f_score of the node has been changed
+		void update(const shared_ptr<Node> & node);
+		bool contains(const shared_ptr<Node> & node) const;
+
+		const shared_ptr<Node> & top() const;
+		const shared_ptr<Node> & operator[](const int index) const;
+		// Collects up to k nodes in increasing f_score order without modifying the heap
+		void getTopNodes(const int k, std::vector< shared_ptr<Node> > & top_nodes) const;
+		size_t size() const;
+		bool empty() const;
+		void clear();
+
+	private:
+		std::vector< shared_ptr<Node> > heap;
+		NodePtr_Compare_Fcost node_compare_fcost_obj;
+
+		void siftUp(int index);
+		void siftDown(int index);
+		void swapNodes(const int i, const int j);
+	};
+
 	class A_starPlanner{
 	public:
 		A_starPlanner();
@@ -81,17 +138,22 @@ namespace planner{
 		virtual double heuristicCost(const shared_ptr<Node> neighbor,const shared_ptr<Node> goal);
 		virtual bool goalReached(shared_ptr<Node> current_node, shared_ptr<Node> goal);
 		virtual std::vector< shared_ptr<Node> > getNeighbors(shared_ptr<Node> & current);
+		// Called once at the start of every search after the sets have been cleared.
+		// Planners which pool their nodes release them here.
+		virtual void clearSearchNodes();
+		// Called for neighbors which were not added to the open set
+		virtual void releaseNode(const shared_ptr<Node> & node);
 
 		void addToDeleteSet(const std::vector< std::shared_ptr<Node> > & node_list);
 		bool checkPathToStartExists(const std::shared_ptr<Node> node, std::vector< std::shared_ptr<Node> > & candidates);
-		void checkSetValidity(const std::set< std::shared_ptr<Node>, NodePtr_Compare_key> & current_set,
+		void checkSetValidity(const NodeKeySet & current_set,
 							  const set_type type);
 		void filterValidNodes();
 
 		// Set member variables
-        std::vector< std::shared_ptr<Node> > OpenSet; 
-        std::set< std::shared_ptr<Node>, NodePtr_Compare_key> ClosedSet;
-        std::set< std::shared_ptr<Node>, NodePtr_Compare_key> ExploredSet;
+        IndexedNodeHeap OpenSet; 
+        NodeKeySet ClosedSet;
+        NodeKeySet ExploredSet;
 
         // Extra Sets for handling deleted nodes and checking for set validity
         std::set< std::shared_ptr<Node> > DeletedSet; 
@@ -136,6 +198,7 @@ namespace planner{
 		double y;
 
 		void commonInitialization();
+		void computeKey();
 
 	};
 
@@ -190,6 +253,7 @@ namespace planner{
 		
 
 		void commonInitializationFootstep();
+		void computeKeyFootstep();
 
 	};
 
@@ -0,0 +1,70 @@
+#ifndef ALM_FEASIBILITY_CACHE_H
+#define ALM_FEASIBILITY_CACHE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Core>
+
+namespace planner{
+
+	// Key of a classifier query. Each raw (unnormalized) input is rounded to a multiple of the cache resolution.
+	class FeasibilityCacheKey{
+	public:
+		std::vector<int64_t> values;
+		bool operator==(const FeasibilityCacheKey & rhs) const;
+	};
+
+	class FeasibilityCacheKeyHash{
+	public:
+		std::size_t operator()(const FeasibilityCacheKey & key) const;
+	};
+
+	// Least recently used cache of classifier results. Queries whose raw inputs round to the same values
+	// at the given resolution share a result, so the resolution should be well below the classifier's sensitivity.
+	// The cache is independent of the search and stays valid for as long as the classifier does not change.
+	class FeasibilityCache{
+	public:
+		FeasibilityCache();
+		FeasibilityCache(const std::size_t capacity_in, const double resolution_in);
+		~FeasibilityCache();
+
+		// Returns true and sets score if the datum has a cached result. Counts a hit or a miss.
+		bool lookup(const Eigen::Ref<const Eigen::VectorXd> & raw_datum, double & score);
+		// Stores the result of the datum, evicting the least recently used entry when full
+		void insert(const Eigen::Ref<const Eigen::VectorXd> & raw_datum, const double score);
+
+		// Changing the resolution or the capacity clears the cache
+		void setResolution(const double resolution_in);
+		void setCapacity(const std::size_t capacity_in);
+		double getResolution() const;
+		std::size_t getCapacity() const;
+
+		void clear();
+		void resetCounters();
+
+		std::size_t size() const;
+		std::size_t getNumHits() const;
+		std::size_t getNumMisses() const;
+
+	private:
+		typedef std::list< std::pair<FeasibilityCacheKey, double> > EntryList;
+
+		void computeKey(const Eigen::Ref<const Eigen::VectorXd> & raw_datum, FeasibilityCacheKey & key) const;
+
+		std::size_t capacity;
+		double resolution;
+		std::size_t num_hits;
+		std::size_t num_misses;
+
+		// Most recently used entries are at the front
+		EntryList entries;
+		std::unordered_map<FeasibilityCacheKey, EntryList::iterator, FeasibilityCacheKeyHash> entry_map;
+		FeasibilityCacheKey tmp_key;
+	};
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef ALM_LATTICE_KEY_H
+#define ALM_LATTICE_KEY_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <ostream>
+
+namespace planner{
+
+	// 64-bit finalizer mix (splitmix64), shared by the planner hash functors
+	inline uint64_t mixBits(uint64_t x){
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		return x;
+	}
+
+	// 128-bit key of a node in the planner lattice. The quantized node coordinates
+	// are packed into two words so that comparison and hashing do not allocate.
+	class LatticeKey{
+	public:
+		LatticeKey();
+		~LatticeKey();
+
+		uint64_t words[2];
+
+		bool operator==(const LatticeKey & rhs) const;
+		bool operator!=(const LatticeKey & rhs) const;
+		bool operator<(const LatticeKey & rhs) const;
+	};
+
+	std::ostream & operator<<(std::ostream & os, const LatticeKey & key);
+
+	// Packs signed integer fields into a LatticeKey. Each value is stored in two's complement
+	// using num_bits bits. append returns false, and leaves the field zero, when the value does not
+	// fit within its field, since distinct nodes could otherwise share a key.
+	class LatticeKeyBuilder{
+	public:
+		LatticeKeyBuilder();
+		~LatticeKeyBuilder();
+
+		bool append(const long long value, const int num_bits);
+		const LatticeKey & getKey() const;
+
+	private:
+		LatticeKey key;
+		int bit_offset;
+	};
+
+	class LatticeKeyHash{
+	public:
+		std::size_t operator()(const LatticeKey & key) const;
+	};
+
+	// Key of an edge between two lattice nodes
+	class LatticeEdgeKey{
+	public:
+		LatticeEdgeKey();
+		LatticeEdgeKey(const LatticeKey & from_in, const LatticeKey & to_in);
+		~LatticeEdgeKey();
+
+		LatticeKey from;
+		LatticeKey to;
+
+		bool operator==(const LatticeEdgeKey & rhs) const;
+	};
+
+	class LatticeEdgeKeyHash{
+	public:
+		std::size_t operator()(const LatticeEdgeKey & key) const;
+	};
+
+}
+
+#endif
@@ -16,8 +16,11 @@
 #include <avatar_locomanipulation/helpers/param_handler.hpp>
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
 
 #include <avatar_locomanipulation/planners/a_star_planner.hpp>
+#include <avatar_locomanipulation/planners/node_arena.hpp>
+#include <avatar_locomanipulation/planners/feasibility_cache.hpp>
 #include <avatar_locomanipulation/walking/config_trajectory_generator.hpp>
 #include <avatar_locomanipulation/data_types/manipulation_function.hpp>
 #include <avatar_locomanipulation/data_types/footstep.hpp>
@@ -47,6 +50,8 @@ namespace planner{
         double s = 0.0;
         Eigen::VectorXd q_init;
         bool take_a_step = false;
+        // Classifier score of the edge from the parent. Negative if it has not been evaluated
+        double feasibility_score = -1.0;
 
         Footstep left_foot;
         Footstep right_foot;
@@ -54,6 +59,9 @@ namespace planner{
     
         void setRobotConfig(const Eigen::VectorXd & q_input);
         void common_initialization();
+        // Reinitializes a pooled vertex in place. The configuration q_init is emptied
+        // and is only written once the edge to this vertex has been verified.
+        void initialize(double s_in, const Footstep & left_foot_in, const Footstep & right_foot_in);
 
         double getAngle(const Eigen::Quaterniond & quat_in);
         Eigen::AngleAxisd tmp_aa;
@@ -62,6 +70,30 @@ namespace planner{
     };
 
 
+    // Independent copy of the state needed to verify an edge. The configuration trajectory generator,
+    // its robot model and the manipulation function all hold scratch data, so each worker thread owns its own.
+    class EdgeVerificationWorker{
+    public:
+        EdgeVerificationWorker();
+        EdgeVerificationWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<ManipulationFunction> f_s_in, std::shared_ptr<ConfigTrajectoryGenerator> ctg_in);
+        ~EdgeVerificationWorker();
+
+        std::shared_ptr<RobotModel> robot_model;
+        std::shared_ptr<ManipulationFunction> f_s;
+        std::shared_ptr<ConfigTrajectoryGenerator> ctg;
+    };
+
+    // Result of an edge verified ahead of the expansion of its end vertex
+    class EdgeVerificationResult{
+    public:
+        EdgeVerificationResult();
+        ~EdgeVerificationResult();
+
+        Eigen::VectorXd q_start; // configuration of the parent used for the verification
+        bool convergence = false;
+        TrajEuclidean traj_q_config;
+    };
+
     class LocomanipulationPlanner: public A_starPlanner{
     public:
         LocomanipulationPlanner();
@@ -77,6 +109,10 @@ namespace planner{
         virtual bool constructPath();
 
         virtual std::vector< shared_ptr<Node> > getNeighbors(shared_ptr<Node> & current);
+        virtual void clearSearchNodes();
+        virtual void releaseNode(const shared_ptr<Node> & node);
+        // Replaces the arena handles of the previous search result (optimal path, achieved goal) by owned copies
+        void detachResultNodes();
 
         bool reconstructConfigurationTrajectory();
         bool reconstructConfigurationTrajectoryv2();
@@ -108,6 +144,24 @@ namespace planner{
         bool classifier_lazy_evaluate = true; 
 
         void setNeuralNetwork(std::shared_ptr<NeuralNetModel> nn_model_in, const Eigen::VectorXd & nn_mean_in, const Eigen::VectorXd & nn_std_dev_in);
+        // Sets the arithmetic of the neural network inference. Int8Quantized requires calibrateNeuralNetwork() to be called first.
+        void setNeuralNetworkPrecision(InferencePrecision precision);
+        // Calibrates the int8 quantization of the neural network on stored transition data
+        // (the transitions_data_with_task_space_info yaml files). Returns false if no transition could be loaded.
+        bool calibrateNeuralNetwork(const std::vector<std::string> & transition_data_files);
+
+        // Parallel edge verification. Each worker has its own ctg and manipulation function,
+        // with its robot model given as a RobotModelContext of the planner's robot model.
+        // The worker ctgs receive all the settings of the planner's ctg at the first prefetch of each search.
+        // When enabled, the incoming edges of the current vertex and of the best open set candidates
+        // are verified concurrently. Results are applied in f_score order so the search is unchanged.
+        void addEdgeVerificationWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<ManipulationFunction> f_s_in, std::shared_ptr<ConfigTrajectoryGenerator> ctg_in);
+        // Replaces the edge workers with num_workers workers built from robot_model, f_s, and ctg,
+        // and enables parallel edge verification if num_workers > 1.
+        // Must be called after initializeLocomanipulationVariables().
+        void setNumEdgeVerificationWorkers(int num_workers);
+        bool parallel_edge_verification = false;
+        int num_parallel_edge_candidates = 4; // includes the vertex being expanded
 
         std::shared_ptr<RobotModel> robot_model;
         std::shared_ptr<ManipulationFunction> f_s;
@@ -117,6 +171,13 @@ namespace planner{
         Eigen::VectorXd nn_std;
         bool enable_cpp_nn = false;
 
+        // Memoized classifier results keyed on the quantized raw classifier input. Used by both the
+        // CPP neural network and the ROS classifier service. Set the resolution and capacity with
+        // feasibility_cache.setResolution() and feasibility_cache.setCapacity().
+        // Cleared whenever the classifier is changed.
+        bool use_feasibility_cache = true;
+        FeasibilityCache feasibility_cache;
+
         std::vector<Footstep> input_footstep_list;
 
         // Body Path heuristic. Feet positions w.r.t hand pose
@@ -173,6 +234,8 @@ namespace planner{
         double delta_s = 0.0;
         bool first_node_evaluated = false;
         std::vector < std::shared_ptr<Node> > neighbors;
+        // Pool of neighbor vertices. Reset at the start of every search
+        NodeArena<LMVertex> vertex_arena;
         std::shared_ptr<LMVertex> parent_;
         std::shared_ptr<LMVertex> neighbor_change;
 
@@ -241,7 +304,7 @@ namespace planner{
         std::vector<double> edge_eval_times;
 
         TrajEuclidean   tmp_traj_q_config;     // Trajectory of configurations q
-        std::map<std::string, TrajEuclidean> edge_to_trajectory;
+        std::unordered_map<LatticeEdgeKey, TrajEuclidean, LatticeEdgeKeyHash> edge_to_trajectory;
 
     private:
         // Converts the input position and orientation 
@@ -295,6 +358,21 @@ namespace planner{
         // Queries the NN for feasibility along the s trajectory
         void computeHandTrajectoryFeasibility(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node);
 
+        // Batched CPP neural network queries. Each row is filled from the NN variables. Rows found in the
+        // feasibility cache are set directly and the others are evaluated with a single forward pass.
+        // Results are in cpp_nn_batch_pred after evaluateClassifierRows().
+        // Appends the rows of every s sample along the hand trajectory. Returns the number of rows added.
+        int appendHandTrajectoryRows(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node, int row);
+        // Appends all the rows needed for the feasibility of the edge. Returns the number of rows added.
+        int appendFeasibilityRows(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node, int row);
+        void setClassifierInputRow(int row);
+        void evaluateClassifierRows();
+
+        // Computes the feasibility score of the edges to all neighbors of current_ with one forward pass
+        void computeNeighborFeasibilities();
+        // Removes neighbors whose feasibility score is below the threshold
+        void filterInfeasibleNeighbors();
+
         // Feasibility function temporary variables 
         Eigen::Vector3d feasibility_stance_foot_pos;
         Eigen::Quaterniond feasibility_stance_foot_ori;
@@ -329,6 +407,10 @@ namespace planner{
 
         //        
         double getClassifierResult();
+        // Sets cpp_nn_rawDatum and cpp_nn_normalized_datum from the NN variables
+        void computeClassifierDatum();
+        // Sets the NN variables from a stored transition data file and computes the classifier datum
+        bool loadTransitionDatum(const std::string & filepath);
 
         // Helpers for setting up classifier input
         double prediction_result = 0.0;
@@ -347,6 +429,14 @@ namespace planner{
         int cpp_nn_input_size;
         Eigen::MatrixXd cpp_nn_data_input;
         Eigen::MatrixXd cpp_nn_pred;
+        Eigen::MatrixXd cpp_nn_batch_pred;
+        // Rows waiting for the forward pass: normalized inputs, raw inputs (one per column) and their batch row
+        Eigen::MatrixXd cpp_nn_batch_input;
+        Eigen::MatrixXd cpp_nn_batch_raw;
+        Eigen::MatrixXd cpp_nn_batch_input_pred;
+        std::vector<int> cpp_nn_batch_rows;
+        int cpp_nn_num_pending_rows = 0;
+        std::vector<int> neighbor_row_offsets;
 
 
         void addToXVector(const Eigen::Vector3d & pos, const Eigen::Quaterniond & ori, std::vector<double> & x);
@@ -381,7 +471,27 @@ namespace planner{
         void edgeFeasibilityTimeStop();
 
         // Get Edge Key
-        std::string getEdgeKey(shared_ptr<LMVertex> from_node, shared_ptr<LMVertex> to_node);
+        LatticeEdgeKey getEdgeKey(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node);
+
+        // Footstep taken along the edge, if any
+        void getEdgeFootstepList(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node, std::vector<Footstep> & footstep_list);
+
+        // Verifies the edge from parent_ to current_ and stores its trajectory in tmp_traj_q_config on convergence.
+        // Uses the result of a parallel verification when one exists for the same starting configuration.
+        bool verifyEdge();
+        // Verifies the incoming edges of current_ and the best open set candidates with the edge workers
+        void prefetchEdgeVerifications();
+        // Prefetches the edge verifications if parallel edge verification is enabled, then calls verifyEdge()
+        bool verifyCurrentEdge();
+        // Applies the settings of ctg to every worker ctg
+        void syncEdgeWorkerSettings();
+        bool edge_worker_settings_synced = false;
+
+        std::vector<EdgeVerificationWorker> edge_workers;
+        std::unordered_map<LatticeEdgeKey, EdgeVerificationResult, LatticeEdgeKeyHash> prefetched_edges;
+        std::vector< shared_ptr<Node> > edge_candidates;
+        std::vector<EdgeVerificationResult> edge_candidate_results;
+        std::vector< std::vector<Footstep> > edge_candidate_footsteps;
 
 
     };
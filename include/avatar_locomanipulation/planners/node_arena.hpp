@@ -0,0 +1,84 @@
+#ifndef ALM_NODE_ARENA_H
+#define ALM_NODE_ARENA_H
+
+#include <deque>
+#include <unordered_set>
+#include <vector>
+#include <memory>
+#include <Eigen/Core>
+
+namespace planner{
+
+	// Per-search pool of planner nodes. Nodes are constructed once and handed out again after
+	// being released or after reset(), so that their member storage (Eigen vectors, footstep
+	// contact lists) is reused instead of being reallocated for every neighbor. The deque storage
+	// keeps node addresses stable while the arena grows.
+	//
+	// Handles returned by getHandle() do not own the node. They remain valid until the node is
+	// released, the arena is reset or the arena is destroyed. Nodes which must outlive the search,
+	// e.g. the optimal path, have to be copied out before reset(). Use owns() to find them.
+	template <class T>
+	class NodeArena{
+	public:
+		NodeArena(): num_allocated(0) {}
+		~NodeArena() {}
+
+		// Returns a free node. The caller is responsible for reinitializing its contents.
+		T* allocate(){
+			if (!free_nodes.empty()){
+				T* node = free_nodes.back();
+				free_nodes.pop_back();
+				return node;
+			}
+			if (num_allocated == nodes.size()){
+				nodes.emplace_back();
+				node_addresses.insert(&nodes.back());
+			}
+			T* node = &nodes[num_allocated];
+			num_allocated++;
+			return node;
+		}
+
+		// Returns the node to the arena. Used for neighbors which are discarded right after
+		// creation, e.g. duplicates of nodes already in the closed or explored sets.
+		void release(T* node){
+			free_nodes.push_back(node);
+		}
+
+		// Non-owning handle which can be stored in the open, closed and explored sets
+		template <class Base>
+		std::shared_ptr<Base> getHandle(T* node) const{
+			return std::shared_ptr<Base>(std::shared_ptr<Base>(), node);
+		}
+
+		// True if node is stored in this arena, i.e. a handle to it does not own it
+		bool owns(const T* node) const{
+			return node_addresses.count(node) > 0;
+		}
+
+		// Makes all nodes available again. Previously returned handles become invalid.
+		void reset(){
+			num_allocated = 0;
+			free_nodes.clear();
+		}
+
+		// Number of nodes currently in use
+		size_t size() const{
+			return num_allocated - free_nodes.size();
+		}
+
+		// Number of nodes constructed so far
+		size_t capacity() const{
+			return nodes.size();
+		}
+
+	private:
+		std::deque<T, Eigen::aligned_allocator<T> > nodes;
+		std::vector<T*> free_nodes;
+		std::unordered_set<const T*> node_addresses;
+		size_t num_allocated;
+	};
+
+}
+
+#endif
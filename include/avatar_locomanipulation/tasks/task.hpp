@@ -50,6 +50,8 @@ public:
 	std::shared_ptr<RobotModel> robot_model;
 	std::string task_name = "empty task";
 	std::string frame_name = "no frame";
+	// Resolved frame_name used by the robot model queries. Set by the constructors of frame tasks.
+	FrameHandle frame_handle;
 
 protected:
 	double kp_task_gain_ = 1.0;
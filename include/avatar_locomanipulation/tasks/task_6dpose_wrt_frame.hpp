@@ -19,6 +19,7 @@ public:
 
 private:
 	std::string wrt_frame_name;
+	FrameHandle wrt_frame_handle;
 
 	Eigen::MatrixXd J_tmp;
 	Eigen::MatrixXd J_wrt;
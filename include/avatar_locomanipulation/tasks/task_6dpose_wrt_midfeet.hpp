@@ -18,6 +18,8 @@ public:
 private:
 	std::string left_foot_frame;
 	std::string right_foot_frame;
+	FrameHandle left_foot_frame_handle;
+	FrameHandle right_foot_frame_handle;
 
 	Eigen::MatrixXd J_tmp;
 	Eigen::MatrixXd J_lf;
@@ -28,6 +28,7 @@ public:
 private:
 	Eigen::VectorXd cur_joint_pos;
 	std::vector<std::string> joint_names_;
+	std::vector<JointHandle> joint_handles_;
 	
 };
 
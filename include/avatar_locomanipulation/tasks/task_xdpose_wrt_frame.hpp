@@ -20,6 +20,7 @@ public:
 
 private:
 	std::string wrt_frame_name;
+	FrameHandle wrt_frame_handle;
 	std::vector<int> task_dimensions;
 
 	Eigen::MatrixXd J_tmp;
@@ -5,6 +5,7 @@
 #include <avatar_locomanipulation/models/robot_model.hpp>
 #include <avatar_locomanipulation/walking/walking_pattern_generator.hpp>
 #include <avatar_locomanipulation/ik_module/ik_module.hpp>
+#include <avatar_locomanipulation/ik_module/batch_ik_solver.hpp>
 #include <avatar_locomanipulation/data_types/trajectory_SE3.hpp>
 
 #include <avatar_locomanipulation/data_types/manipulation_function.hpp>
@@ -38,6 +39,43 @@
 // reinitializeTaskStack()
 // setStartingConfig()
 
+// Snapshot of every user-facing setting of a ConfigTrajectoryGenerator: the task selection flags, the trajectory
+// parameters, the walking pattern parameters, and the parameters of the three IK modules.
+// Used to configure copies of a generator (eg: per-thread edge verification workers) identically to the original.
+class ConfigTrajectorySettings{
+public:
+	int N_size = 100;
+
+	bool use_right_hand = false;
+	bool use_left_hand = false;
+	bool use_torso_joint_position = true;
+	bool use_arm_lower_priority_posture_task = false;
+
+	int verbosity_level = CONFIG_TRAJECTORY_VERBOSITY_LEVEL_2;
+	double max_manipulation_task_ik_error = 1e-2;
+	bool solve_with_partial_divergence = false;
+	double traj_error_tol = 1e-2;
+	double manipulation_only_time = 3.0;
+
+	bool use_predictor_warm_start = false;
+	double predictor_gain = 1.0;
+	bool record_cold_start_iterations = false;
+
+	// Walking pattern generator parameters
+	double wpg_gravity = 9.81;
+	double wpg_z_vrp = 0.95;
+	double wpg_b = std::sqrt(0.95/9.81);
+	double wpg_t_ds = 0.45;
+	double wpg_t_ss = 1.0;
+	double wpg_t_settle = 0.0;
+	double wpg_t_transfer = 0.0;
+	double wpg_swing_height = 0.1;
+
+	IKParameters ik_starting_config_parameters;
+	IKParameters ik_locomanipulation_parameters;
+	IKParameters ik_manipulation_only_parameters;
+};
+
 class ConfigTrajectoryGenerator{
 public:
 	// Constructors
@@ -77,6 +115,22 @@ public:
     // If the feet are already flat on the ground q_out is set to the input q_guess.   
     bool computeInitialConfigForFlatGround(const Eigen::VectorXd & q_guess, Eigen::VectorXd & q_out); 
 
+    // Batched version of computeInitialConfigForFlatGround(). The IKs of all the guesses are solved concurrently with
+    // setNumInitialConfigThreads() threads. q_out_list[i] and convergence_list[i] are the result of q_guess_list[i].
+    // The results are the same as calling computeInitialConfigForFlatGround() on each guess with a single seed.
+    // Returns the number of converged guesses.
+    int computeInitialConfigsForFlatGround(const std::vector<Eigen::VectorXd> & q_guess_list, std::vector<Eigen::VectorXd> & q_out_list, std::vector<bool> & convergence_list);
+
+    // Number of threads used to solve the flat ground IKs. Default 1.
+    void setNumInitialConfigThreads(int num_threads_in);
+    // Multi-start IK of computeInitialConfigForFlatGround(). The seeds are q_guess, the nominal stance (q_guess with
+    // all joints at zero), then q_guess with the joints perturbed by up to +-seed_perturbation. They are solved with
+    // setNumInitialConfigThreads() threads and the first seed whose first task converges is used.
+    // Default 1 seed, i.e. the IK only starts from q_guess.
+    void setInitialConfigMultiStart(int num_seeds_in, double seed_perturbation_in);
+    // Seed of the latest computeInitialConfigForFlatGround() solution. 0 is q_guess.
+    int getLastInitialConfigSeedIdx();
+
     // Given an initial configuration and footstep data list input, compute the task space walking trajectory.
     // Warning: If hand tasks are enabled, they need to have been set already.
     bool computeConfigurationTrajectory(const Eigen::VectorXd & q_init, const std::vector<Footstep> & input_footstep_list);
@@ -95,6 +149,11 @@ public:
     // returns N_size
     int getDiscretizationSize();
 
+	// Returns all the settings of this generator.
+	ConfigTrajectorySettings getSettings();
+	// Applies the settings. Reinitializes the discretization and the task stack.
+	void applySettings(const ConfigTrajectorySettings & settings);
+
     // Sets the SE3 trajectories for the left and right hands
     void setLeftHandTrajectory(const TrajSE3 & traj_SE3_left_hand_in);
     void setRightHandTrajectory(const TrajSE3 & traj_SE3_right_hand_in);    
@@ -114,6 +173,32 @@ public:
 	// Default = false.
     void setSolveEvenWithPartialDivergence(bool solve_with_partial_divergence_in);
 
+	// Predictor-corrector warm start. If true, the IK of trajectory point i starts from the secant extrapolation
+	// of the two previous solutions, q_{i-1} + gain*(q_{i-1} - q_{i-2}) (tangent space), clamped to the joint limits,
+	// instead of q_{i-1}. The IK then acts as the corrector. Default = false, gain = 1.0
+	void setUsePredictorWarmStart(bool use_predictor_warm_start_in);
+	void setPredictorGain(double predictor_gain_in);
+	bool getUsePredictorWarmStart();
+	double getPredictorGain();
+
+	// IK iterations of each IK solve (one per trajectory point) of the latest configuration trajectory.
+	// Compare them with and without the predictor warm start to obtain the savings.
+	const std::vector<int> & getLastTrajectoryIKIterations();
+	const std::vector<int> & getLastTrajectoryIKMinorIterations();
+	int getLastTrajectoryNumIKSolves();
+
+	// Cold start baseline. If true, each trajectory point whose IK starts from a predicted seed is solved a second time
+	// from the previous solution q_{i-1} only, i.e. without the predictor, to record the baseline IK iterations.
+	// The baseline solve doubles the IK cost of the predicted points. It does not change the trajectory, unless the IK
+	// module reuses its inertia weight (inertia update threshold > 0). Default = false
+	void setRecordColdStartIterations(bool record_cold_start_iterations_in);
+	// Baseline IK iterations of each IK solve of the latest configuration trajectory. Points without a predicted
+	// seed have the same iterations as getLastTrajectoryIKIterations(). Empty if the baseline is not recorded.
+	const std::vector<int> & getLastTrajectoryColdStartIKIterations();
+	// Total IK iterations saved by the predictor over the latest trajectory: cold start minus warm start iterations.
+	// 0 if the baseline is not recorded.
+	int getLastTrajectoryIKIterationSavings();
+
     // Public Member Variables
 	std::shared_ptr<RobotModel> robot_model;
 
@@ -188,12 +273,24 @@ private:
 	// Reference will use the initial joint configuration in traj_q_config.
 	void getSelectedPostureTaskReferences(std::vector<std::string> & selected_names, const Eigen::VectorXd & q_config, Eigen::VectorXd & q_ref);
 
+	// Removes the joints which are not in the robot model, i.e. the joints locked by a ReducedRobotModel.
+	// The configuration trajectory is then expressed in the configuration space of the reduced model.
+	void removeLockedJoints(std::vector<std::string> & joint_names);
+	// Removes the posture tasks left without joints by removeLockedJoints from a task stack
+	void removeEmptyTasks(std::vector< std::shared_ptr<Task> > & tasks);
+
 	bool use_right_hand = false;
 	bool use_left_hand = false;
 	bool use_torso_joint_position = true;
 	bool use_arm_lower_priority_posture_task = false;
 
 	
+	// Frames and joints resolved once in setRobotModel
+	FrameHandle left_cop_frame_handle;
+	FrameHandle right_cop_frame_handle;
+	FrameHandle pelvis_frame_handle;
+	std::vector<JointHandle> zero_posture_joint_handles;
+
 	Eigen::Quaterniond tmp_pelvis_ori;
 	Eigen::Vector3d tmp_pelvis_pos;
 
@@ -224,6 +321,33 @@ private:
 
 	double manipulation_only_time = 3.0;
 
+	bool use_predictor_warm_start = false;
+	double predictor_gain = 1.0;
+	Eigen::VectorXd q_prev; // solution of trajectory point i-2
+	Eigen::VectorXd q_seed; // predicted starting configuration of the IK
+	Eigen::VectorXd dq_predictor;
+
+	std::vector<int> last_traj_ik_iters;
+	std::vector<int> last_traj_ik_minor_iters;
+
+	bool record_cold_start_iterations = false;
+	std::vector<int> last_traj_cold_start_ik_iters;
+
+	// Flat ground IK batch solver. Worker 0 is ik_starting_config_module, the other workers are the starting
+	// configuration IKs of generators on RobotModelContexts of robot_model.
+	BatchIKSolver initial_config_solver;
+	std::vector< std::shared_ptr<ConfigTrajectoryGenerator> > initial_config_workers;
+	int initial_config_num_threads = 1;
+	int initial_config_num_seeds = 1;
+	double initial_config_seed_perturbation = 0.2;
+	int last_initial_config_seed_idx = 0;
+
+	void prepareInitialConfigSolver();
+	std::vector< std::shared_ptr<Task> > getStartingConfigReferenceTasks();
+	// Creates the flat ground IK job of q_guess. Returns false if the feet are already flat on the ground.
+	bool createInitialConfigJob(const Eigen::VectorXd & q_guess, BatchIKJob & job);
+	void printInitialConfigResult(const BatchIKResult & result);
+
 };
 
 
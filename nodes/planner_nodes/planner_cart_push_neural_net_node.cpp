@@ -6,6 +6,9 @@
 #include <avatar_locomanipulation/planners/a_star_planner.hpp>
 #include <avatar_locomanipulation/planners/locomanipulation_a_star_planner.hpp>
 
+// Fixed topology version of the neural network
+#include <avatar_locomanipulation/helpers/FixedNeuralNet.hpp>
+
 
 // YAML
 #include <avatar_locomanipulation/helpers/yaml_data_saver.hpp>
@@ -82,6 +85,8 @@ void test_LM_planner(){
   std::cout << "Loading Model..." << std::endl;
   myYAML::Node model = myYAML::LoadFile(model_path);
   std::shared_ptr<NeuralNetModel> nn_transition_model(new NeuralNetModel(model, false));
+  // Evaluate the double precision queries with the fixed topology network. Keeps the dynamic path if the topology differs.
+  nn_transition_model->SetFixedNetwork(FixedNeuralNet<32, 64, 64, 64, 1>::Create(model));
 
   std::cout << "Loaded" << std::endl;
 
@@ -188,6 +193,33 @@ void test_LM_planner(){
   lm_planner.w_distance = 2000;
   lm_planner.generateDiscretization();
 
+  // Parallel edge verification. Used by the configuration trajectory checks when the classifier is not trusted.
+  // Set the number of threads with the private parameter ~num_edge_verification_threads. Default 1 (serial).
+  ros::NodeHandle private_node("~");
+  int num_edge_verification_threads = 1;
+  private_node.param<int>("num_edge_verification_threads", num_edge_verification_threads, 1);
+  if (num_edge_verification_threads > 1){
+    lm_planner.setNumEdgeVerificationWorkers(num_edge_verification_threads);
+  }
+
+  // Neural network inference precision. Set ~nn_inference_precision to "double" (default), "float32", or "int8".
+  // int8 is calibrated on the transition data files (transitions_data_with_task_space_info) listed in ~nn_calibration_data_files.
+  std::string nn_inference_precision = "double";
+  std::vector<std::string> nn_calibration_data_files;
+  private_node.param<std::string>("nn_inference_precision", nn_inference_precision, "double");
+  private_node.param< std::vector<std::string> >("nn_calibration_data_files", nn_calibration_data_files, std::vector<std::string>());
+  if (nn_inference_precision.compare("float32") == 0){
+    lm_planner.setNeuralNetworkPrecision(SinglePrecision);
+  }else if (nn_inference_precision.compare("int8") == 0){
+    if (lm_planner.calibrateNeuralNetwork(nn_calibration_data_files)){
+      lm_planner.setNeuralNetworkPrecision(Int8Quantized);
+    }else{
+      std::cout << "Error. int8 inference requires ~nn_calibration_data_files. Using double precision." << std::endl;
+    }
+  }else if (nn_inference_precision.compare("double") != 0){
+    std::cout << "Error. Unknown ~nn_inference_precision " << nn_inference_precision << ". Using double precision." << std::endl;
+  }
+
 
   double s_init = 0.0;
   double s_goal = 0.6; //0.20; //0.12;//0.08;
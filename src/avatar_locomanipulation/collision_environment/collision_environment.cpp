@@ -1,5 +1,12 @@
 #include <avatar_locomanipulation/collision_environment/collision_environment.h>
 
+// GJK warm start uses the cached guesses of hpp-fcl >= 1.5
+#ifdef HPP_FCL_VERSION_AT_LEAST
+#if HPP_FCL_VERSION_AT_LEAST(1,5,0)
+#define COLLISION_ENVIRONMENT_GJK_WARM_START
+#endif
+#endif
+
 
 CollisionEnvironment::CollisionEnvironment(std::shared_ptr<RobotModel> & val){
   valkyrie = val;
@@ -98,65 +105,307 @@ void CollisionEnvironment::append_models(){
   }
     first_time = false;
 
+  // appended was rebuilt, so were its geometry ids and collision pairs
+  build_collision_pair_tables();
+
 }
 
 
 
 
 void CollisionEnvironment::find_near_points(std::string & interest_link, const std::vector<std::string>  & list, std::map<std::string, Eigen::Vector3d> & from_near_points, std::map<std::string, Eigen::Vector3d> & to_near_points){
-  
+
+  from_near_points.clear();
+  to_near_points.clear();
+
   // first name in the vector is the link to which we want to get near_point pairs
-  std::string to_link_name = interest_link;
-  std::string from_link_name;
+  int to_link_id = get_collision_link_id(interest_link);
+  if(to_link_id < 0){
+    return;
+  }
+
+  get_collision_link_ids(list, tmp_list_ids);
+  find_near_points(to_link_id, tmp_list_ids, tmp_from_ids, tmp_from_near_points, tmp_to_near_points);
+
+  // fill the maps by "from" collision link name
+  for(int i=0; i<tmp_from_ids.size(); ++i){
+    const std::string & from_link_name = appended->geomModel.geometryObjects[tmp_from_ids[i]].name;
+    from_near_points[from_link_name] = tmp_from_near_points[i];
+    to_near_points[from_link_name] = tmp_to_near_points[i];
+  }
 
+}
+
+
+void CollisionEnvironment::find_near_points(int interest_link_id, const std::vector<int> & list_ids, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points){
+
+  from_ids.clear();
   from_near_points.clear();
   to_near_points.clear();
 
-  for(int i=0; i<list.size(); ++i){
-    // iterating thru rest of list, we get pairs with each of the other links
-    from_link_name = list[i];
-
-    // loop thru all of the collision pairs
-    for(int j=0; j<appended->geomModel.collisionPairs.size(); ++j){
-      // grab this collision pair
-      pinocchio::CollisionPair id2 = appended->geomModel.collisionPairs[j];
-
-      // check if pair.first and pair.second are our pair
-      if((appended->geomModel.getGeometryName(id2.first) == to_link_name && appended->geomModel.getGeometryName(id2.second) == from_link_name)){
-        
-        // if this is our pair, computeDistance
-        appended->dresult = pinocchio::computeDistance(appended->geomModel, *(appended->geomData), appended->geomModel.findCollisionPair(id2));
-        
-        // fill this map with nearest point on from object 
-          // (i.e nearest point on link list[i] to link list[0])
-        from_near_points[from_link_name] = appended->dresult.nearest_points[1];
-        
-        // fill this map with nearest point on to object 
-          // (i.e nearest point on link list[0] to link list[i])       
-        to_near_points[from_link_name] = appended->dresult.nearest_points[0];
-      } // First if closed
-      
-      // check if pair.second and pair.first are our pair 
-      //  (note that we do not know a priori which is pair.first and pair.second respectively)
-      else if((appended->geomModel.getGeometryName(id2.first) == from_link_name && appended->geomModel.getGeometryName(id2.second) == to_link_name)){
-        
-        // if this is our pair, computeDistance
-        appended->dresult = pinocchio::computeDistance(appended->geomModel, *(appended->geomData), appended->geomModel.findCollisionPair(id2));
-        
-        // fill this map with nearest point on from object 
-          // (i.e nearest point on link list[i] to link list[0])
-        from_near_points[from_link_name] = appended->dresult.nearest_points[0];
-        
-        // fill this map with nearest point on to object 
-          // (i.e nearest point on link list[0] to link list[i])
-        to_near_points[from_link_name] = appended->dresult.nearest_points[1];
-      
-      } // else if closed
-
-    } // Inner for closed (i.e for this pair we have found the collisionpair and filled our map)
-
-  } // Outer for closed (i.e we have found nearest_point pairs for every link in our input list)
+  Eigen::Vector3d to_center, to_half_extents, from_center, from_half_extents;
+  if(use_broadphase && (interest_link_id >= 0) && (interest_link_id < num_collision_links)){
+    get_world_aabb(interest_link_id, to_center, to_half_extents);
+  }
+
+  // closest culled pair, evaluated if the broadphase culls every pair
+  int closest_culled_index = -1;
+  double closest_culled_distance = 0.0;
+
+  for(int i=0; i<list_ids.size(); ++i){
+    // look up the collision pair of this link with the interest link
+    int pair_index = get_collision_pair_index(interest_link_id, list_ids[i]);
+    if(pair_index < 0){
+      continue;
+    }
+
+    // Broadphase: distance between the world AABBs
+    if(use_broadphase){
+      get_world_aabb(list_ids[i], from_center, from_half_extents);
+      double aabb_distance = ((from_center - to_center).cwiseAbs() - (from_half_extents + to_half_extents)).cwiseMax(0.0).norm();
+      if(aabb_distance > broadphase_cutoff){
+        num_culled_pairs++;
+        if((closest_culled_index < 0) || (aabb_distance < closest_culled_distance)){
+          closest_culled_index = i;
+          closest_culled_distance = aabb_distance;
+        }
+        continue;
+      }
+    }
+
+    compute_near_points(interest_link_id, list_ids[i], pair_index, from_ids, from_near_points, to_near_points);
+
+  } // (i.e we have found nearest_point pairs for every link in our input list)
+
+  // keep at least one pair so that the directed vectors are never empty
+  if(from_ids.empty() && (closest_culled_index >= 0)){
+    num_culled_pairs--;
+    compute_near_points(interest_link_id, list_ids[closest_culled_index], get_collision_pair_index(interest_link_id, list_ids[closest_culled_index]),
+                        from_ids, from_near_points, to_near_points);
+  }
+
+}
+
+
+void CollisionEnvironment::compute_near_points(int interest_link_id, int from_link_id, int pair_index, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points){
+  // Pairs with an object body are answered by its distance field
+  if(use_object_sdf && ((object_sdfs[interest_link_id] != nullptr) || (object_sdfs[from_link_id] != nullptr))){
+    compute_near_points_sdf(interest_link_id, from_link_id, from_ids, from_near_points, to_near_points);
+    return;
+  }
+  // Pairs of bodies with proxies are answered in closed form
+  if(use_proxy_geometry && !link_proxies[interest_link_id].empty() && !link_proxies[from_link_id].empty()){
+    compute_near_points_proxy(interest_link_id, from_link_id, from_ids, from_near_points, to_near_points);
+    return;
+  }
+
+  const pinocchio::CollisionPair & pair = appended->geomModel.collisionPairs[pair_index];
+  const pinocchio::SE3 & oMfirst = appended->geomData->oMg[pair.first];
+  const pinocchio::SE3 & oMsecond = appended->geomData->oMg[pair.second];
+  PairDistanceCache & cache = pair_distance_cache[pair_index];
+
+  // nearest points on pair.first and pair.second
+  Eigen::Vector3d first_point, second_point;
+
+  double motion_bound = 0.0;
+  if(use_distance_cache && cache.valid){
+    motion_bound = get_link_motion_bound(pair.first, cache.oMfirst) + get_link_motion_bound(pair.second, cache.oMsecond);
+  }
+
+  if(use_distance_cache && cache.valid && (cache.distance - motion_bound > std::max(safety_dist_normal, safety_dist_collision))){
+    // The links are still farther apart than the safety distance. Move the cached points with their links
+    first_point = oMfirst.act(cache.oMfirst.actInv(cache.first_point));
+    second_point = oMsecond.act(cache.oMsecond.actInv(cache.second_point));
+    num_cached_pairs++;
+  }
+  else{
+#ifdef COLLISION_ENVIRONMENT_GJK_WARM_START
+    // start GJK from the guess of the previous query of this pair
+    appended->geomData->distanceRequests[pair_index].enable_cached_gjk_guess = cache.valid;
+#endif
+    appended->dresult = pinocchio::computeDistance(appended->geomModel, *(appended->geomData), pair_index);
+    num_evaluated_pairs++;
+#ifdef COLLISION_ENVIRONMENT_GJK_WARM_START
+    appended->geomData->distanceRequests[pair_index].cached_gjk_guess = appended->dresult.cached_gjk_guess;
+#endif
+
+    first_point = appended->dresult.nearest_points[0];
+    second_point = appended->dresult.nearest_points[1];
+
+    cache.valid = true;
+    cache.distance = appended->dresult.min_distance;
+    cache.first_point = first_point;
+    cache.second_point = second_point;
+    cache.oMfirst = oMfirst;
+    cache.oMsecond = oMsecond;
+  }
+
+  // We do not know a priori which of the two is the interest link
+  from_ids.push_back(from_link_id);
+  if(pair.first == interest_link_id){
+    // nearest point on the from object (i.e nearest point on link list[i] to the interest link)
+    from_near_points.push_back(second_point);
+    // nearest point on the to object (i.e nearest point on the interest link to link list[i])
+    to_near_points.push_back(first_point);
+  }
+  else{
+    from_near_points.push_back(first_point);
+    to_near_points.push_back(second_point);
+  }
+}
+
+
+void CollisionEnvironment::compute_near_points_sdf(int interest_link_id, int from_link_id, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points){
+  int sdf_link_id = (object_sdfs[interest_link_id] != nullptr) ? interest_link_id : from_link_id;
+  int sphere_link_id = (sdf_link_id == interest_link_id) ? from_link_id : interest_link_id;
+  const pinocchio::SE3 & oMsdf = appended->geomData->oMg[sdf_link_id];
+  const pinocchio::SE3 & oMsphere = appended->geomData->oMg[sphere_link_id];
+  const std::vector<CollisionSphere> & spheres = link_sphere_sets[sphere_link_id];
+
+  Eigen::Vector3d center, gradient, normal;
+  Eigen::Vector3d sdf_point, sphere_point;
+  double distance, gap;
+  double min_gap = 0.0;
+
+  // keep the sphere closest to the object
+  for(int i=0; i<spheres.size(); ++i){
+    center = oMsphere.act(spheres[i].center);
+    distance = object_sdfs[sdf_link_id]->getDistanceAndGradient(oMsdf.actInv(center), gradient);
+    gap = distance - spheres[i].radius;
+    if((i > 0) && (gap >= min_gap)){
+      continue;
+    }
+    min_gap = gap;
+
+    // the gradient points away from the object
+    normal = oMsdf.rotation()*gradient;
+    if(normal.norm() > 1e-9){
+      normal.normalize();
+    }
+    else{
+      normal = Eigen::Vector3d::UnitZ();
+    }
+    sphere_point = center - spheres[i].radius*normal;
+    // if the sphere penetrates the object, both near points coincide so that the collision is detected
+    sdf_point = (gap > 0.0) ? (center - distance*normal) : sphere_point;
+  }
+  num_sdf_pairs++;
 
+  from_ids.push_back(from_link_id);
+  if(sdf_link_id == interest_link_id){
+    from_near_points.push_back(sphere_point);
+    to_near_points.push_back(sdf_point);
+  }
+  else{
+    from_near_points.push_back(sdf_point);
+    to_near_points.push_back(sphere_point);
+  }
+}
+
+
+void CollisionEnvironment::compute_near_points_proxy(int interest_link_id, int from_link_id, std::vector<int> & from_ids, std::vector<Eigen::Vector3d> & from_near_points, std::vector<Eigen::Vector3d> & to_near_points){
+  Eigen::Vector3d interest_point, from_point;
+  double distance = collision_proxies::capsule_set_distance(link_proxies[interest_link_id], appended->geomData->oMg[interest_link_id],
+                                                            link_proxies[from_link_id], appended->geomData->oMg[from_link_id],
+                                                            interest_point, from_point);
+  num_proxy_pairs++;
+
+  // if the proxies penetrate, both near points coincide so that the collision is detected
+  if(distance <= 0.0){
+    interest_point = 0.5*(interest_point + from_point);
+    from_point = interest_point;
+  }
+
+  from_ids.push_back(from_link_id);
+  from_near_points.push_back(from_point);
+  to_near_points.push_back(interest_point);
+}
+
+
+double CollisionEnvironment::get_link_motion_bound(int link_id, const pinocchio::SE3 & oMg_cached){
+  const pinocchio::SE3 & oMg = appended->geomData->oMg[link_id];
+  // A point x of the link moves by (R - R_cached)x + (p - p_cached), and |(R - R_cached)x| <= angle*|x|
+  double angle = Eigen::AngleAxisd(oMg_cached.rotation().transpose()*oMg.rotation()).angle();
+  return (oMg.translation() - oMg_cached.translation()).norm() + angle*link_bounding_radii[link_id];
+}
+
+
+void CollisionEnvironment::get_world_aabb(int link_id, Eigen::Vector3d & center, Eigen::Vector3d & half_extents){
+  const pinocchio::SE3 & oMg = appended->geomData->oMg[link_id];
+  center = oMg.rotation()*local_aabb_centers[link_id] + oMg.translation();
+  // the rotated box is bounded by |R| times the local half extents
+  half_extents = oMg.rotation().cwiseAbs()*local_aabb_half_extents[link_id];
+}
+
+
+
+int CollisionEnvironment::get_collision_link_id(const std::string & link_name){
+  std::map<std::string, int>::iterator it = collision_name_to_id.find(link_name);
+  if(it == collision_name_to_id.end()){
+    return -1;
+  }
+  return it->second;
+}
+
+
+void CollisionEnvironment::get_collision_link_ids(const std::vector<std::string> & link_names, std::vector<int> & link_ids){
+  link_ids.clear();
+  int id;
+  for(int i=0; i<link_names.size(); ++i){
+    id = get_collision_link_id(link_names[i]);
+    if(id >= 0){
+      link_ids.push_back(id);
+    }
+  }
+}
+
+
+int CollisionEnvironment::get_collision_pair_index(int link_id_a, int link_id_b){
+  if((link_id_a < 0) || (link_id_b < 0) || (link_id_a >= num_collision_links) || (link_id_b >= num_collision_links)){
+    return -1;
+  }
+  return collision_pair_table[link_id_a*num_collision_links + link_id_b];
+}
+
+
+void CollisionEnvironment::build_collision_pair_tables(){
+  num_collision_links = appended->geomModel.geometryObjects.size();
+
+  collision_name_to_id.clear();
+  for(int i=0; i<num_collision_links; ++i){
+    collision_name_to_id[appended->geomModel.geometryObjects[i].name] = i;
+  }
+
+  // local AABBs for the broadphase
+  local_aabb_centers.resize(num_collision_links);
+  local_aabb_half_extents.resize(num_collision_links);
+  for(int i=0; i<num_collision_links; ++i){
+    appended->geomModel.geometryObjects[i].geometry->computeLocalAABB();
+    const pinocchio::fcl::AABB & aabb = appended->geomModel.geometryObjects[i].geometry->aabb_local;
+    local_aabb_centers[i] = 0.5*(aabb.max_ + aabb.min_);
+    local_aabb_half_extents[i] = 0.5*(aabb.max_ - aabb.min_);
+  }
+
+  // radii for the motion bounds of the distance cache
+  link_bounding_radii.resize(num_collision_links);
+  for(int i=0; i<num_collision_links; ++i){
+    link_bounding_radii[i] = local_aabb_centers[i].norm() + local_aabb_half_extents[i].norm();
+  }
+
+  build_link_sphere_sets();
+  build_link_proxies();
+  // object bodies with distance fields are set by build_object_sdfs once the object links are known
+  object_sdfs.assign(num_collision_links, std::shared_ptr<SignedDistanceField>());
+
+  // both orderings of a pair point to the same pair index
+  collision_pair_table.assign(num_collision_links*num_collision_links, -1);
+  // pair indices changed, so the cached distances are stale
+  clear_distance_cache();
+  for(int j=0; j<appended->geomModel.collisionPairs.size(); ++j){
+    const pinocchio::CollisionPair & pair = appended->geomModel.collisionPairs[j];
+    collision_pair_table[pair.first*num_collision_links + pair.second] = j;
+    collision_pair_table[pair.second*num_collision_links + pair.first] = j;
+  }
 }
 
 
@@ -205,6 +454,7 @@ void CollisionEnvironment::build_self_directed_vectors(const std::string & frame
       // Fill the dvector and push back
       dvector.from = collision_to_frame.find(it->first)->second; dvector.to = collision_to_frame.find(to_link)->second;
       dvector.direction = difference.normalized(); dvector.magnitude = difference.norm();
+      dvector.from_point = it->second; dvector.to_point = to_near_points[it->first];
       dvector.using_worldFramePose = false;
       directed_vectors.push_back(dvector);
     }
@@ -245,6 +495,7 @@ void CollisionEnvironment::build_point_list_directed_vectors(const std::vector<E
     // Fill the dvector and push_back
     dvector.from = myString; dvector.to = frame_name;
     dvector.direction = difference.normalized(); dvector.magnitude = difference.norm();
+    dvector.from_point = cur_pos_from; dvector.to_point = cur_pos_to;
     dvector.using_worldFramePose = false;
     directed_vectors.push_back(dvector);
     
@@ -295,6 +546,7 @@ void CollisionEnvironment::build_object_directed_vectors(std::string & frame_nam
       // Fill the dvector and push back
       dvector.from = collision_to_frame[object_links[i]]; dvector.to = collision_to_frame.find(it->first)->second;
       dvector.direction = difference.normalized(); dvector.magnitude = difference.norm();
+      dvector.from_point = it->second; dvector.to_point = to_near_points[it->first];
       dvector.using_worldFramePose = false;
       directed_vectors.push_back(dvector);
       } // end else
@@ -385,6 +637,11 @@ void CollisionEnvironment::add_new_object(std::shared_ptr<RobotModel> & obj, con
   // Adds this objects collision and frame names to collision_to_frame
   map_collision_names_to_frame_names();
 
+  // Distance fields of the object bodies
+  if(use_object_sdf){
+    build_object_sdfs();
+  }
+
   std::cout << "[RobotModel] Environmental Object Created and appended in [CollisionEnvironment]" << std::endl;
 }
 
@@ -393,6 +650,207 @@ void CollisionEnvironment::add_new_object(std::shared_ptr<RobotModel> & obj, con
 
 
 
+void CollisionEnvironment::enable_broadphase(bool enable){
+  use_broadphase = enable;
+}
+
+void CollisionEnvironment::set_broadphase_cutoff(double cutoff_in){
+  broadphase_cutoff = cutoff_in;
+  if(broadphase_cutoff < safety_dist_collision){
+    std::cout << "[CollisionEnvironment] Warning. Broadphase cutoff " << broadphase_cutoff << " is below the collision safety distance " << safety_dist_collision << ". Culled pairs may change the collision potential" << std::endl;
+  }
+}
+
+void CollisionEnvironment::enable_distance_cache(bool enable){
+  use_distance_cache = enable;
+}
+
+void CollisionEnvironment::clear_distance_cache(){
+  pair_distance_cache.assign(appended->geomModel.collisionPairs.size(), PairDistanceCache());
+}
+
+int CollisionEnvironment::get_num_cached_pairs(){
+  return num_cached_pairs;
+}
+
+void CollisionEnvironment::build_link_sphere_sets(){
+  link_sphere_sets.resize(num_collision_links);
+  Eigen::Vector3d half_extents;
+  int axis;
+  for(int i=0; i<num_collision_links; ++i){
+    half_extents = local_aabb_half_extents[i];
+    half_extents.maxCoeff(&axis);
+    // cross section radius of the box, then spheres spaced along the longest axis such that they cover the box
+    double cross_radius = std::sqrt(half_extents.squaredNorm() - half_extents[axis]*half_extents[axis]);
+    int num_spheres = std::max(1, static_cast<int>(std::ceil(half_extents[axis]/std::max(cross_radius, 1e-3))));
+    double spacing = 2.0*half_extents[axis]/num_spheres;
+
+    link_sphere_sets[i].resize(num_spheres);
+    for(int k=0; k<num_spheres; ++k){
+      link_sphere_sets[i][k].center = local_aabb_centers[i];
+      link_sphere_sets[i][k].center[axis] += -half_extents[axis] + (k + 0.5)*spacing;
+      link_sphere_sets[i][k].radius = std::sqrt(cross_radius*cross_radius + 0.25*spacing*spacing);
+    }
+  }
+}
+
+void CollisionEnvironment::build_object_sdfs(){
+  object_sdfs.assign(num_collision_links, std::shared_ptr<SignedDistanceField>());
+  int link_id;
+  for(int i=0; i<object_links.size(); ++i){
+    link_id = get_collision_link_id(object_links[i]);
+    if(link_id < 0){
+      continue;
+    }
+    // The field of a mesh is unsigned and cannot resolve penetrations, mesh objects keep the narrowphase
+    if(appended->geomModel.geometryObjects[link_id].geometry->getObjectType() == pinocchio::fcl::OT_BVH){
+      std::cout << "[CollisionEnvironment] " << object_links[i] << " is a mesh. Its distances are computed by the narrowphase" << std::endl;
+      continue;
+    }
+    std::shared_ptr<SignedDistanceField> sdf(new SignedDistanceField());
+    bool loaded = sdf->buildFromGeometry(*(appended->geomModel.geometryObjects[link_id].geometry), sdf_resolution, sdf_padding, sdf_cache_directory);
+    std::cout << "[CollisionEnvironment] Distance field of " << object_links[i] << (loaded ? " loaded from the cache" : " built") << " with " << sdf->getNumVoxels() << " voxels" << std::endl;
+    object_sdfs[link_id] = sdf;
+  }
+}
+
+void CollisionEnvironment::enable_object_sdf(bool enable){
+  use_object_sdf = enable;
+  if(use_object_sdf && object_flag){
+    build_object_sdfs();
+  }
+}
+
+void CollisionEnvironment::set_object_sdf_parameters(double resolution_in, double padding_in, const std::string & cache_directory_in){
+  sdf_resolution = resolution_in;
+  sdf_padding = padding_in;
+  sdf_cache_directory = cache_directory_in;
+  if(use_object_sdf && object_flag){
+    build_object_sdfs();
+  }
+}
+
+int CollisionEnvironment::get_num_sdf_pairs(){
+  return num_sdf_pairs;
+}
+
+void CollisionEnvironment::build_link_proxies(){
+  link_proxies.assign(num_collision_links, std::vector<CollisionCapsule>());
+  std::map<std::string, std::vector<CollisionCapsule> >::iterator it;
+  for(int i=0; i<num_collision_links; ++i){
+    it = proxy_library.find(appended->geomModel.geometryObjects[i].name);
+    if(it != proxy_library.end()){
+      link_proxies[i] = it->second;
+    }
+  }
+}
+
+void CollisionEnvironment::warn_links_without_proxies(){
+  // Pairs with these robot bodies fall back to the collision geometry in compute_near_points
+  int num_robot_links = std::min((int) valkyrie->geomModel.geometryObjects.size(), (int) link_proxies.size());
+  for(int i=0; i<num_robot_links; ++i){
+    if(link_proxies[i].empty()){
+      std::cout << "[CollisionEnvironment] Warning. No proxy for " << appended->geomModel.geometryObjects[i].name << ", its pairs use the collision mesh" << std::endl;
+    }
+  }
+}
+
+void CollisionEnvironment::enable_proxy_geometry(bool enable){
+  use_proxy_geometry = enable;
+  if(use_proxy_geometry && proxy_library.empty()){
+    std::cout << "[CollisionEnvironment] Warning. No proxies are loaded, see load_link_proxies" << std::endl;
+  }
+}
+
+bool CollisionEnvironment::using_proxy_geometry(){
+  return use_proxy_geometry;
+}
+
+bool CollisionEnvironment::load_link_proxies(const std::string & filename){
+  if(!collision_proxies::load_proxies(filename, proxy_library)){
+    return false;
+  }
+  build_link_proxies();
+
+  int num_bodies = 0;
+  for(int i=0; i<num_collision_links; ++i){
+    num_bodies += link_proxies[i].empty() ? 0 : 1;
+  }
+  std::cout << "[CollisionEnvironment] Loaded proxies of " << num_bodies << "/" << num_collision_links << " collision bodies from " << filename << std::endl;
+  warn_links_without_proxies();
+  return true;
+}
+
+bool CollisionEnvironment::fit_link_proxies(const std::string & filename){
+  std::map<std::string, std::vector<CollisionCapsule> > proxies;
+  for(int i=0; i<valkyrie->geomModel.geometryObjects.size(); ++i){
+    const pinocchio::GeometryObject & object = valkyrie->geomModel.geometryObjects[i];
+    object.geometry->computeLocalAABB();
+    if(!collision_proxies::fit_geometry(*(object.geometry), proxies[object.name])){
+      std::cout << "[CollisionEnvironment] Warning. Unknown geometry type of " << object.name << ", its proxy covers its AABB" << std::endl;
+    }
+  }
+  if(!collision_proxies::save_proxies(filename, proxies)){
+    return false;
+  }
+  proxy_library = proxies;
+  build_link_proxies();
+  return true;
+}
+
+void CollisionEnvironment::get_point_jacobians(std::shared_ptr<RobotModel> & robot_model, const DirectedVectors & dvec, Eigen::MatrixXd & J_from, Eigen::MatrixXd & J_to){
+  Eigen::MatrixXd J_frame = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
+  Eigen::Vector3d frame_pos, lever;
+  Eigen::Quaternion<double> frame_ori;
+  Eigen::Matrix3d lever_hat;
+
+  const std::string * frame_names[2] = {&dvec.from, &dvec.to};
+  const Eigen::Vector3d * points[2] = {&dvec.from_point, &dvec.to_point};
+  Eigen::MatrixXd * jacobians[2] = {&J_from, &J_to};
+
+  for(int k=0; k<2; ++k){
+    *(jacobians[k]) = Eigen::MatrixXd::Zero(3, robot_model->getDimQdot());
+    if(!robot_model->model.existFrame(*(frame_names[k]))){
+      continue;
+    }
+    robot_model->get6DTaskJacobian(*(frame_names[k]), J_frame);
+    robot_model->getFrameWorldPose(*(frame_names[k]), frame_pos, frame_ori);
+    // v_point = v_frame + w x (point - frame_pos)
+    lever = *(points[k]) - frame_pos;
+    lever_hat << 0.0, -lever[2], lever[1],
+                 lever[2], 0.0, -lever[0],
+                 -lever[1], lever[0], 0.0;
+    *(jacobians[k]) = J_frame.topRows(3) - lever_hat*J_frame.bottomRows(3);
+  }
+}
+
+int CollisionEnvironment::get_num_proxy_pairs(){
+  return num_proxy_pairs;
+}
+
+int CollisionEnvironment::get_num_culled_pairs(){
+  return num_culled_pairs;
+}
+
+int CollisionEnvironment::get_num_evaluated_pairs(){
+  return num_evaluated_pairs;
+}
+
+void CollisionEnvironment::reset_pair_counters(){
+  num_culled_pairs = 0;
+  num_evaluated_pairs = 0;
+  num_cached_pairs = 0;
+  num_sdf_pairs = 0;
+  num_proxy_pairs = 0;
+}
+
+void CollisionEnvironment::print_pair_counters(){
+  std::cout << "[CollisionEnvironment] pairs culled by the broadphase: " << num_culled_pairs << ", pairs evaluated by the narrowphase: " << num_evaluated_pairs
+            << ", pairs served by the distance cache: " << num_cached_pairs << ", pairs answered by distance fields: " << num_sdf_pairs
+            << ", pairs answered by proxies: " << num_proxy_pairs << std::endl;
+}
+
+
 void CollisionEnvironment::set_safety_distance_normal(double safety_dist_normal_in){
   safety_dist_normal = safety_dist_normal_in;
 }
@@ -413,6 +871,7 @@ void CollisionEnvironment::get_dvector_collision_links(const std::string & from_
   difference = cur_pos_to - cur_pos_from;
   dvector.from = collision_to_frame.find(from_name)->second; dvector.to = collision_to_frame.find(to_name)->second;
   dvector.direction = difference.normalized(); dvector.magnitude = 0.005;
+  dvector.from_point = cur_pos_from; dvector.to_point = cur_pos_to;
   dvector.using_worldFramePose = true;
   directed_vectors.push_back(dvector);
 
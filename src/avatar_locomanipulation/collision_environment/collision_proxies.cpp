@@ -0,0 +1,284 @@
+#include <avatar_locomanipulation/collision_environment/collision_proxies.hpp>
+#include <avatar_locomanipulation/helpers/yaml_data_saver.hpp>
+#include <avatar_locomanipulation/collision_environment/fcl_mesh_vertices.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace collision_proxies{
+
+  namespace{
+    // Corners of the box center +- half_extents
+    void box_corners(const Eigen::Vector3d & center, const Eigen::Vector3d & half_extents, std::vector<Eigen::Vector3d> & corners){
+      corners.clear();
+      for(int i = 0; i < 8; i++){
+        corners.push_back(center + Eigen::Vector3d((i & 1) ? half_extents[0] : -half_extents[0],
+                                                   (i & 2) ? half_extents[1] : -half_extents[1],
+                                                   (i & 4) ? half_extents[2] : -half_extents[2]));
+      }
+    }
+
+    Eigen::Vector3d read_position(const YAML::Node & node){
+      return Eigen::Vector3d(node["x"].as<double>(), node["y"].as<double>(), node["z"].as<double>());
+    }
+  }
+
+  bool fit_geometry(const pinocchio::fcl::CollisionGeometry & geometry, std::vector<CollisionCapsule> & capsules){
+    capsules.clear();
+    // hpp-fcl shapes are centered on their frame, their dimensions are read from the local AABB
+    const pinocchio::fcl::AABB & aabb = geometry.aabb_local;
+    Eigen::Vector3d center = 0.5*(aabb.max_ + aabb.min_);
+    Eigen::Vector3d half_extents = 0.5*(aabb.max_ - aabb.min_);
+    CollisionCapsule capsule;
+    std::vector<Eigen::Vector3d> points;
+
+    switch(geometry.getNodeType()){
+      case pinocchio::fcl::GEOM_SPHERE:
+        capsule.a = center; capsule.b = center; capsule.radius = half_extents[0];
+        capsules.push_back(capsule);
+        return true;
+
+      // segments along z
+      case pinocchio::fcl::GEOM_CAPSULE:
+        capsule.radius = half_extents[0];
+        capsule.a = center - Eigen::Vector3d(0.0, 0.0, std::max(half_extents[2] - capsule.radius, 0.0));
+        capsule.b = center + Eigen::Vector3d(0.0, 0.0, std::max(half_extents[2] - capsule.radius, 0.0));
+        capsules.push_back(capsule);
+        return true;
+
+      case pinocchio::fcl::GEOM_CYLINDER:
+        capsule.radius = half_extents[0];
+        capsule.a = center - Eigen::Vector3d(0.0, 0.0, half_extents[2]);
+        capsule.b = center + Eigen::Vector3d(0.0, 0.0, half_extents[2]);
+        capsules.push_back(capsule);
+        return true;
+
+      case pinocchio::fcl::GEOM_BOX:{
+        // Flat boxes are split into strips along their middle axis so that the capsules stay thin
+        int axes[3] = {0, 1, 2};
+        std::sort(axes, axes + 3, [&](int i, int j){ return half_extents[i] > half_extents[j]; });
+        int num_strips = std::min(4, std::max(1, static_cast<int>(std::ceil(half_extents[axes[1]]/(2.0*std::max(half_extents[axes[2]], 1e-6))))));
+
+        Eigen::Vector3d strip_center, strip_half_extents = half_extents;
+        strip_half_extents[axes[1]] = half_extents[axes[1]]/num_strips;
+        for(int k = 0; k < num_strips; k++){
+          strip_center = center;
+          strip_center[axes[1]] += -half_extents[axes[1]] + (2*k + 1)*strip_half_extents[axes[1]];
+          box_corners(strip_center, strip_half_extents, points);
+          fit_points(points, strip_center, Eigen::Vector3d::Unit(axes[0]), capsule);
+          capsules.push_back(capsule);
+        }
+        return true;
+      }
+
+      default:
+        break;
+    }
+
+    // Meshes: principal axis of the vertices
+    const pinocchio::fcl::BVHModelBase * mesh = dynamic_cast<const pinocchio::fcl::BVHModelBase *>(&geometry);
+    if ((mesh != nullptr) && (mesh->num_vertices > 0)){
+      Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+      for(int i = 0; i < mesh->num_vertices; i++){
+        points.push_back(fcl_mesh::get_vertex(*mesh, i));
+        mean += points.back();
+      }
+      mean /= mesh->num_vertices;
+
+      Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+      for(int i = 0; i < points.size(); i++){
+        covariance += (points[i] - mean)*(points[i] - mean).transpose();
+      }
+      // eigenvalues are sorted in increasing order
+      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(covariance);
+      fit_points(points, mean, solver.eigenvectors().col(2), capsule);
+      capsules.push_back(capsule);
+      return true;
+    }
+
+    // Unknown geometry: cover its local AABB
+    int longest_axis;
+    half_extents.maxCoeff(&longest_axis);
+    box_corners(center, half_extents, points);
+    fit_points(points, center, Eigen::Vector3d::Unit(longest_axis), capsule);
+    capsules.push_back(capsule);
+    return false;
+  }
+
+  void fit_points(const std::vector<Eigen::Vector3d> & points, const Eigen::Vector3d & center, const Eigen::Vector3d & axis, CollisionCapsule & capsule){
+    Eigen::Vector3d u = axis.normalized();
+    std::vector<double> t(points.size()), d(points.size());
+    double radius = 0.0, sphere_radius = 0.0;
+    for(int i = 0; i < points.size(); i++){
+      t[i] = u.dot(points[i] - center);
+      d[i] = (points[i] - center - t[i]*u).norm();
+      radius = std::max(radius, d[i]);
+      sphere_radius = std::max(sphere_radius, (points[i] - center).norm());
+    }
+
+    // Point i is covered by the segment [t_a, t_b] if the segment reaches within sqrt(r^2 - d_i^2) of t_i
+    double t_a = std::numeric_limits<double>::max();
+    double t_b = -std::numeric_limits<double>::max();
+    double s;
+    for(int i = 0; i < points.size(); i++){
+      s = std::sqrt(std::max(radius*radius - d[i]*d[i], 0.0));
+      t_a = std::min(t_a, t[i] + s);
+      t_b = std::max(t_b, t[i] - s);
+    }
+    if (t_a > t_b){
+      // any point of [t_b, t_a] covers all the points
+      t_a = 0.5*(t_a + t_b);
+      t_b = t_a;
+    }
+
+    double capsule_volume = M_PI*radius*radius*(t_b - t_a) + (4.0/3.0)*M_PI*std::pow(radius, 3);
+    double sphere_volume = (4.0/3.0)*M_PI*std::pow(sphere_radius, 3);
+    if (sphere_volume < capsule_volume){
+      capsule.a = center; capsule.b = center; capsule.radius = sphere_radius;
+    }
+    else{
+      capsule.a = center + t_a*u; capsule.b = center + t_b*u; capsule.radius = radius;
+    }
+  }
+
+  void closest_points_segments(const Eigen::Vector3d & p1, const Eigen::Vector3d & q1, const Eigen::Vector3d & p2, const Eigen::Vector3d & q2,
+                               Eigen::Vector3d & c1, Eigen::Vector3d & c2){
+    const double eps = 1e-12;
+    Eigen::Vector3d d1 = q1 - p1;
+    Eigen::Vector3d d2 = q2 - p2;
+    Eigen::Vector3d r = p1 - p2;
+    double a = d1.squaredNorm();
+    double e = d2.squaredNorm();
+    double f = d2.dot(r);
+    double s, t;
+
+    if ((a <= eps) && (e <= eps)){
+      c1 = p1; c2 = p2;
+      return;
+    }
+    if (a <= eps){
+      s = 0.0;
+      t = std::min(std::max(f/e, 0.0), 1.0);
+    }
+    else{
+      double c = d1.dot(r);
+      if (e <= eps){
+        t = 0.0;
+        s = std::min(std::max(-c/a, 0.0), 1.0);
+      }
+      else{
+        double b = d1.dot(d2);
+        double denom = a*e - b*b;
+        // parallel segments: any s, pick 0
+        s = (denom > eps) ? std::min(std::max((b*f - c*e)/denom, 0.0), 1.0) : 0.0;
+        t = (b*s + f)/e;
+        if (t < 0.0){
+          t = 0.0;
+          s = std::min(std::max(-c/a, 0.0), 1.0);
+        }
+        else if (t > 1.0){
+          t = 1.0;
+          s = std::min(std::max((b - c)/a, 0.0), 1.0);
+        }
+      }
+    }
+    c1 = p1 + s*d1;
+    c2 = p2 + t*d2;
+  }
+
+  double capsule_set_distance(const std::vector<CollisionCapsule> & capsules_1, const pinocchio::SE3 & oM1,
+                              const std::vector<CollisionCapsule> & capsules_2, const pinocchio::SE3 & oM2,
+                              Eigen::Vector3d & near_point_1, Eigen::Vector3d & near_point_2){
+    double min_distance = std::numeric_limits<double>::max();
+    Eigen::Vector3d c1, c2, normal;
+    double separation, distance;
+
+    for(int i = 0; i < capsules_1.size(); i++){
+      Eigen::Vector3d a1 = oM1.act(capsules_1[i].a);
+      Eigen::Vector3d b1 = oM1.act(capsules_1[i].b);
+      for(int j = 0; j < capsules_2.size(); j++){
+        closest_points_segments(a1, b1, oM2.act(capsules_2[j].a), oM2.act(capsules_2[j].b), c1, c2);
+        separation = (c2 - c1).norm();
+        distance = separation - capsules_1[i].radius - capsules_2[j].radius;
+        if (distance >= min_distance){
+          continue;
+        }
+        min_distance = distance;
+        // intersecting segments have no normal, pick the direction between the body frames
+        if (separation > 1e-9){
+          normal = (c2 - c1)/separation;
+        }
+        else if ((oM2.translation() - oM1.translation()).norm() > 1e-9){
+          normal = (oM2.translation() - oM1.translation()).normalized();
+        }
+        else{
+          normal = Eigen::Vector3d::UnitZ();
+        }
+        near_point_1 = c1 + capsules_1[i].radius*normal;
+        near_point_2 = c2 - capsules_2[j].radius*normal;
+      }
+    }
+    return min_distance;
+  }
+
+  bool save_proxies(const std::string & filename, const std::map<std::string, std::vector<CollisionCapsule> > & proxies){
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "collision_proxies";
+    out << YAML::Value << YAML::BeginMap;
+    for(std::map<std::string, std::vector<CollisionCapsule> >::const_iterator it = proxies.begin(); it != proxies.end(); ++it){
+      out << YAML::Key << it->first;
+      out << YAML::Value << YAML::BeginSeq;
+      for(int i = 0; i < it->second.size(); i++){
+        out << YAML::BeginMap;
+        data_saver::emit_position(out, "a", it->second[i].a);
+        data_saver::emit_position(out, "b", it->second[i].b);
+        data_saver::emit_value(out, "radius", it->second[i].radius);
+        out << YAML::EndMap;
+      }
+      out << YAML::EndSeq;
+    }
+    out << YAML::EndMap;
+    out << YAML::EndMap;
+
+    std::ofstream file(filename.c_str());
+    if (!file.is_open()){
+      std::cerr << "[collision_proxies] Error. Could not open " << filename << std::endl;
+      return false;
+    }
+    file << out.c_str() << std::endl;
+    return file.good();
+  }
+
+  bool load_proxies(const std::string & filename, std::map<std::string, std::vector<CollisionCapsule> > & proxies){
+    std::ifstream file(filename.c_str());
+    if (!file.is_open()){
+      std::cerr << "[collision_proxies] Error. Could not open " << filename << std::endl;
+      return false;
+    }
+    file.close();
+
+    YAML::Node config = YAML::LoadFile(filename);
+    if (!config["collision_proxies"]){
+      std::cerr << "[collision_proxies] Error. " << filename << " has no collision_proxies key" << std::endl;
+      return false;
+    }
+
+    proxies.clear();
+    CollisionCapsule capsule;
+    for(YAML::const_iterator it = config["collision_proxies"].begin(); it != config["collision_proxies"].end(); ++it){
+      std::vector<CollisionCapsule> & capsules = proxies[it->first.as<std::string>()];
+      for(int i = 0; i < it->second.size(); i++){
+        capsule.a = read_position(it->second[i]["a"]);
+        capsule.b = read_position(it->second[i]["b"]);
+        capsule.radius = it->second[i]["radius"].as<double>();
+        capsules.push_back(capsule);
+      }
+    }
+    return true;
+  }
+
+}
@@ -0,0 +1,252 @@
+#include <avatar_locomanipulation/collision_environment/signed_distance_field.hpp>
+#include <avatar_locomanipulation/collision_environment/fcl_mesh_vertices.hpp>
+#include "hpp/fcl/distance.h"
+#include "hpp/fcl/shape/geometric_shapes.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace{
+  const char sdf_file_magic[8] = {'A', 'L', 'M', 'S', 'D', 'F', '0', '1'};
+
+  // FNV-1a
+  void hash_bytes(uint64_t & hash, const void * data, size_t size){
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    for(size_t i = 0; i < size; i++){
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  void hash_double(uint64_t & hash, double value){
+    hash_bytes(hash, &value, sizeof(double));
+  }
+}
+
+SignedDistanceField::SignedDistanceField(): origin(Eigen::Vector3d::Zero()){
+}
+
+SignedDistanceField::~SignedDistanceField(){
+}
+
+void SignedDistanceField::build(const std::function<double(const Eigen::Vector3d &)> & distance_function,
+                                const Eigen::Vector3d & aabb_min, const Eigen::Vector3d & aabb_max, double resolution_in, double padding_in){
+  resolution = resolution_in;
+  origin = aabb_min - Eigen::Vector3d::Constant(padding_in);
+  Eigen::Vector3d extent = (aabb_max - aabb_min) + Eigen::Vector3d::Constant(2.0*padding_in);
+  for(int a = 0; a < 3; a++){
+    dims[a] = std::max(2, static_cast<int>(std::ceil(extent[a]/resolution)) + 1);
+  }
+
+  values.resize(dims[0]*dims[1]*dims[2]);
+  Eigen::Vector3d p;
+  for(int k = 0; k < dims[2]; k++){
+    for(int j = 0; j < dims[1]; j++){
+      for(int i = 0; i < dims[0]; i++){
+        p = origin + resolution*Eigen::Vector3d(i, j, k);
+        values[i + dims[0]*(j + dims[1]*k)] = static_cast<float>(distance_function(p));
+      }
+    }
+  }
+}
+
+bool SignedDistanceField::buildFromGeometry(const pinocchio::fcl::CollisionGeometry & geometry, double resolution_in, double padding_in, const std::string & cache_directory){
+  uint64_t key_in = computeGeometryKey(geometry, resolution_in, padding_in);
+
+  char key_string[17];
+  std::snprintf(key_string, sizeof(key_string), "%016llx", static_cast<unsigned long long>(key_in));
+  std::string directory = cache_directory;
+  if (!directory.empty() && (directory[directory.size() - 1] != '/')){
+    directory += "/";
+  }
+  std::string filename = directory + "sdf_" + std::string(key_string) + ".bin";
+
+  if (!cache_directory.empty() && load(filename, key_in)){
+    return true;
+  }
+
+  // Distance to a point, sampled with a small sphere
+  const double point_radius = 1e-4;
+  pinocchio::fcl::Sphere point_sphere(point_radius);
+  pinocchio::fcl::Transform3f tf_geometry;
+  pinocchio::fcl::Transform3f tf_point;
+  pinocchio::fcl::DistanceRequest request;
+  pinocchio::fcl::DistanceResult result;
+
+  std::function<double(const Eigen::Vector3d &)> distance_function = [&](const Eigen::Vector3d & p){
+    tf_point.setTranslation(p);
+    result.clear();
+    pinocchio::fcl::distance(&geometry, tf_geometry, &point_sphere, tf_point, request, result);
+    return result.min_distance + point_radius;
+  };
+
+  build(distance_function, geometry.aabb_local.min_, geometry.aabb_local.max_, resolution_in, padding_in);
+  key = key_in;
+
+  if (!cache_directory.empty()){
+    mkdir(directory.c_str(), 0755);
+    if (!save(filename)){
+      std::cerr << "[SignedDistanceField] Error. Could not save the field to " << filename << std::endl;
+    }
+  }
+  return false;
+}
+
+uint64_t SignedDistanceField::computeGeometryKey(const pinocchio::fcl::CollisionGeometry & geometry, double resolution_in, double padding_in){
+  uint64_t hash = 14695981039346656037ULL;
+  int object_type = geometry.getObjectType();
+  int node_type = geometry.getNodeType();
+  hash_bytes(hash, &object_type, sizeof(int));
+  hash_bytes(hash, &node_type, sizeof(int));
+  for(int a = 0; a < 3; a++){
+    hash_double(hash, geometry.aabb_local.min_[a]);
+    hash_double(hash, geometry.aabb_local.max_[a]);
+  }
+
+  // Mesh content
+  const pinocchio::fcl::BVHModelBase * mesh = dynamic_cast<const pinocchio::fcl::BVHModelBase *>(&geometry);
+  if (mesh != nullptr){
+    hash_bytes(hash, &mesh->num_vertices, sizeof(mesh->num_vertices));
+    hash_bytes(hash, &mesh->num_tris, sizeof(mesh->num_tris));
+    Eigen::Vector3d vertex;
+    for(int i = 0; i < mesh->num_vertices; i++){
+      vertex = fcl_mesh::get_vertex(*mesh, i);
+      for(int a = 0; a < 3; a++){
+        hash_double(hash, vertex[a]);
+      }
+    }
+  }
+
+  hash_double(hash, resolution_in);
+  hash_double(hash, padding_in);
+  return hash;
+}
+
+bool SignedDistanceField::save(const std::string & filename){
+  std::ofstream file(filename.c_str(), std::ios::binary);
+  if (!file.is_open()){
+    return false;
+  }
+  file.write(sdf_file_magic, sizeof(sdf_file_magic));
+  file.write(reinterpret_cast<const char *>(&key), sizeof(key));
+  file.write(reinterpret_cast<const char *>(origin.data()), 3*sizeof(double));
+  file.write(reinterpret_cast<const char *>(&resolution), sizeof(double));
+  file.write(reinterpret_cast<const char *>(dims), 3*sizeof(int));
+  file.write(reinterpret_cast<const char *>(values.data()), values.size()*sizeof(float));
+  return file.good();
+}
+
+bool SignedDistanceField::load(const std::string & filename, uint64_t key_in){
+  std::ifstream file(filename.c_str(), std::ios::binary);
+  if (!file.is_open()){
+    return false;
+  }
+
+  char magic[8];
+  uint64_t file_key;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&file_key), sizeof(file_key));
+  if (!file.good() || !std::equal(magic, magic + 8, sdf_file_magic) || (file_key != key_in)){
+    return false;
+  }
+
+  Eigen::Vector3d file_origin;
+  double file_resolution;
+  int file_dims[3];
+  file.read(reinterpret_cast<char *>(file_origin.data()), 3*sizeof(double));
+  file.read(reinterpret_cast<char *>(&file_resolution), sizeof(double));
+  file.read(reinterpret_cast<char *>(file_dims), 3*sizeof(int));
+  if (!file.good() || (file_dims[0] < 2) || (file_dims[1] < 2) || (file_dims[2] < 2)){
+    return false;
+  }
+
+  std::vector<float> file_values(file_dims[0]*file_dims[1]*file_dims[2]);
+  file.read(reinterpret_cast<char *>(file_values.data()), file_values.size()*sizeof(float));
+  if (!file.good()){
+    return false;
+  }
+
+  key = file_key;
+  origin = file_origin;
+  resolution = file_resolution;
+  for(int a = 0; a < 3; a++){
+    dims[a] = file_dims[a];
+  }
+  values.swap(file_values);
+  return true;
+}
+
+double SignedDistanceField::getValue(int i, int j, int k){
+  return values[i + dims[0]*(j + dims[1]*k)];
+}
+
+double SignedDistanceField::getDistance(const Eigen::Vector3d & p_local){
+  Eigen::Vector3d gradient;
+  return getDistanceAndGradient(p_local, gradient);
+}
+
+double SignedDistanceField::getDistanceAndGradient(const Eigen::Vector3d & p_local, Eigen::Vector3d & gradient){
+  // Continuous voxel coordinates, clamped to the grid
+  Eigen::Vector3d g = (p_local - origin)/resolution;
+  Eigen::Vector3d g_clamped;
+  int idx[3];
+  double t[3];
+  for(int a = 0; a < 3; a++){
+    g_clamped[a] = std::min(std::max(g[a], 0.0), static_cast<double>(dims[a] - 1));
+    idx[a] = std::min(static_cast<int>(std::floor(g_clamped[a])), dims[a] - 2);
+    t[a] = g_clamped[a] - idx[a];
+  }
+
+  double c000 = getValue(idx[0],     idx[1],     idx[2]);
+  double c100 = getValue(idx[0] + 1, idx[1],     idx[2]);
+  double c010 = getValue(idx[0],     idx[1] + 1, idx[2]);
+  double c110 = getValue(idx[0] + 1, idx[1] + 1, idx[2]);
+  double c001 = getValue(idx[0],     idx[1],     idx[2] + 1);
+  double c101 = getValue(idx[0] + 1, idx[1],     idx[2] + 1);
+  double c011 = getValue(idx[0],     idx[1] + 1, idx[2] + 1);
+  double c111 = getValue(idx[0] + 1, idx[1] + 1, idx[2] + 1);
+
+  // Interpolate along x, then y, then z
+  double c00 = c000 + t[0]*(c100 - c000);
+  double c10 = c010 + t[0]*(c110 - c010);
+  double c01 = c001 + t[0]*(c101 - c001);
+  double c11 = c011 + t[0]*(c111 - c011);
+  double c0 = c00 + t[1]*(c10 - c00);
+  double c1 = c01 + t[1]*(c11 - c01);
+  double distance = c0 + t[2]*(c1 - c0);
+
+  // Analytic gradient of the trilinear interpolation
+  double dx0 = (c100 - c000) + t[1]*((c110 - c010) - (c100 - c000));
+  double dx1 = (c101 - c001) + t[1]*((c111 - c011) - (c101 - c001));
+  gradient[0] = (dx0 + t[2]*(dx1 - dx0))/resolution;
+  gradient[1] = ((c10 - c00) + t[2]*((c11 - c01) - (c10 - c00)))/resolution;
+  gradient[2] = (c1 - c0)/resolution;
+
+  // Outside the grid: add the distance to the grid and point away from it
+  Eigen::Vector3d outside = (g - g_clamped)*resolution;
+  double outside_distance = outside.norm();
+  if (outside_distance > 0.0){
+    distance += outside_distance;
+    gradient = outside/outside_distance;
+  }
+  return distance;
+}
+
+bool SignedDistanceField::isBuilt(){
+  return !values.empty();
+}
+
+uint64_t SignedDistanceField::getKey(){
+  return key;
+}
+
+double SignedDistanceField::getResolution(){
+  return resolution;
+}
+
+int SignedDistanceField::getNumVoxels(){
+  return values.size();
+}
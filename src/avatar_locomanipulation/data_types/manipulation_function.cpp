@@ -63,6 +63,22 @@ void ManipulationFunction::setManipulationType(int type){
 	manipulation_type = type;
 }
 
+std::shared_ptr<ManipulationFunction> ManipulationFunction::clone(){
+	std::shared_ptr<ManipulationFunction> f_copy(new ManipulationFunction());
+	if (rh_waypoint_list_yaml_filename.size() > 0){
+		f_copy->setRightWaypointsFromYaml(rh_waypoint_list_yaml_filename);
+	}
+	if (lh_waypoint_list_yaml_filename.size() > 0){
+		f_copy->setLeftWaypointsFromYaml(lh_waypoint_list_yaml_filename);
+	}
+	f_copy->manipulation_type = manipulation_type;
+	f_copy->right_hand_waypoints_set = right_hand_waypoints_set;
+	f_copy->left_hand_waypoints_set = left_hand_waypoints_set;
+	f_copy->transform_translation = transform_translation;
+	f_copy->transform_orientation = transform_orientation;
+	return f_copy;
+}
+
 void ManipulationFunction::common_initialization(){
 	manipulation_type = MANIPULATE_TYPE_RIGHT_HAND;
 	right_hand_waypoints_set = false;
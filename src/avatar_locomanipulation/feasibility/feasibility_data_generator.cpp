@@ -145,6 +145,12 @@ void FeasibilityDataGenerator::loadParamFile(const std::string filepath){
   // Set the resolution
   param_handler.getInteger("N_resolution", N_resolution);
 
+  // Set the number of threads used to solve the starting configuration IKs
+  int loaded_num_threads;
+  if (param_handler.getInteger("num_threads", loaded_num_threads)){
+    setNumThreads(loaded_num_threads);
+  }
+
   // set the parent folder path
   param_handler.getString("parent_folder_path", parent_folder_path);
   
@@ -213,6 +219,41 @@ void FeasibilityDataGenerator::initializeStartingIKTasks(){
 	ik_start_config_module->addTasktoHierarchy(ik_task_stack);
 	// Prepare the ik module data structure
 	ik_start_config_module->prepareNewIKDataStrcutures();
+
+  createStartConfigWorkers();
+}
+
+void FeasibilityDataGenerator::setNumThreads(int num_threads_in){
+  num_threads = std::max(num_threads_in, 1);
+  // The workers are created once the robot model is set
+  if (ik_start_config_module != nullptr){
+    createStartConfigWorkers();
+  }
+}
+
+void FeasibilityDataGenerator::createStartConfigWorkers(){
+  start_config_solver.clearWorkers();
+  ik_start_config_worker_modules.clear();
+  start_config_solver.addWorker(robot_model, ik_start_config_module, vec_task_stack);
+
+  // Each worker has the same task stack on its own model data
+  for(int i = 1; i < num_threads; i++){
+    std::shared_ptr<RobotModel> worker_model(new RobotModelContext(robot_model));
+    std::shared_ptr<Task> worker_upper_body_config_task(new TaskJointConfig(worker_model, upper_body_joint_names));
+    std::shared_ptr<Task> worker_left_foot_task(new Task6DPose(worker_model, "leftCOP_Frame"));
+    std::shared_ptr<Task> worker_right_foot_task(new Task6DPose(worker_model, "rightCOP_Frame"));
+    std::shared_ptr<Task> worker_pelvis_task(new Task6DPose(worker_model, "pelvis"));
+    std::vector< std::shared_ptr<Task> > worker_tasks = {worker_upper_body_config_task, worker_left_foot_task, worker_right_foot_task, worker_pelvis_task};
+    std::shared_ptr<Task> worker_task_stack(new TaskStack(worker_model, worker_tasks));
+
+    std::shared_ptr<IKModule> worker_module(new IKModule(worker_model));
+    worker_module->addTasktoHierarchy(worker_task_stack);
+    worker_module->prepareNewIKDataStrcutures();
+    worker_module->setParameters(ik_start_config_module->getParameters());
+
+    start_config_solver.addWorker(worker_model, worker_module, worker_tasks);
+    ik_start_config_worker_modules.push_back(worker_module);
+  }
 }
 
 void FeasibilityDataGenerator::initializeConfigurationLimits(){
@@ -261,7 +302,7 @@ double FeasibilityDataGenerator::generateRandMinMax(const double min, const doub
   return (static_cast<double>(rand()) / static_cast<double>(RAND_MAX)) *(max-min) + min;
  }
 
-bool FeasibilityDataGenerator::randomizeStartingConfiguration(){
+bool FeasibilityDataGenerator::sampleStartingConfigCandidate(StartingConfigCandidate & candidate){
   // Set stance foot to be the origin
   stance_foot_pos.setZero();
   stance_foot_ori.setIdentity();
@@ -319,6 +360,17 @@ bool FeasibilityDataGenerator::randomizeStartingConfiguration(){
   // Set the starting configuration for the upper body joints:
   setStartingIKConfig(q_ik_start);
 
+  // Store the candidate
+  candidate.left_footstep = left_footstep;
+  candidate.right_footstep = right_footstep;
+  candidate.swing_foot_pos = swing_foot_pos;
+  candidate.swing_foot_ori = swing_foot_ori;
+  candidate.swing_foot_theta_angle = swing_foot_theta_angle;
+  candidate.pelvis_pos = pelvis_pos;
+  candidate.pelvis_ori = pelvis_ori;
+  candidate.joint_pos = joint_pos;
+  candidate.q_ik_start = q_ik_start;
+
   // Before running the IK, first check if the hands are in front of the pelvis
   robot_model->updateFullKinematics(q_ik_start);
 
@@ -336,41 +388,73 @@ bool FeasibilityDataGenerator::randomizeStartingConfiguration(){
 
   // ensure that the x position of the hands in the pelvis frame is greater than 0
   bool hands_in_front_of_pelvis = ((rhand_pos_pelvis_frame[0] >= 0) && (lhand_pos_pelvis_frame[0] >= 0));
-  if (!hands_in_front_of_pelvis) {
-    return false;    
-  }
+  return hands_in_front_of_pelvis;
+}
+
+void FeasibilityDataGenerator::setStartingConfigCandidate(const StartingConfigCandidate & candidate){
+  left_footstep = candidate.left_footstep;
+  right_footstep = candidate.right_footstep;
+  swing_foot_pos = candidate.swing_foot_pos;
+  swing_foot_ori = candidate.swing_foot_ori;
+  swing_foot_theta_angle = candidate.swing_foot_theta_angle;
+  pelvis_pos = candidate.pelvis_pos;
+  pelvis_ori = candidate.pelvis_ori;
+  joint_pos = candidate.joint_pos;
+  setStartingIKConfig(candidate.q_ik_start);
 
   // Set IK references
   upper_body_config_task->setReference(joint_pos);
   left_foot_task->setReference(left_footstep.position, left_footstep.orientation);
   right_foot_task->setReference(right_footstep.position, right_footstep.orientation);
   pelvis_task->setReference(pelvis_pos, pelvis_ori);
+}
 
-  // Prepare IK output
-  int solve_result;
-  double total_error_norm;
-  std::vector<double> task_error_norms;
-  Eigen::VectorXd q_sol = Eigen::VectorXd::Zero(robot_model->getDimQdot()); 
-  int ik_verbosity_level = IK_VERBOSITY_LOW;
-  bool config_convergence = false;
+bool FeasibilityDataGenerator::randomizeStartingConfiguration(){
+  // Sample one candidate per worker. Candidates with the hands behind the pelvis are rejected before the IK.
+  int num_candidates = std::max(start_config_solver.getNumWorkers(), 1);
+  start_config_candidates.resize(num_candidates);
+  start_config_job_candidates.clear();
+  start_config_jobs.clear();
+  for(int i = 0; i < num_candidates; i++){
+    if (!sampleStartingConfigCandidate(start_config_candidates[i])){
+      continue;
+    }
+    // References in the order of vec_task_stack
+    BatchIKJob job(q_ik_start);
+    job.addReference(0, joint_pos);
+    job.addReference(1, left_footstep.position, left_footstep.orientation);
+    job.addReference(2, right_footstep.position, right_footstep.orientation);
+    job.addReference(3, pelvis_pos, pelvis_ori);
+    start_config_jobs.push_back(job);
+    start_config_job_candidates.push_back(i);
+  }
+  if (start_config_jobs.empty()){
+    return false;
+  }
 
   // Set Verbosity Level
+  int ik_verbosity_level = IK_VERBOSITY_LOW;
   ik_start_config_module->setVerbosityLevel(ik_verbosity_level);
-  // Solve IK
-  config_convergence = ik_start_config_module->solveIK(solve_result, task_error_norms, total_error_norm, q_sol);
-  // ik_start_config_module->printSolutionResults();
-
-  // Check if CoM height position is within limits
-  bool com_within_limits = ((com_height_min <= robot_model->x_com[2]) && (robot_model->x_com[2] <= com_height_max)); 
-  if (!com_within_limits){
-    return false;
+  for(int i = 0; i < ik_start_config_worker_modules.size(); i++){
+    ik_start_config_worker_modules[i]->setVerbosityLevel(ik_verbosity_level);
   }
-
-  // If we found a starting configuration set it to be the starting config.
-  if (config_convergence){
-    q_start = q_sol;
+  // Solve IK
+  start_config_solver.solve(start_config_jobs, start_config_results);
+
+  // Use the first candidate which converged with the CoM height within limits
+  for(int i = 0; i < start_config_results.size(); i++){
+    setStartingConfigCandidate(start_config_candidates[start_config_job_candidates[i]]);
+    robot_model->updateFullKinematics(start_config_results[i].q_sol);
+
+    // Check if CoM height position is within limits
+    bool com_within_limits = ((com_height_min <= robot_model->x_com[2]) && (robot_model->x_com[2] <= com_height_max)); 
+    // If we found a starting configuration set it to be the starting config.
+    if (start_config_results[i].convergence && com_within_limits){
+      q_start = start_config_results[i].q_sol;
+      return true;
+    }
   }
-  return (config_convergence);
+  return false;
 }
 
 void FeasibilityDataGenerator::getRandomPelvisLocation(Eigen::Vector3d & pelvis_out){
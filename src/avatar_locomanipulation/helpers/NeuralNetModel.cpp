@@ -1,13 +1,39 @@
 #include <avatar_locomanipulation/helpers/NeuralNetModel.hpp>
+#include <avatar_locomanipulation/helpers/FixedNeuralNet.hpp>
 #include <avatar_locomanipulation/helpers/IOUtilities.hpp>
 #include <cassert>
 #include <cmath>
 #include <random>
 
+// Applies the activation in place for double and float outputs
+template <typename MatrixType>
+static void ApplyActivation(ActivationFunction act_fn,
+                            Eigen::Ref<MatrixType> output) {
+    typedef typename MatrixType::Scalar Scalar;
+    switch (act_fn) {
+        case ActivationFunction::Tanh:
+            output.array() = output.array().tanh();
+            break;
+        case ActivationFunction::ReLU:
+            output = output.cwiseMax(Scalar(0));
+            break;
+        case ActivationFunction::Sigmoid:
+            output.array() = (Scalar(1) + (-output.array()).exp()).inverse();
+            break;
+        default:
+            break;
+    }
+}
+
 Layer::Layer(Eigen::MatrixXd weight, Eigen::MatrixXd bias,
              ActivationFunction act_fn) {
     weight_ = weight;
     bias_ = bias;
+    bias_row_ = bias.row(0);
+    weight_f_ = weight.cast<float>();
+    bias_row_f_ = bias_row_.cast<float>();
+    b_quantized_ = false;
+    input_scale_ = 1.f;
     num_input_ = weight.rows();
     num_output_ = weight.cols();
     act_fn_ = act_fn;
@@ -16,52 +42,56 @@ Layer::Layer(Eigen::MatrixXd weight, Eigen::MatrixXd bias,
 Layer::~Layer() {}
 
 Eigen::MatrixXd Layer::GetOutput(const Eigen::MatrixXd& input) {
-    int num_data(input.rows());
-    Eigen::MatrixXd aug_bias = Eigen::MatrixXd::Zero(num_data, num_output_);
-    for (int i = 0; i < num_data; ++i) {
-        aug_bias.block(i, 0, 1, num_output_) = bias_;
-    }
-    Eigen::MatrixXd ret = Eigen::MatrixXd::Zero(num_data, num_output_);
-    // std::cout << "weight: " << weight_ << std::endl;
-    // std::cout << "input: " << input.rows() << " " << input.cols() << std::endl;
-    // std::cout << "num_output: " << num_output_ << std::endl;
-    ret = input * weight_ + aug_bias;
-    switch (act_fn_) {
-        case ActivationFunction::None:
-            return ret;
-            break;
-        case ActivationFunction::Tanh:
-            for (int row(0); row < num_data; ++row) {
-                for (int col(0); col < num_output_; ++col) {
-                    ret(row, col) = std::tanh(ret(row, col));
-                }
-            }
-            return ret;
-            break;
-        case ActivationFunction::ReLU:
-            for (int row(0); row < num_data; ++row) {
-                for (int col(0); col < num_output_; ++col) {
-                    if (ret(row, col) < 0) {
-                        ret(row, col) = 0.;
-                    }
-                }
-            }
-            return ret;
-            break;
-        case ActivationFunction::Sigmoid:
-            for (int row(0); row < num_data; ++row) {
-                for (int col(0); col < num_output_; ++col) {
-                    ret(row, col) = 1/(std::exp(-1*ret(row,col))+1);
-                }
-            }
-            return ret;
-            break;
-        default:
-            break;
-    }
+    Eigen::MatrixXd ret(input.rows(), num_output_);
+    GetOutput(input, ret);
     return ret;
 }
 
+void Layer::GetOutput(const Eigen::Ref<const Eigen::MatrixXd>& input,
+                      Eigen::Ref<Eigen::MatrixXd> output) const {
+    output.noalias() = input * weight_;
+    output.rowwise() += bias_row_;
+    ApplyActivation<Eigen::MatrixXd>(act_fn_, output);
+}
+
+void Layer::GetOutput(const Eigen::Ref<const Eigen::MatrixXf>& input,
+                      Eigen::Ref<Eigen::MatrixXf> output) const {
+    output.noalias() = input * weight_f_;
+    output.rowwise() += bias_row_f_;
+    ApplyActivation<Eigen::MatrixXf>(act_fn_, output);
+}
+
+void Layer::Quantize(double input_range) {
+    input_scale_ = (input_range > 0.) ? static_cast<float>(input_range / 127.) : 1.f;
+    weight_q_.resize(num_input_, num_output_);
+    output_scale_.resize(num_output_);
+    for (int col = 0; col < num_output_; ++col) {
+        double w_max = weight_.col(col).cwiseAbs().maxCoeff();
+        double w_scale = (w_max > 0.) ? (w_max / 127.) : 1.;
+        for (int row = 0; row < num_input_; ++row) {
+            weight_q_(row, col) =
+                static_cast<int>(std::round(weight_(row, col) / w_scale));
+        }
+        output_scale_(col) = static_cast<float>(input_scale_ * w_scale);
+    }
+    b_quantized_ = true;
+}
+
+void Layer::GetOutputQuantized(const Eigen::Ref<const Eigen::MatrixXf>& input,
+                               Eigen::Ref<Eigen::MatrixXi> input_q,
+                               Eigen::Ref<Eigen::MatrixXi> acc,
+                               Eigen::Ref<Eigen::MatrixXf> output) const {
+    input_q.array() = (input.array() / input_scale_)
+                          .round()
+                          .max(-127.f)
+                          .min(127.f)
+                          .cast<int>();
+    acc.noalias() = input_q * weight_q_;
+    output.noalias() = acc.cast<float>() * output_scale_.asDiagonal();
+    output.rowwise() += bias_row_f_;
+    ApplyActivation<Eigen::MatrixXf>(act_fn_, output);
+}
+
 NeuralNetModel::NeuralNetModel(const myYAML::Node& node, bool b_stochastic) {
     int num_layer;
     Eigen::MatrixXd w, b;
@@ -147,6 +177,152 @@ Eigen::MatrixXd NeuralNetModel::GetOutput(const Eigen::MatrixXd& input) {
     return ret;
 }
 
+void NeuralNetModel::Infer(const Eigen::Ref<const Eigen::MatrixXd>& input,
+                           Eigen::Ref<Eigen::MatrixXd> output) {
+    assert(input.cols() == num_input_);
+    assert((output.rows() == input.rows()) && (output.cols() == num_output_));
+
+    if ((precision_ == DoublePrecision) && fixed_net_) {
+        fixed_net_->Infer(input, output);
+        return;
+    }
+
+    int num_data(input.rows());
+    ReserveWorkspaces_(num_data);
+
+    if (precision_ == DoublePrecision) {
+        if (num_layer_ == 1) {
+            layers_[0].GetOutput(input, output);
+            return;
+        }
+        layers_[0].GetOutput(input, workspaces_[0].topRows(num_data));
+        for (int i = 1; i < num_layer_ - 1; ++i) {
+            layers_[i].GetOutput(workspaces_[i - 1].topRows(num_data),
+                                 workspaces_[i].topRows(num_data));
+        }
+        layers_[num_layer_ - 1].GetOutput(
+            workspaces_[num_layer_ - 2].topRows(num_data), output);
+        return;
+    }
+
+    // Single precision and int8 layers pass float activations between them
+    input_f_.topRows(num_data) = input.cast<float>();
+    for (int i = 0; i < num_layer_; ++i) {
+        Eigen::Ref<const Eigen::MatrixXf> layer_input =
+            (i == 0) ? input_f_.topRows(num_data)
+                     : workspaces_f_[i - 1].topRows(num_data);
+        if (precision_ == Int8Quantized) {
+            layers_[i].GetOutputQuantized(layer_input,
+                                          workspaces_q_[i].topRows(num_data),
+                                          workspaces_acc_[i].topRows(num_data),
+                                          workspaces_f_[i].topRows(num_data));
+        } else {
+            layers_[i].GetOutput(layer_input,
+                                 workspaces_f_[i].topRows(num_data));
+        }
+    }
+    output = workspaces_f_[num_layer_ - 1].topRows(num_data).cast<double>();
+}
+
+void NeuralNetModel::ReserveWorkspaces_(int num_data) {
+    // Grow the workspaces only when the batch is larger than any previous one
+    if (num_data <= workspace_rows_) {
+        return;
+    }
+    workspace_rows_ = num_data;
+    input_f_.resize(num_data, num_input_);
+    for (int i = 0; i < num_layer_; ++i) {
+        workspaces_[i].resize(num_data, layers_[i].GetNumOutput());
+        workspaces_f_[i].resize(num_data, layers_[i].GetNumOutput());
+        workspaces_q_[i].resize(num_data, layers_[i].GetNumInput());
+        workspaces_acc_[i].resize(num_data, layers_[i].GetNumOutput());
+    }
+}
+
+bool NeuralNetModel::SetFixedNetwork(
+    std::shared_ptr<FixedNeuralNetBase> fixed_net) {
+    if (!fixed_net) {
+        std::cout << "[NeuralNetModel] No fixed-topology network given. Using "
+                     "the dynamic forward pass."
+                  << std::endl;
+        fixed_net_.reset();
+        return false;
+    }
+    if ((fixed_net->GetNumInput() != num_input_) ||
+        (fixed_net->GetNumOutput() != num_output_)) {
+        std::cout << "[[Error]] Fixed-topology network is ("
+                  << fixed_net->GetNumInput() << ", "
+                  << fixed_net->GetNumOutput() << ") but the model is ("
+                  << num_input_ << ", " << num_output_
+                  << "). Using the dynamic forward pass." << std::endl;
+        fixed_net_.reset();
+        return false;
+    }
+    fixed_net_ = fixed_net;
+    return true;
+}
+
+void NeuralNetModel::SetInferencePrecision(InferencePrecision precision) {
+    if ((precision == Int8Quantized) && (!b_calibrated_)) {
+        std::cout << "[[Error]] Int8 inference requires Calibrate() to be "
+                     "called first. Keeping the current precision."
+                  << std::endl;
+        return;
+    }
+    precision_ = precision;
+}
+
+void NeuralNetModel::Calibrate(
+    const Eigen::Ref<const Eigen::MatrixXd>& calibration_input) {
+    // Track the largest magnitude seen at the input of every layer
+    Eigen::MatrixXd layer_input = calibration_input;
+    for (int i = 0; i < num_layer_; ++i) {
+        layers_[i].Quantize(layer_input.cwiseAbs().maxCoeff());
+        layer_input = layers_[i].GetOutput(layer_input);
+    }
+    b_calibrated_ = true;
+    std::cout << "[NeuralNetModel] Calibrated int8 quantization over "
+              << calibration_input.rows() << " data" << std::endl;
+}
+
+void NeuralNetModel::ReportPrecisionDrift(
+    const Eigen::Ref<const Eigen::MatrixXd>& input, double threshold) {
+    InferencePrecision previous_precision = precision_;
+    int num_data(input.rows());
+    Eigen::MatrixXd ref_output(num_data, num_output_);
+    Eigen::MatrixXd output(num_data, num_output_);
+
+    precision_ = DoublePrecision;
+    Infer(input, ref_output);
+
+    std::vector<InferencePrecision> modes = {SinglePrecision};
+    if (b_calibrated_) {
+        modes.push_back(Int8Quantized);
+    }
+    for (int m = 0; m < modes.size(); ++m) {
+        precision_ = modes[m];
+        Infer(input, output);
+        Eigen::MatrixXd abs_error = (output - ref_output).cwiseAbs();
+        int num_flipped = 0;
+        for (int row = 0; row < num_data; ++row) {
+            for (int col = 0; col < num_output_; ++col) {
+                if ((output(row, col) >= threshold) !=
+                    (ref_output(row, col) >= threshold)) {
+                    num_flipped++;
+                }
+            }
+        }
+        std::cout << "[NeuralNetModel] "
+                  << (modes[m] == SinglePrecision ? "float32" : "int8")
+                  << " drift over " << num_data << " data:" << std::endl;
+        std::cout << "  max abs error = " << abs_error.maxCoeff() << std::endl;
+        std::cout << "  mean abs error = " << abs_error.mean() << std::endl;
+        std::cout << "  decisions changed at " << threshold << " = "
+                  << num_flipped << "/" << abs_error.size() << std::endl;
+    }
+    precision_ = previous_precision;
+}
+
 void NeuralNetModel::GetOutput(const Eigen::MatrixXd& _input,
                                const Eigen::VectorXd& _lb,
                                const Eigen::VectorXd& _ub,
@@ -209,6 +385,14 @@ void NeuralNetModel::Initialize_(std::vector<Layer> layers, bool b_stoch,
     num_input_ = layers[0].GetNumInput();
     num_output_ = layers.back().GetNumOutput();
     b_stochastic_ = b_stoch;
+    precision_ = DoublePrecision;
+    b_calibrated_ = false;
+    // Layer outputs used by Infer(). Sized on the first query.
+    workspaces_.resize(num_layer_);
+    workspaces_f_.resize(num_layer_);
+    workspaces_q_.resize(num_layer_);
+    workspaces_acc_.resize(num_layer_);
+    workspace_rows_ = 0;
     if (b_stochastic_) {
         logstd_ = logstd;
         std_ = logstd;
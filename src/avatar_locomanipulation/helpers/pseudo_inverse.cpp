@@ -1,6 +1,8 @@
 // Code stripped from
 // https://github.com/stack-of-tasks/tsid/blob/master/src/math/utils.cpp
 #include <avatar_locomanipulation/helpers/pseudo_inverse.hpp>
+#include <iostream>
+#include <chrono>
 
 namespace math_utils{ 
   void pseudoInverse(const Eigen::MatrixXd & A,
@@ -80,4 +82,147 @@ namespace math_utils{
   }
 
 
-}
\ No newline at end of file
+
+  // PseudoInverseSolver Implementation ------------------------------
+  PseudoInverseSolver::PseudoInverseSolver(){
+    method = PINV_JACOBI_SVD;
+    damping = 1e-2;
+    resetStats();
+  }
+
+  PseudoInverseSolver::PseudoInverseSolver(int method_in){
+    method = PINV_JACOBI_SVD;
+    damping = 1e-2;
+    setMethod(method_in);
+    resetStats();
+  }
+
+  PseudoInverseSolver::~PseudoInverseSolver(){
+  }
+
+  void PseudoInverseSolver::setMethod(int method_in){
+    if ((method_in < PINV_JACOBI_SVD) || (method_in > PINV_BDCSVD)){
+      std::cerr << "[PseudoInverseSolver] Error. Unknown method " << method_in << ". Keeping " << getMethodName() << std::endl;
+      return;
+    }
+    method = method_in;
+  }
+
+  int PseudoInverseSolver::getMethod() const{
+    return method;
+  }
+
+  void PseudoInverseSolver::setDamping(double damping_in){
+    damping = damping_in;
+  }
+
+  void PseudoInverseSolver::compute(const Eigen::MatrixXd & J, Eigen::MatrixXd & Jinv, double tolerance){
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+
+    WJt = J.transpose();
+    lambda.resize(J.rows(), J.rows());
+    lambda.noalias() = J*WJt;
+    solveLambda(Jinv, tolerance);
+
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+    total_time += std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+    num_calls++;
+  }
+
+  void PseudoInverseSolver::compute(const Eigen::MatrixXd & J, const Eigen::MatrixXd & Winv, Eigen::MatrixXd & Jinv, double tolerance){
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+
+    WJt.resize(Winv.rows(), J.rows());
+    WJt.noalias() = Winv*J.transpose();
+    lambda.resize(J.rows(), J.rows());
+    lambda.noalias() = J*WJt;
+    solveLambda(Jinv, tolerance);
+
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+    total_time += std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+    num_calls++;
+  }
+
+  void PseudoInverseSolver::solveLambda(Eigen::MatrixXd & Jinv, double tolerance){
+    int m = lambda.rows();
+    Jinv.resize(WJt.rows(), m);
+
+    if (method == PINV_DAMPED_LEAST_SQUARES){
+      // Jinv = WJt*(lambda + damping^2*I)^-1. lambda is symmetric so Jinv^T = (lambda + damping^2*I)^-1 * WJt^T
+      lambda.diagonal().array() += damping*damping;
+      ldlt.compute(lambda);
+      Jinv_t = WJt.transpose();
+      ldlt.solveInPlace(Jinv_t);
+      Jinv = Jinv_t.transpose();
+      return;
+    }
+
+    if (method == PINV_COD){
+      // The minimum norm solution of lambda*X = WJt^T is lambda^+ * WJt^T
+      // Pivots below tolerance relative to the largest diagonal of lambda are treated as 0
+      double max_diag = lambda.diagonal().cwiseAbs().maxCoeff();
+      if (max_diag > 0.0){
+        cod.setThreshold(tolerance / max_diag);
+      }else{
+        cod.setThreshold(Eigen::Default);
+      }
+      cod.compute(lambda);
+      Jinv_t.resize(m, WJt.rows());
+      Jinv_t.noalias() = cod.solve(WJt.transpose());
+      Jinv = Jinv_t.transpose();
+      return;
+    }
+
+    // SVD backends. Singular values below the tolerance are set to 0
+    if (method == PINV_BDCSVD){
+      bdc_svd.compute(lambda, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      singular_values_inv = bdc_svd.singularValues();
+    }else{
+      jacobi_svd.compute(lambda, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      singular_values_inv = jacobi_svd.singularValues();
+    }
+    for (long int idx = 0; idx < singular_values_inv.size(); idx++) {
+      if (tolerance > 0 && singular_values_inv(idx) > tolerance) {
+        singular_values_inv(idx) = 1.0 / singular_values_inv(idx);
+      } else {
+        singular_values_inv(idx) = 0.0;
+      }
+    }
+    lambda_inv.resize(m, m);
+    if (method == PINV_BDCSVD){
+      lambda_inv.noalias() = bdc_svd.matrixV() * singular_values_inv.asDiagonal() * bdc_svd.matrixU().adjoint();
+    }else{
+      lambda_inv.noalias() = jacobi_svd.matrixV() * singular_values_inv.asDiagonal() * jacobi_svd.matrixU().adjoint();
+    }
+    Jinv.noalias() = WJt * lambda_inv;
+  }
+
+  int PseudoInverseSolver::getNumCalls() const{
+    return num_calls;
+  }
+
+  double PseudoInverseSolver::getTotalTime() const{
+    return total_time;
+  }
+
+  double PseudoInverseSolver::getAverageTime() const{
+    return (num_calls > 0) ? (total_time / static_cast<double>(num_calls)) : 0.0;
+  }
+
+  void PseudoInverseSolver::resetStats(){
+    num_calls = 0;
+    total_time = 0.0;
+  }
+
+  std::string PseudoInverseSolver::getMethodName() const{
+    if (method == PINV_DAMPED_LEAST_SQUARES){
+      return "damped least squares";
+    }else if (method == PINV_COD){
+      return "COD";
+    }else if (method == PINV_BDCSVD){
+      return "BDCSVD";
+    }
+    return "JacobiSVD";
+  }
+
+}
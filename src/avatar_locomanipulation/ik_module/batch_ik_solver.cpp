@@ -0,0 +1,326 @@
+#include <avatar_locomanipulation/ik_module/batch_ik_solver.hpp>
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <random>
+
+// BatchIKTaskReference
+BatchIKTaskReference::BatchIKTaskReference(){
+  quat_ref.setIdentity();
+}
+
+BatchIKTaskReference::BatchIKTaskReference(int task_idx_in, const Eigen::VectorXd & vec_ref_in){
+  task_idx = task_idx_in;
+  use_vec_ref = true;
+  vec_ref = vec_ref_in;
+  quat_ref.setIdentity();
+}
+
+BatchIKTaskReference::BatchIKTaskReference(int task_idx_in, const Eigen::Quaterniond & quat_ref_in){
+  task_idx = task_idx_in;
+  use_quat_ref = true;
+  quat_ref = quat_ref_in;
+}
+
+BatchIKTaskReference::BatchIKTaskReference(int task_idx_in, const Eigen::VectorXd & vec_ref_in, const Eigen::Quaterniond & quat_ref_in){
+  task_idx = task_idx_in;
+  use_vec_ref = true;
+  use_quat_ref = true;
+  vec_ref = vec_ref_in;
+  quat_ref = quat_ref_in;
+}
+
+BatchIKTaskReference::~BatchIKTaskReference(){}
+
+// BatchIKJob
+BatchIKJob::BatchIKJob(){}
+
+BatchIKJob::BatchIKJob(const Eigen::VectorXd & q_seed_in){
+  q_seed = q_seed_in;
+}
+
+BatchIKJob::~BatchIKJob(){}
+
+void BatchIKJob::addReference(int task_idx, const Eigen::VectorXd & vec_ref_in){
+  references.push_back(BatchIKTaskReference(task_idx, vec_ref_in));
+}
+
+void BatchIKJob::addReference(int task_idx, const Eigen::Quaterniond & quat_ref_in){
+  references.push_back(BatchIKTaskReference(task_idx, quat_ref_in));
+}
+
+void BatchIKJob::addReference(int task_idx, const Eigen::VectorXd & vec_ref_in, const Eigen::Quaterniond & quat_ref_in){
+  references.push_back(BatchIKTaskReference(task_idx, vec_ref_in, quat_ref_in));
+}
+
+// BatchIKResult
+BatchIKResult::BatchIKResult(){}
+BatchIKResult::~BatchIKResult(){}
+
+// BatchIKWorker
+BatchIKWorker::BatchIKWorker(){}
+
+BatchIKWorker::BatchIKWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<IKModule> ik_module_in, const std::vector< std::shared_ptr<Task> > & reference_tasks_in){
+  robot_model = robot_model_in;
+  ik_module = ik_module_in;
+  reference_tasks = reference_tasks_in;
+}
+
+BatchIKWorker::~BatchIKWorker(){}
+
+// BatchIKSolver
+BatchIKSolver::BatchIKSolver(){}
+
+BatchIKSolver::~BatchIKSolver(){}
+
+void BatchIKSolver::addWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<IKModule> ik_module_in, const std::vector< std::shared_ptr<Task> > & reference_tasks_in){
+  if (!workers.empty() && (reference_tasks_in.size() != workers[0].reference_tasks.size())){
+    std::cerr << "[BatchIKSolver] Error. Worker has " << reference_tasks_in.size() << " reference tasks but the other workers have "
+              << workers[0].reference_tasks.size() << ". Worker not added" << std::endl;
+    return;
+  }
+  for(int i = 0; i < reference_tasks_in.size(); i++){
+    if (reference_tasks_in[i]->robot_model != robot_model_in){
+      std::cout << "[BatchIKSolver] Warning. Reference task " << reference_tasks_in[i]->task_name << " is not bound to the robot model of its worker" << std::endl;
+    }
+  }
+  ik_module_in->setRobotModel(robot_model_in);
+  ik_module_in->prepareNewIKDataStrcutures();
+  workers.push_back(BatchIKWorker(robot_model_in, ik_module_in, reference_tasks_in));
+  std::cout << "[BatchIKSolver] Added worker " << workers.size() << std::endl;
+}
+
+void BatchIKSolver::clearWorkers(){
+  workers.clear();
+}
+
+int BatchIKSolver::getNumWorkers(){
+  return workers.size();
+}
+
+bool BatchIKSolver::checkJobs(const std::vector<BatchIKJob> & jobs){
+  if (workers.empty()){
+    std::cerr << "[BatchIKSolver] Error. No workers have been added" << std::endl;
+    return false;
+  }
+  int dim_q = workers[0].robot_model->getDimQ();
+  int num_reference_tasks = workers[0].reference_tasks.size();
+
+  // Signature of the references set by the first job. Every job must set exactly the same references.
+  std::vector<int> first_signature, signature;
+  for(int i = 0; i < jobs.size(); i++){
+    if (jobs[i].q_seed.size() != dim_q){
+      std::cerr << "[BatchIKSolver] Error. Job " << i << " has a seed of size " << jobs[i].q_seed.size() << " instead of " << dim_q << std::endl;
+      return false;
+    }
+    signature.clear();
+    for(int j = 0; j < jobs[i].references.size(); j++){
+      const BatchIKTaskReference & ref = jobs[i].references[j];
+      if ((ref.task_idx < 0) || (ref.task_idx >= num_reference_tasks)){
+        std::cerr << "[BatchIKSolver] Error. Job " << i << " references task " << ref.task_idx << " but the workers have " << num_reference_tasks << " reference tasks" << std::endl;
+        return false;
+      }
+      signature.push_back(4*ref.task_idx + (ref.use_vec_ref ? 1 : 0) + (ref.use_quat_ref ? 2 : 0));
+    }
+    std::sort(signature.begin(), signature.end());
+    if (i == 0){
+      first_signature = signature;
+    }else if (signature != first_signature){
+      std::cerr << "[BatchIKSolver] Error. Job " << i << " does not set the same task references as job 0" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void BatchIKSolver::setReferences(BatchIKWorker & worker, const BatchIKJob & job){
+  for(int i = 0; i < job.references.size(); i++){
+    const BatchIKTaskReference & ref = job.references[i];
+    std::shared_ptr<Task> & task = worker.reference_tasks[ref.task_idx];
+    if (ref.use_vec_ref && ref.use_quat_ref){
+      task->setReference(ref.vec_ref, ref.quat_ref);
+    }else if (ref.use_vec_ref){
+      task->setReference(ref.vec_ref);
+    }else if (ref.use_quat_ref){
+      task->setReference(ref.quat_ref);
+    }
+  }
+}
+
+int BatchIKSolver::solve(const std::vector<BatchIKJob> & jobs, std::vector<BatchIKResult> & results){
+  results.clear();
+  last_num_jobs = 0;
+  last_num_converged = 0;
+  last_batch_time = 0.0;
+  last_total_solve_time = 0.0;
+  last_total_iters = 0;
+  if (!checkJobs(jobs)){
+    return 0;
+  }
+  results.resize(jobs.size());
+  last_num_jobs = jobs.size();
+  if (jobs.empty()){
+    return 0;
+  }
+
+  std::chrono::high_resolution_clock::time_point t_batch_start = std::chrono::high_resolution_clock::now();
+
+  int num_workers = std::min((int) workers.size(), (int) jobs.size());
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(num_workers)
+  for(int i = 0; i < jobs.size(); i++){
+    int worker_idx = omp_get_thread_num();
+    BatchIKWorker & worker = workers[worker_idx];
+    BatchIKResult & result = results[i];
+
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+    setReferences(worker, jobs[i]);
+    worker.ik_module->setInitialConfig(jobs[i].q_seed);
+    result.convergence = worker.ik_module->solveIK(result.solve_result, result.task_error_norms, result.total_error_norm, result.q_sol);
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+    result.num_iters = worker.ik_module->getLastNumIterations();
+    result.num_minor_iters = worker.ik_module->getLastNumMinorIterations();
+    result.solve_time = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+    result.worker_idx = worker_idx;
+  }
+
+  std::chrono::high_resolution_clock::time_point t_batch_end = std::chrono::high_resolution_clock::now();
+  last_batch_time = std::chrono::duration_cast< std::chrono::duration<double> >(t_batch_end - t_batch_start).count();
+
+  // Accumulate the diagnostics in job order
+  for(int i = 0; i < results.size(); i++){
+    if (results[i].convergence){
+      last_num_converged++;
+    }
+    last_total_solve_time += results[i].solve_time;
+    last_total_iters += results[i].num_iters;
+  }
+  return last_num_converged;
+}
+
+bool BatchIKSolver::solveMultiStart(const BatchIKJob & job, const std::vector<Eigen::VectorXd> & seeds, BatchIKResult & result){
+  multi_start_results.clear();
+  result = BatchIKResult();
+  if (seeds.empty()){
+    std::cerr << "[BatchIKSolver] Error. No seeds given for the multi-start IK" << std::endl;
+    return false;
+  }
+  // The job is checked with each seed in place of its own
+  std::vector<BatchIKJob> seed_jobs(1, job);
+  for(int i = 0; i < seeds.size(); i++){
+    seed_jobs[0].q_seed = seeds[i];
+    if (!checkJobs(seed_jobs)){
+      return false;
+    }
+  }
+
+  multi_start_results.resize(seeds.size());
+  std::atomic<bool> cancel(false);
+  std::atomic<int> winning_seed(-1);
+
+  int num_workers = std::min((int) workers.size(), (int) seeds.size());
+  for(int i = 0; i < num_workers; i++){
+    workers[i].ik_module->setCancelFlag(&cancel);
+  }
+
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(num_workers)
+  for(int i = 0; i < seeds.size(); i++){
+    int worker_idx = omp_get_thread_num();
+    BatchIKWorker & worker = workers[worker_idx];
+    BatchIKResult & seed_result = multi_start_results[i];
+    seed_result.worker_idx = worker_idx;
+    seed_result.seed_idx = i;
+    if (cancel.load()){
+      // Another seed already converged
+      seed_result.solve_result = IK_CANCELLED;
+      seed_result.q_sol = seeds[i];
+      continue;
+    }
+
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+    setReferences(worker, job);
+    worker.ik_module->setInitialConfig(seeds[i]);
+    seed_result.convergence = worker.ik_module->solveIK(seed_result.solve_result, seed_result.task_error_norms, seed_result.total_error_norm, seed_result.q_sol);
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+    seed_result.num_iters = worker.ik_module->getLastNumIterations();
+    seed_result.num_minor_iters = worker.ik_module->getLastNumMinorIterations();
+    seed_result.solve_time = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+
+    if (seed_result.convergence){
+      int no_winner = -1;
+      if (winning_seed.compare_exchange_strong(no_winner, i)){
+        cancel.store(true);
+      }
+    }
+  }
+
+  for(int i = 0; i < num_workers; i++){
+    workers[i].ik_module->setCancelFlag(nullptr);
+  }
+
+  int best_seed = winning_seed.load();
+  if (best_seed < 0){
+    // No seed converged. Keep the smallest first task error
+    for(int i = 0; i < multi_start_results.size(); i++){
+      if (multi_start_results[i].task_error_norms.empty()){
+        continue;
+      }
+      if ((best_seed < 0) || (multi_start_results[i].task_error_norms[0] < multi_start_results[best_seed].task_error_norms[0])){
+        best_seed = i;
+      }
+    }
+  }
+  if (best_seed < 0){
+    return false;
+  }
+  result = multi_start_results[best_seed];
+  return result.convergence;
+}
+
+const std::vector<BatchIKResult> & BatchIKSolver::getLastMultiStartResults(){
+  return multi_start_results;
+}
+
+void BatchIKSolver::generateSeeds(std::shared_ptr<RobotModel> & robot_model_in, const Eigen::VectorXd & q_warm, const Eigen::VectorXd & q_nominal,
+                                  int num_seeds, double perturbation, unsigned int random_seed, std::vector<Eigen::VectorXd> & seeds){
+  seeds.clear();
+  if (num_seeds <= 0){
+    return;
+  }
+  seeds.push_back(q_warm);
+  if (num_seeds > 1){
+    seeds.push_back(q_nominal);
+  }
+
+  std::mt19937 generator(random_seed);
+  std::uniform_real_distribution<double> distribution(-perturbation, perturbation);
+  Eigen::VectorXd q_seed;
+  for(int i = 2; i < num_seeds; i++){
+    q_seed = q_warm;
+    for(int j = VAL_MODEL_NUM_FLOATING_JOINTS; j < q_seed.size(); j++){
+      q_seed[j] = std::min(std::max(q_seed[j] + distribution(generator), robot_model_in->q_lower_pos_limit[j]), robot_model_in->q_upper_pos_limit[j]);
+    }
+    seeds.push_back(q_seed);
+  }
+}
+
+double BatchIKSolver::getLastBatchTime(){
+  return last_batch_time;
+}
+
+int BatchIKSolver::getLastNumJobs(){
+  return last_num_jobs;
+}
+
+void BatchIKSolver::printLastBatchStats(){
+  std::cout << "[BatchIKSolver] " << last_num_converged << "/" << last_num_jobs << " jobs converged with " << workers.size() << " workers" << std::endl;
+  if (last_num_jobs == 0){
+    return;
+  }
+  std::cout << "    wall time: " << last_batch_time << " s, "
+            << (last_batch_time > 0.0 ? last_num_jobs / last_batch_time : 0.0) << " jobs/s" << std::endl;
+  std::cout << "    average solve time: " << last_total_solve_time / last_num_jobs << " s, "
+            << "average iterations: " << ((double) last_total_iters) / last_num_jobs << std::endl;
+}
@@ -1,4 +1,6 @@
 #include <avatar_locomanipulation/ik_module/ik_module.hpp>
+#include <algorithm>
+#include <cmath>
 
 // Constructor
 IKModule::IKModule(){
@@ -13,6 +15,7 @@ IKModule::~IKModule(){}
   
 void IKModule::setRobotModel(std::shared_ptr<RobotModel> & robot_model_in){
   robot_model = robot_model_in; 
+  invalidateInertiaCache();
 }
 
 void IKModule::setInitialConfig(const Eigen::VectorXd & q_init){
@@ -25,6 +28,7 @@ void IKModule::addTasktoHierarchy(std::shared_ptr<Task> & task_input){
 
 void IKModule::clearTaskHierarchy(){
   task_hierarchy.clear();  
+  task_pinv_methods_.clear();
 }
 
 
@@ -34,7 +38,8 @@ void IKModule::prepareNewIKDataStrcutures(){
   N_.clear();
   JN_.clear();
   JNpinv_.clear();
-  svd_list_.clear();
+  NaccJNpinv_.clear();
+  pinv_solvers_.clear();
   dx_.clear();
   dx_norms_.clear();
 
@@ -44,13 +49,19 @@ void IKModule::prepareNewIKDataStrcutures(){
   dq_tot = Eigen::VectorXd::Zero(robot_model->getDimQdot());
   I_ = Eigen::MatrixXd::Identity(robot_model->getDimQdot(), robot_model->getDimQdot());
   Ntmp_ = I_;
+  Nacc_ = I_;
 
   // Construct the Jacobian, Projected Jacobian, SVD, Projected Nullspace, and task errors structures
   for(int i = 0; i < task_hierarchy.size(); i++){
     J_.push_back(Eigen::MatrixXd::Zero(task_hierarchy[i]->task_dim, robot_model->getDimQdot()));   
     JN_.push_back(Eigen::MatrixXd::Zero(task_hierarchy[i]->task_dim, robot_model->getDimQdot()));  
     JNpinv_.push_back(Eigen::MatrixXd::Zero(robot_model->getDimQdot(), task_hierarchy[i]->task_dim)); 
-    svd_list_.push_back(Eigen::JacobiSVD<Eigen::MatrixXd>(task_hierarchy[i]->task_dim, robot_model->getDimQdot(), svdOptions) );
+    NaccJNpinv_.push_back(Eigen::MatrixXd::Zero(robot_model->getDimQdot(), task_hierarchy[i]->task_dim)); 
+    if (i >= task_pinv_methods_.size()){
+      task_pinv_methods_.push_back(pinv_method);
+    }
+    pinv_solvers_.push_back(math_utils::PseudoInverseSolver(task_pinv_methods_[i]));
+    pinv_solvers_[i].setDamping(pinv_damping);
     dx_.push_back(Eigen::VectorXd::Zero(robot_model->getDimQdot()));
     dx_norms_.push_back(0.0);
   }
@@ -101,6 +112,18 @@ void IKModule::setEnableInertiaWeighting(bool inertia_weighted_in){
   inertia_weighted_ = inertia_weighted_in;
 }
 
+void IKModule::setInertiaUpdateThreshold(double inertia_update_threshold_in){
+  inertia_update_threshold = inertia_update_threshold_in;
+}
+
+void IKModule::invalidateInertiaCache(){
+  inertia_cache_valid_ = false;
+}
+
+int IKModule::getNumInertiaUpdates(){
+  return num_inertia_updates_;
+}
+
 // if true: use dq in the order of task hierarchy and only include next tasks when higher priority tasks have converged
 // if false: uses the total_dq for all the tasks in the hierarchy.
 void IKModule::setSequentialDescent(bool sequential_descent_in){
@@ -121,6 +144,132 @@ void IKModule::setReturnWhenFirstTaskConverges(bool return_when_first_task_conve
   return_when_first_task_converges = return_when_first_task_converges_in;
 }
 
+// if true: carries the accumulated null space projector forward one priority level at a time
+// if false: rebuilds the product of null spaces for each priority level
+void IKModule::setIncrementalNullspace(bool incremental_nullspace_in){
+  incremental_nullspace = incremental_nullspace_in;
+}
+
+void IKModule::setKinematicsOnlyLineSearch(bool kinematics_only_line_search_in){
+  kinematics_only_line_search = kinematics_only_line_search_in;
+}
+
+void IKModule::setSolverMode(int solver_mode_in){
+  if ((solver_mode_in != IK_SOLVER_LINE_SEARCH) && (solver_mode_in != IK_SOLVER_LEVENBERG_MARQUARDT)){
+    std::cout << "[IK Module] Error. Unknown solver mode " << solver_mode_in << ". Keeping the current mode" << std::endl;
+    return;
+  }
+  solver_mode = solver_mode_in;
+}
+
+void IKModule::setLevenbergMarquardtDamping(double scale_init_in, double bias_in, double scale_max_in){
+  if ((scale_init_in <= 0.0) || (bias_in <= 0.0) || (scale_max_in < scale_init_in)){
+    std::cout << "[IK Module] Error. Levenberg-Marquardt damping must satisfy 0 < scale_init <= scale_max and bias > 0" << std::endl;
+    return;
+  }
+  lm_damping_scale_init = scale_init_in;
+  lm_damping_bias = bias_in;
+  lm_damping_scale_max = scale_max_in;
+}
+
+void IKModule::setCancelFlag(std::atomic<bool> * cancel_flag_in){
+  cancel_flag = cancel_flag_in;
+}
+
+bool IKModule::cancelRequested(){
+  return (cancel_flag != nullptr) && cancel_flag->load(std::memory_order_relaxed);
+}
+
+int IKModule::getLastNumIterations(){
+  return num_iters_;
+}
+
+int IKModule::getLastNumMinorIterations(){
+  return num_minor_iters_;
+}
+
+int IKModule::getTotalNumIterations(){
+  return total_num_iters_;
+}
+
+int IKModule::getTotalNumMinorIterations(){
+  return total_num_minor_iters_;
+}
+
+int IKModule::getTotalNumSolves(){
+  return total_num_solves_;
+}
+
+void IKModule::resetIterationCounts(){
+  num_iters_ = 0;
+  num_minor_iters_ = 0;
+  total_num_iters_ = 0;
+  total_num_minor_iters_ = 0;
+  total_num_solves_ = 0;
+  num_inertia_updates_ = 0;
+}
+
+void IKModule::setPseudoInverseMethod(int pinv_method_in){
+  pinv_method = pinv_method_in;
+  for(int i = 0; i < task_pinv_methods_.size(); i++){
+    task_pinv_methods_[i] = pinv_method_in;
+  }
+  for(int i = 0; i < pinv_solvers_.size(); i++){
+    pinv_solvers_[i].setMethod(pinv_method_in);
+  }
+}
+
+void IKModule::setPseudoInverseMethod(int task_idx, int pinv_method_in){
+  if (task_idx < 0){
+    std::cout << "[IK Module] Error. Invalid task index " << task_idx << " for the pseudo inverse method" << std::endl;
+    return;
+  }
+  while (task_pinv_methods_.size() <= task_idx){
+    task_pinv_methods_.push_back(pinv_method);
+  }
+  task_pinv_methods_[task_idx] = pinv_method_in;
+  if (task_idx < pinv_solvers_.size()){
+    pinv_solvers_[task_idx].setMethod(pinv_method_in);
+  }
+}
+
+void IKModule::setPseudoInverseDamping(double damping_in){
+  pinv_damping = damping_in;
+  for(int i = 0; i < pinv_solvers_.size(); i++){
+    pinv_solvers_[i].setDamping(damping_in);
+  }
+}
+
+void IKModule::printPseudoInverseStats(){
+  std::cout << "[IK Module] Pseudo inverse stats:" << std::endl;
+  for(int i = 0; i < pinv_solvers_.size(); i++){
+    std::cout << "    task " << i << " (" << pinv_solvers_[i].getMethodName() << "): " 
+              << pinv_solvers_[i].getNumCalls() << " calls, "
+              << pinv_solvers_[i].getAverageTime() << " s average, "
+              << pinv_solvers_[i].getTotalTime() << " s total" << std::endl;
+  }
+}
+
+void IKModule::resetPseudoInverseStats(){
+  for(int i = 0; i < pinv_solvers_.size(); i++){
+    pinv_solvers_[i].resetStats();
+  }
+}
+
+void IKModule::setLevenbergMarquardtPseudoInverses(double damping){
+  for(int i = 0; i < pinv_solvers_.size(); i++){
+    pinv_solvers_[i].setMethod(PINV_DAMPED_LEAST_SQUARES);
+    pinv_solvers_[i].setDamping(damping);
+  }
+}
+
+void IKModule::restorePseudoInverseSettings(){
+  for(int i = 0; i < pinv_solvers_.size(); i++){
+    pinv_solvers_[i].setMethod(task_pinv_methods_[i]);
+    pinv_solvers_[i].setDamping(pinv_damping);
+  }
+}
+
 void IKModule::setVerbosityLevel(int verbosity_level_in){
   if (verbosity_level_in <= IK_VERBOSITY_LOW){
     verbosity_level = IK_VERBOSITY_LOW;
@@ -134,6 +283,64 @@ double IKModule::getErrorTol(){
   return error_tol;
 }
 
+IKParameters IKModule::getParameters(){
+  IKParameters parameters;
+  parameters.singular_values_threshold = singular_values_threshold;
+  parameters.max_iters = max_iters;
+  parameters.max_minor_iters = max_minor_iters;
+  parameters.k_step = k_step;
+  parameters.beta = beta;
+  parameters.error_tol = error_tol;
+  parameters.grad_tol = grad_tol;
+  parameters.inertia_weighted = inertia_weighted_;
+  parameters.inertia_update_threshold = inertia_update_threshold;
+  parameters.sequential_descent = sequential_descent;
+  parameters.backtrack_with_current_task_error = backtrack_with_current_task_error;
+  parameters.check_prev_violations = check_prev_violations;
+  parameters.return_when_first_task_converges = return_when_first_task_converges;
+  parameters.incremental_nullspace = incremental_nullspace;
+  parameters.kinematics_only_line_search = kinematics_only_line_search;
+  parameters.solver_mode = solver_mode;
+  parameters.lm_damping_scale_init = lm_damping_scale_init;
+  parameters.lm_damping_bias = lm_damping_bias;
+  parameters.lm_damping_scale_max = lm_damping_scale_max;
+  parameters.pinv_method = pinv_method;
+  parameters.task_pinv_methods = task_pinv_methods_;
+  parameters.pinv_damping = pinv_damping;
+  parameters.verbosity_level = verbosity_level;
+  return parameters;
+}
+
+void IKModule::setParameters(const IKParameters & parameters){
+  singular_values_threshold = parameters.singular_values_threshold;
+  max_iters = parameters.max_iters;
+  max_minor_iters = parameters.max_minor_iters;
+  k_step = parameters.k_step;
+  beta = parameters.beta;
+  error_tol = parameters.error_tol;
+  grad_tol = parameters.grad_tol;
+  inertia_weighted_ = parameters.inertia_weighted;
+  inertia_update_threshold = parameters.inertia_update_threshold;
+  sequential_descent = parameters.sequential_descent;
+  backtrack_with_current_task_error = parameters.backtrack_with_current_task_error;
+  check_prev_violations = parameters.check_prev_violations;
+  return_when_first_task_converges = parameters.return_when_first_task_converges;
+  incremental_nullspace = parameters.incremental_nullspace;
+  kinematics_only_line_search = parameters.kinematics_only_line_search;
+  solver_mode = parameters.solver_mode;
+  lm_damping_scale_init = parameters.lm_damping_scale_init;
+  lm_damping_bias = parameters.lm_damping_bias;
+  lm_damping_scale_max = parameters.lm_damping_scale_max;
+  verbosity_level = parameters.verbosity_level;
+
+  setPseudoInverseMethod(parameters.pinv_method);
+  for(int i = 0; i < parameters.task_pinv_methods.size(); i++){
+    setPseudoInverseMethod(i, parameters.task_pinv_methods[i]);
+  }
+  setPseudoInverseDamping(parameters.pinv_damping);
+  invalidateInertiaCache();
+}
+
 void IKModule::updateTaskJacobians(){
   // Gets the task jacobians
   for(int i = 0; i < task_hierarchy.size(); i++){
@@ -141,12 +348,31 @@ void IKModule::updateTaskJacobians(){
   }
 }
 
+void IKModule::updateInertiaWeight(){
+  // The weight only depends on q_start. Reuse it while q_start stays within the threshold
+  if (inertia_cache_valid_ && (q_inertia_.size() == q_start.size()) &&
+      ((q_start - q_inertia_).lpNorm<Eigen::Infinity>() <= inertia_update_threshold)){
+    return;
+  }
+  // computeMinverse obtains the inverse directly from the articulated body algorithm, without forming and inverting A
+  robot_model->computeInertiaMatrixInverse(q_start);
+  Ainv_ = robot_model->Ainv;
+  q_inertia_ = q_start;
+  inertia_cache_valid_ = true;
+  num_inertia_updates_++;
+}
+
 void IKModule::computePseudoInverses(){
   if (inertia_weighted_){
-    robot_model->computeInertiaMatrixInverse(q_start);
+    updateInertiaWeight();
   }
   updateTaskJacobians();
 
+  if (incremental_nullspace){
+    computePseudoInversesIncremental();
+    return;
+  }
+
   // Compute Nullspaces, Projected Task Jacobians, and Pseudoinverse of Projected Jacobians 
   for(int i = 0; i < task_hierarchy.size(); i++){
     // Initialize Nullspace to Identity
@@ -165,10 +391,10 @@ void IKModule::computePseudoInverses(){
 
     // Inertia Weighted
     if (inertia_weighted_){
-      math_utils::weightedPseudoInverse(JN_[i], robot_model->Ainv, svd_list_[i], JNpinv_[i], singular_values_threshold);
+      pinv_solvers_[i].compute(JN_[i], Ainv_, JNpinv_[i], singular_values_threshold);
     }else{
     // Unweighted:
-      math_utils::weightedPseudoInverse(JN_[i], I_, svd_list_[i], JNpinv_[i], singular_values_threshold);
+      pinv_solvers_[i].compute(JN_[i], JNpinv_[i], singular_values_threshold);
     }
 
     // Compute Null Space for this task N_k = I - pinv(J_k N_{k-1})(J_k N_{k-1}).
@@ -179,6 +405,39 @@ void IKModule::computePseudoInverses(){
 
 }
 
+void IKModule::computePseudoInversesIncremental(){
+  // Nacc_ holds N_0*N_1*...*N_{i-1} for the current priority level i. Base case N_0 = I
+  Nacc_ = I_;
+  for(int i = 0; i < task_hierarchy.size(); i++){
+    // Compute Projected Jacobian J_k*N_{k-1}
+    if (i == 0){
+      JN_[0] = J_[0];
+    }else{
+      JN_[i].noalias() = J_[i]*Nacc_;
+    }
+
+    // Compute pseudo inverse of JN_[i] 
+    if (inertia_weighted_){
+      pinv_solvers_[i].compute(JN_[i], Ainv_, JNpinv_[i], singular_values_threshold);
+    }else{
+      pinv_solvers_[i].compute(JN_[i], JNpinv_[i], singular_values_threshold);
+    }
+
+    // Carry the projector to the next level:
+    //   Nacc_ * (I - pinv(J_k N_{k-1})(J_k N_{k-1})) = Nacc_ - (Nacc_ pinv(J_k N_{k-1}))(J_k N_{k-1})
+    // which only needs nv x task_dim products instead of a dense nv x nv product.
+    if ( i < (task_hierarchy.size()-1) ){
+      if (i == 0){
+        Nacc_.noalias() -= JNpinv_[0]*JN_[0];
+      }else{
+        NaccJNpinv_[i].noalias() = Nacc_*JNpinv_[i];
+        Nacc_.noalias() -= NaccJNpinv_[i]*JN_[i];
+      }
+    }
+  }
+
+}
+
 void IKModule::computeTaskErrors(){
   total_error_norm = 0.0;
   // Compute Task Errors
@@ -260,6 +519,16 @@ bool IKModule::checkFirstTaskConvergence(){
   return first_task_convergence;
 }
 
+double IKModule::computeMeritFunction(const int & task_idx_to_minimize){
+  if (backtrack_with_current_task_error){
+    // Using the current task error norm
+    return dx_norms_[task_idx_to_minimize];
+  }else{
+    // Using the total error norm
+    return total_error_norm;
+  }
+}
+
 bool IKModule::checkBackTrackCondition(int task_idx_to_minimize){
   // At each descent step, whether or not to ensure that the previous task was not violated
   if (check_prev_violations){
@@ -281,11 +550,28 @@ bool IKModule::solveIK(int & solve_result, std::vector<double> & task_error_norm
 
 
 bool IKModule::solveIK(int & solve_result, double & total_error_norm_out, Eigen::VectorXd & q_sol){
+  num_iters_ = 0;
+  num_minor_iters_ = 0;
+  total_num_solves_++;
+  if (solver_mode == IK_SOLVER_LEVENBERG_MARQUARDT){
+    return solveIKLevenbergMarquardt(solve_result, total_error_norm_out, q_sol);
+  }
+
   q_current = q_start;
 
   int task_idx_to_minimize = 0;
 
   for(int i = 0; i < max_iters; i++){
+    if ((i > 0) && cancelRequested()){
+      solve_result = IK_CANCELLED;
+      solve_result_ = IK_CANCELLED;
+      total_error_norm_out = total_error_norm;
+      q_sol = q_current;
+      q_sol_ = q_current;
+      return false;
+    }
+    num_iters_++;
+    total_num_iters_++;
     // First pass
     if (i == 0){
       robot_model->updateFullKinematics(q_current);
@@ -334,12 +620,18 @@ bool IKModule::solveIK(int & solve_result, double & total_error_norm_out, Eigen:
     } 
 
     while(true){
+      num_minor_iters_++;
+      total_num_minor_iters_++;
       // Forward integrate with the computed dq
       robot_model->forwardIntegrate(q_current, k_step*dq_tot, q_step);
       // Ensure joint limits are not exceeded
       clampConfig(q_step);
-      // Update the robot model
-      robot_model->updateFullKinematics(q_step);
+      // Update the robot model. Task errors only depend on the placements
+      if (kinematics_only_line_search){
+        robot_model->updateKinematicsPlacements(q_step);
+      }else{
+        robot_model->updateFullKinematics(q_step);
+      }
 
       if  ((minor_iter_count > 0) && (verbosity_level == IK_VERBOSITY_HIGH)){
         std::cout << "    IK Minor Iter " << minor_iter_count << ": ";        
@@ -420,6 +712,10 @@ bool IKModule::solveIK(int & solve_result, double & total_error_norm_out, Eigen:
       }else{
         // Successfully found a descent vector
         q_current = q_step;
+        // The placements are already at q_step. Compute the Jacobians for the next major iteration
+        if (kinematics_only_line_search){
+          robot_model->updateKinematicsJacobians();
+        }
         break; // finish back tracking step
       }
     }
@@ -483,6 +779,8 @@ void IKModule::printSolutionResults(){
     std::cout << "[IK Module] Result: Maximum Iterations Hit" << std::endl;    
   } else if (solve_result_ == IK_MAX_MINOR_ITER_HIT){
     std::cout << "[IK Module] Result: Maximum Minor Iterations Hit" << std::endl;    
+  } else if (solve_result_ == IK_CANCELLED){
+    std::cout << "[IK Module] Result: Cancelled" << std::endl;    
   } else{
     std::cout << "[IK Module] Result: No solve routine has been called yet" << std::endl;        
   }
@@ -507,4 +805,178 @@ void IKModule::printSolutionResults(){
   }   
   std::cout << std::endl << std::endl;
 
-}
\ No newline at end of file
+}
+
+bool IKModule::solveIKLevenbergMarquardt(int & solve_result, double & total_error_norm_out, Eigen::VectorXd & q_sol){
+  q_current = q_start;
+
+  int task_idx_to_minimize = 0;
+  int num_rejected_steps = 0;
+  double damping_scale = lm_damping_scale_init;
+  double damping = 0.0;
+  double nu = 2.0; // growth factor of the squared damping scale after consecutive rejections
+  double f_q_pred = 0.0;
+  double predicted_reduction = 0.0;
+  double gain_ratio = 0.0;
+  double scale_update = 1.0;
+
+  robot_model->updateFullKinematics(q_current);
+  if (verbosity_level == IK_VERBOSITY_HIGH){
+    printTaskErrorsHeader();
+    std::cout << "  Starting Errors 0: ";
+  }
+  computeTaskErrors();
+
+  for(int i = 0; i < max_iters; i++){
+    if (cancelRequested()){
+      solve_result = IK_CANCELLED;
+      solve_result_ = IK_CANCELLED;
+      total_error_norm_out = total_error_norm;
+      q_sol = q_current;
+      q_sol_ = q_current;
+      restorePseudoInverseSettings();
+      return false;
+    }
+    num_iters_++;
+    total_num_iters_++;
+
+    // Select the task to minimize in order of priority
+    task_idx_to_minimize = 0;
+    if (backtrack_with_current_task_error){
+      for(int j = 0; j < dx_norms_.size(); j++){
+        if (dx_norms_[j] >= error_tol){
+          task_idx_to_minimize = j;
+          break;
+        }
+      }
+    }
+    f_q = computeMeritFunction(task_idx_to_minimize);
+
+    // Damped descent direction at the current configuration. The Jacobians stay valid while steps are rejected
+    damping = std::sqrt(damping_scale*damping_scale*0.5*f_q*f_q + lm_damping_bias*lm_damping_bias);
+    setLevenbergMarquardtPseudoInverses(damping);
+    computePseudoInverses();
+    if (sequential_descent){
+      compute_dq(task_idx_to_minimize);
+    }else{
+      compute_dq();
+    }
+
+    // Merit predicted by the linearized task errors dx - J*dq
+    if (backtrack_with_current_task_error){
+      f_q_pred = (dx_[task_idx_to_minimize] - J_[task_idx_to_minimize]*dq_tot).norm();
+    }else{
+      f_q_pred = 0.0;
+      for(int j = 0; j < task_hierarchy.size(); j++){
+        f_q_pred += (dx_[j] - J_[j]*dq_tot).norm();
+      }
+    }
+    predicted_reduction = f_q*f_q - f_q_pred*f_q_pred;
+
+    // Check if the step is too small. If so, we are at a local minimum
+    grad_f_norm_squared = dq_tot.squaredNorm();
+    if (grad_f_norm_squared < grad_tol){
+      solve_result = IK_SUBOPTIMAL_SOL;
+      solve_result_ = IK_SUBOPTIMAL_SOL;
+      total_error_norm_out = total_error_norm;
+      q_sol = q_current;
+      q_sol_ = q_current;
+      restorePseudoInverseSettings();
+      if (verbosity_level == IK_VERBOSITY_HIGH){
+        std::cout << "  Final Error Norm: ";
+        printTaskErrors();
+      }
+      return checkFirstTaskConvergence();
+    }
+
+    // Evaluate the trial step
+    num_minor_iters_++;
+    total_num_minor_iters_++;
+    robot_model->forwardIntegrate(q_current, dq_tot, q_step);
+    clampConfig(q_step);
+    if (kinematics_only_line_search){
+      robot_model->updateKinematicsPlacements(q_step);
+    }else{
+      robot_model->updateFullKinematics(q_step);
+    }
+    if (verbosity_level == IK_VERBOSITY_HIGH){
+      std::cout << "  IK LM Iter " << i << " damping " << damping << ": ";
+    }
+    computeTaskErrors();
+    f_q_p_dq = computeMeritFunction(task_idx_to_minimize);
+
+    if (!checkBackTrackCondition(task_idx_to_minimize)){
+      // Accept the step and update the damping scale according to the gain ratio rho.
+      // Nielsen's update of the squared scale: scale^2 *= max(1/3, 1 - (2*rho - 1)^3)
+      q_current = q_step;
+      if (kinematics_only_line_search){
+        robot_model->updateKinematicsJacobians();
+      }
+      if (predicted_reduction > 0.0){
+        gain_ratio = (f_q*f_q - f_q_p_dq*f_q_p_dq) / predicted_reduction;
+        scale_update = std::max(1.0/3.0, 1.0 - std::pow(2.0*gain_ratio - 1.0, 3));
+      }else{
+        scale_update = 1.0/3.0;
+      }
+      damping_scale = damping_scale*std::sqrt(scale_update);
+      nu = 2.0;
+      num_rejected_steps = 0;
+
+      // Check if the first task has converged and if we are required to return immediately. 
+      if ((return_when_first_task_converges && checkFirstTaskConvergence()) || (total_error_norm < error_tol)){
+        solve_result = IK_OPTIMAL_SOL;
+        solve_result_ = IK_OPTIMAL_SOL;
+        total_error_norm_out = total_error_norm;
+        q_sol = q_current;
+        q_sol_ = q_current;
+        restorePseudoInverseSettings();
+        if (verbosity_level == IK_VERBOSITY_HIGH){
+          std::cout << "  Final Error Norm: ";
+          printTaskErrors();
+        }
+        return checkFirstTaskConvergence();
+      }
+    }else{
+      // Reject the step, grow the damping scale and restore the task errors at the current configuration
+      damping_scale = damping_scale*std::sqrt(nu);
+      nu = 2.0*nu;
+      num_rejected_steps++;
+
+      if ((num_rejected_steps > max_minor_iters) || (damping_scale > lm_damping_scale_max)){
+        solve_result = IK_MAX_MINOR_ITER_HIT;
+        solve_result_ = IK_MAX_MINOR_ITER_HIT;
+        total_error_norm_out = total_error_norm;
+        q_sol = q_current;
+        q_sol_ = q_current;
+        restorePseudoInverseSettings();
+        if (verbosity_level == IK_VERBOSITY_HIGH){
+          std::cout << "  Final Error Norm: ";
+        }
+        // Recompute errors for the solution
+        robot_model->updateFullKinematics(q_sol);
+        computeTaskErrors();
+        return checkFirstTaskConvergence();
+      }
+
+      if (kinematics_only_line_search){
+        robot_model->updateKinematicsPlacements(q_current);
+      }else{
+        robot_model->updateFullKinematics(q_current);
+      }
+      if (verbosity_level == IK_VERBOSITY_HIGH){
+        std::cout << "    Rejected. Restored Errors: ";
+      }
+      computeTaskErrors();
+    }
+  }
+
+  // Hit maximum iterations
+  std::cout << "[IK Module] Maximum Iterations Hit" << std::endl;  
+  solve_result = IK_MAX_ITERATIONS_HIT; 
+  solve_result_ = IK_MAX_ITERATIONS_HIT;
+  restorePseudoInverseSettings();
+  total_error_norm_out = total_error_norm;
+  q_sol = q_current;
+  q_sol_ = q_current;
+  return false;
+}
@@ -184,26 +184,22 @@ void ValkyrieStanceGeneration::default_initialization(){
 }
 
 
-bool ValkyrieStanceGeneration::computeStance(Eigen::VectorXd & q_out){
-  // Initialize the tasks
-  initializeTasks();
-  
-  // Set Remaining task references
-  // Set desired base pose to be close to the initial configuration
-  base_pose_task->setReference(Eigen::Vector3d(q_start[0], q_start[1], q_start[2]), Eigen::Quaterniond(q_start[6], q_start[3], q_start[4], q_start[5]));
-  pelvis_wrt_rf_task->setReference(pelvis_wrt_rfoot_des_pos, pelvis_wrt_rfoot_des_quat);
-  pelvis_wrt_mf_task->setReference(pelvis_wrt_mf_des_pos, pelvis_wrt_mf_des_quat);
-  lfoot_wrt_rfoot_task->setReference(lf_wrt_rf_des_pos, lf_wrt_rf_des_quat);
-  rpalm_task->setReference(rpalm_des_pos, rpalm_des_quat);
-  lpalm_task->setReference(lpalm_des_pos, lpalm_des_quat);
+void ValkyrieStanceGeneration::setNumThreads(int num_threads_in){
+  worker_generators.clear();
+  // Each additional thread uses a stance generator on its own model data
+  for(int i = 1; i < num_threads_in; i++){
+    std::shared_ptr<RobotModel> worker_model(new RobotModelContext(robot_model));
+    worker_generators.push_back(std::shared_ptr<ValkyrieStanceGeneration>(new ValkyrieStanceGeneration(worker_model)));
+  }
+}
 
-  // Set Posture references
-  Eigen::VectorXd q_des;
-  getSelectedPostureTaskReferences(torso_neck_arm_posture_task_names, q_start, q_des);
-  torso_neck_arm_posture_task->setReference(q_des);
+std::vector< std::shared_ptr<Task> > ValkyrieStanceGeneration::getReferenceTasks(){
+  return {base_pose_task, pelvis_wrt_rf_task, pelvis_wrt_mf_task, lfoot_wrt_rfoot_task, rpalm_task, lpalm_task, torso_neck_arm_posture_task, overall_posture_task};
+}
 
-  getSelectedPostureTaskReferences(overall_posture_task_joint_names, q_start, q_des);
-  overall_posture_task->setReference(q_des);
+void ValkyrieStanceGeneration::prepareBatchSolvers(){
+  // Initialize the tasks
+  initializeTasks();
 
   // Set IK Descent parameters
   snap_to_floor_ik_module.setSequentialDescent(false);
@@ -217,24 +213,120 @@ bool ValkyrieStanceGeneration::computeStance(Eigen::VectorXd & q_out){
   stance_ik_module.setCheckPrevViolations(true);
   stance_ik_module.setEnableInertiaWeighting(false);
 
-  // Perform the sequential IK:
-  bool snap_to_floor_task_convergence = false;
-  bool stance_identification_task_convergence = false;
+  // The modules of this object are members, the solvers must not delete them
+  snap_to_floor_solver.clearWorkers();
+  stance_solver.clearWorkers();
+  snap_to_floor_solver.addWorker(robot_model, std::shared_ptr<IKModule>(std::shared_ptr<IKModule>(), &snap_to_floor_ik_module), getReferenceTasks());
+  stance_solver.addWorker(robot_model, std::shared_ptr<IKModule>(std::shared_ptr<IKModule>(), &stance_ik_module), getReferenceTasks());
+
+  // The worker generators build the same IK problems with the same IK parameters
+  for(int i = 0; i < worker_generators.size(); i++){
+    std::shared_ptr<ValkyrieStanceGeneration> & worker = worker_generators[i];
+    worker->setUseRightHand(use_right_hand);
+    worker->setUseLeftHand(use_left_hand);
+    worker->left_floor_normal = left_floor_normal;
+    worker->left_floor_center = left_floor_center;
+    worker->right_floor_normal = right_floor_normal;
+    worker->right_floor_center = right_floor_center;
+    worker->initializeTasks();
+    worker->snap_to_floor_ik_module.setParameters(snap_to_floor_ik_module.getParameters());
+    worker->stance_ik_module.setParameters(stance_ik_module.getParameters());
+
+    // The module pointers share the ownership of the worker generator
+    snap_to_floor_solver.addWorker(worker->robot_model, std::shared_ptr<IKModule>(worker, &worker->snap_to_floor_ik_module), worker->getReferenceTasks());
+    stance_solver.addWorker(worker->robot_model, std::shared_ptr<IKModule>(worker, &worker->stance_ik_module), worker->getReferenceTasks());
+  }
+}
+
+void ValkyrieStanceGeneration::createStanceJob(const Eigen::VectorXd & q_start_in, BatchIKJob & job){
+  job = BatchIKJob(q_start_in);
+
+  // Set Remaining task references in the order of getReferenceTasks()
+  // Set desired base pose to be close to the initial configuration
+  job.addReference(0, Eigen::Vector3d(q_start_in[0], q_start_in[1], q_start_in[2]), Eigen::Quaterniond(q_start_in[6], q_start_in[3], q_start_in[4], q_start_in[5]));
+  job.addReference(1, pelvis_wrt_rfoot_des_pos, pelvis_wrt_rfoot_des_quat);
+  job.addReference(2, pelvis_wrt_mf_des_pos, pelvis_wrt_mf_des_quat);
+  job.addReference(3, lf_wrt_rf_des_pos, lf_wrt_rf_des_quat);
+  job.addReference(4, rpalm_des_pos, rpalm_des_quat);
+  job.addReference(5, lpalm_des_pos, lpalm_des_quat);
+
+  // Set Posture references
+  Eigen::VectorXd q_des;
+  getSelectedPostureTaskReferences(torso_neck_arm_posture_task_names, q_start_in, q_des);
+  job.addReference(6, q_des);
 
+  getSelectedPostureTaskReferences(overall_posture_task_joint_names, q_start_in, q_des);
+  job.addReference(7, q_des);
+}
+
+int ValkyrieStanceGeneration::computeStances(const std::vector<Eigen::VectorXd> & q_start_list, std::vector<Eigen::VectorXd> & q_out_list, std::vector<bool> & convergence_list){
+  prepareBatchSolvers();
+
+  // Perform the sequential IK:
   // Step 1: snap the robot to the floor
-  snap_to_floor_task_convergence = snap_to_floor_ik_module.solveIK(solve_result, task_error_norms, total_error_norm, q_sol);
+  std::vector<BatchIKJob> snap_to_floor_jobs(q_start_list.size());
+  for(int i = 0; i < q_start_list.size(); i++){
+    createStanceJob(q_start_list[i], snap_to_floor_jobs[i]);
+  }
+  snap_to_floor_solver.solve(snap_to_floor_jobs, snap_to_floor_results);
+
+  // Step 2: Solve for the end effector pose from the converged floor snaps. The references stay those of the starting configuration
+  std::vector<BatchIKJob> stance_jobs;
+  std::vector<int> stance_job_indices;
+  for(int i = 0; i < snap_to_floor_results.size(); i++){
+    if (snap_to_floor_results[i].convergence){
+      stance_jobs.push_back(snap_to_floor_jobs[i]);
+      stance_jobs.back().q_seed = snap_to_floor_results[i].q_sol;
+      stance_job_indices.push_back(i);
+    }
+  }
+  std::vector<BatchIKResult> converged_snap_stance_results;
+  stance_solver.solve(stance_jobs, converged_snap_stance_results);
+
+  // Output the solutions. If the floor snap failed, its solution is the output
+  stance_results.clear();
+  stance_results.resize(snap_to_floor_results.size());
+  for(int i = 0; i < stance_job_indices.size(); i++){
+    stance_results[stance_job_indices[i]] = converged_snap_stance_results[i];
+  }
+
+  int num_converged = 0;
+  q_out_list.resize(snap_to_floor_results.size());
+  convergence_list.resize(snap_to_floor_results.size());
+  for(int i = 0; i < snap_to_floor_results.size(); i++){
+    if (snap_to_floor_results[i].convergence){
+      q_out_list[i] = stance_results[i].q_sol;
+    }else{
+      q_out_list[i] = snap_to_floor_results[i].q_sol;
+    }
+    convergence_list[i] = (snap_to_floor_results[i].convergence && stance_results[i].convergence);
+    if (convergence_list[i]){
+      num_converged++;
+    }
+  }
+  return num_converged;
+}
 
-  // Step 2: Solve for the end effector pose 
-  if (snap_to_floor_task_convergence){
-    this->setStartingConfig(q_sol);
-    stance_identification_task_convergence = stance_ik_module.solveIK(solve_result, task_error_norms, total_error_norm, q_sol);
+bool ValkyrieStanceGeneration::computeStance(Eigen::VectorXd & q_out){
+  std::vector<Eigen::VectorXd> q_out_list;
+  std::vector<bool> convergence_list;
+  computeStances({q_start}, q_out_list, convergence_list);
+
+  // Keep the IK outputs of the last solve
+  const BatchIKResult * last_result = &snap_to_floor_results[0];
+  if (snap_to_floor_results[0].convergence){
+    this->setStartingConfig(snap_to_floor_results[0].q_sol);
+    last_result = &stance_results[0];
   }
+  solve_result = last_result->solve_result;
+  task_error_norms = last_result->task_error_norms;
+  total_error_norm = last_result->total_error_norm;
+  q_sol = last_result->q_sol;
 
   // Output the solution
-  q_out = q_sol;
-
-  return (snap_to_floor_task_convergence && stance_identification_task_convergence);
+  q_out = q_out_list[0];
 
+  return convergence_list[0];
 }
 
 
@@ -1,20 +1,33 @@
 #include <avatar_locomanipulation/models/robot_model.hpp>
+#include <cassert>
 
-RobotModel::RobotModel(){
+FrameHandle::FrameHandle(): name(""), index(0), valid(false){
 }
 
-RobotModel::RobotModel(const std::string & filename){
+JointHandle::JointHandle(): name(""), id(0), q_index(-1), q_index_no_floating_joints(-1), valid(false){
+}
+
+RobotModel::RobotModel(): model_storage(new pinocchio::Model()), geom_model_storage(new pinocchio::GeometryModel()),
+                          model(*model_storage), geomModel(*geom_model_storage){
+}
+
+RobotModel::RobotModel(const std::string & filename): RobotModel(){
   buildPinocchioModel(filename);
   commonInitialization(false);
 }
 
-RobotModel::RobotModel(const std::string & filename, const std::string & meshDir){
+RobotModel::RobotModel(const std::string & filename, const std::string & meshDir): RobotModel(){
   buildPinocchioModel(filename);
   buildPinocchioGeomModel(filename, meshDir);
   commonInitialization(true);
 }
 
-RobotModel::RobotModel(const std::string & filename, const std::string & meshDir, const std::string & srdf){
+RobotModel::RobotModel(const std::shared_ptr<pinocchio::Model> & model_in, const std::shared_ptr<pinocchio::GeometryModel> & geom_model_in): 
+                          model_storage(model_in), geom_model_storage(geom_model_in),
+                          model(*model_storage), geomModel(*geom_model_storage){
+}
+
+RobotModel::RobotModel(const std::string & filename, const std::string & meshDir, const std::string & srdf): RobotModel(){
   srdf_bool = true;
   srdf_filename = srdf;
   buildPinocchioModel(filename);
@@ -107,6 +120,27 @@ void RobotModel::updateFullKinematics(const Eigen::VectorXd & q_update){
 
 }
 
+void RobotModel::updateKinematicsPlacements(const Eigen::VectorXd & q_update){
+  q_current = q_update;
+  // Perform forward kinematics
+  pinocchio::forwardKinematics(model, *data, q_update);
+  // Update Frame Placements
+  pinocchio::updateFramePlacements(model, *data);
+  // Update CoM position
+  computeCoMPos(q_update);
+
+  if (updateGeomWithKinematics){
+      this->updateGeometry(q_update);
+  }
+}
+
+void RobotModel::updateKinematicsJacobians(){
+  // Compute Joint Jacobians
+  pinocchio::computeJointJacobians(model, *data, q_current);
+  // Update CoM Jacobian
+  computeCoMJacobian();
+}
+
 void RobotModel::updateKinematicsDerivatives(const Eigen::VectorXd & q_update, const Eigen::VectorXd & qdot_update, const Eigen::VectorXd & qddot_update){
   // Compute the derivatives of the kinematics
   pinocchio::computeForwardKinematicsDerivatives(model, *data, q_update, qdot_update, qddot_update);    
@@ -127,6 +161,14 @@ void RobotModel::get6DTaskJacobianLocal(const std::string & frame_name, Eigen::M
   pinocchio::getFrameJacobian(model, *data, tmp_frame_index, pinocchio::LOCAL, J_out);
 }
 
+void RobotModel::get6DTaskJacobian(const FrameHandle & frame, Eigen::MatrixXd & J_out){
+  pinocchio::getFrameJacobian(model, *data, frame.index, pinocchio::WORLD, J_out);
+}
+
+void RobotModel::get6DTaskJacobianLocal(const FrameHandle & frame, Eigen::MatrixXd & J_out){
+  pinocchio::getFrameJacobian(model, *data, frame.index, pinocchio::LOCAL, J_out);
+}
+
 void RobotModel::get6DTaskJacobianDot(const std::string & frame_name, Eigen::MatrixXd & Jdot_out){
   pinocchio::getFrameJacobianTimeVariation(model, *data, model.getFrameId(frame_name), pinocchio::WORLD, Jdot_out);
 }
@@ -135,6 +177,14 @@ void RobotModel::get6DTaskJacobianDotLocal(const std::string & frame_name, Eigen
   pinocchio::getFrameJacobianTimeVariation(model, *data, model.getFrameId(frame_name), pinocchio::LOCAL, Jdot_out);
 }
 
+void RobotModel::get6DTaskJacobianDot(const FrameHandle & frame, Eigen::MatrixXd & Jdot_out){
+  pinocchio::getFrameJacobianTimeVariation(model, *data, frame.index, pinocchio::WORLD, Jdot_out);
+}
+
+void RobotModel::get6DTaskJacobianDotLocal(const FrameHandle & frame, Eigen::MatrixXd & Jdot_out){
+  pinocchio::getFrameJacobianTimeVariation(model, *data, frame.index, pinocchio::LOCAL, Jdot_out);
+}
+
 void RobotModel::getFrameWorldPose(const std::string & name, Eigen::Vector3d & pos, Eigen::Quaternion<double> & ori){
   // Gets the frame index
   tmp_frame_index = model.getFrameId(name);
@@ -143,6 +193,37 @@ void RobotModel::getFrameWorldPose(const std::string & name, Eigen::Vector3d & p
   ori = data->oMf[tmp_frame_index].rotation();
 }
 
+void RobotModel::getFrameWorldPose(const FrameHandle & frame, Eigen::Vector3d & pos, Eigen::Quaternion<double> & ori){
+  pos = data->oMf[frame.index].translation();
+  ori = data->oMf[frame.index].rotation();
+}
+
+FrameHandle RobotModel::getFrameHandle(const std::string & frame_name){
+  FrameHandle frame;
+  frame.name = frame_name;
+  if (!model.existFrame(frame_name)){
+    std::cerr << "[RobotModel] Error. Frame " << frame_name << " does not exist" << std::endl;
+    return frame;
+  }
+  frame.index = model.getFrameId(frame_name);
+  frame.valid = true;
+  return frame;
+}
+
+JointHandle RobotModel::getJointHandle(const std::string & joint_name){
+  JointHandle joint;
+  joint.name = joint_name;
+  if (!model.existJointName(joint_name)){
+    std::cerr << "[RobotModel] Error. Joint " << joint_name << " does not exist" << std::endl;
+    return joint;
+  }
+  joint.id = model.getJointId(joint_name);
+  joint.q_index = VAL_MODEL_NUM_FLOATING_JOINTS + joint.id - VAL_MODEL_JOINT_INDX_OFFSET;
+  joint.q_index_no_floating_joints = joint.id - VAL_MODEL_JOINT_INDX_OFFSET;
+  joint.valid = true;
+  return joint;
+}
+
 
 int RobotModel::getDimQ(){
   return model.nq;
@@ -160,10 +241,24 @@ int RobotModel::getJointIndexNoFloatingJoints(const std::string & name){
   return model.getJointId(name) - VAL_MODEL_JOINT_INDX_OFFSET;    
 }
 
+int RobotModel::getJointIndex(const JointHandle & joint){
+  assert(joint.valid);
+  return joint.q_index;
+}
+
+int RobotModel::getJointIndexNoFloatingJoints(const JointHandle & joint){
+  assert(joint.valid);
+  return joint.q_index_no_floating_joints;
+}
+
 void RobotModel::forwardIntegrate(const Eigen::VectorXd & q_start, const Eigen::VectorXd & qdotDt, Eigen::VectorXd & q_post){
   q_post = pinocchio::integrate(model, q_start, qdotDt); // This performs a tangent space integration. Automatically resolves the quaternion components
 }
 
+void RobotModel::configDifference(const Eigen::VectorXd & q_start, const Eigen::VectorXd & q_end, Eigen::VectorXd & qdotDt){
+  qdotDt = pinocchio::difference(model, q_start, q_end); // Inverse of the tangent space integration
+}
+
 void RobotModel::computeInertiaMatrix(const Eigen::VectorXd & q){
   // Composite Rigid Body Algorithm
   pinocchio::crba(model,*data, q); // only computes the upper triangle part.
@@ -232,4 +327,130 @@ void RobotModel::printFrameNames(){
   for (int k=0 ; k<model.frames.size() ; ++k){
     std::cout << "frame:" << k << " " << model.frames[k].name <<  std::endl;
   }	
-}
\ No newline at end of file
+}
+
+// RobotModelContext
+RobotModelContext::RobotModelContext(const std::shared_ptr<RobotModel> & robot_model_in): 
+                                     RobotModel(robot_model_in->model_storage, robot_model_in->geom_model_storage){
+  source_model = robot_model_in;
+  srdf_filename = robot_model_in->srdf_filename;
+  // Only allocate geometry data if the source model has geometry data
+  commonInitialization(robot_model_in->geomData != nullptr);
+  updateGeomWithKinematics = robot_model_in->updateGeomWithKinematics;
+  q_current = robot_model_in->q_current;
+}
+
+RobotModelContext::~RobotModelContext(){
+}
+
+// ReducedRobotModel
+ReducedRobotModel::ReducedRobotModel(const std::shared_ptr<RobotModel> & full_model_in, const std::vector<std::string> & locked_joint_names_in, const Eigen::VectorXd & q_full_reference_in):
+                                     RobotModel(std::make_shared<pinocchio::Model>(), std::make_shared<pinocchio::GeometryModel>()){
+  full_model = full_model_in;
+  srdf_filename = full_model_in->srdf_filename;
+  q_full_reference = q_full_reference_in;
+
+  // Resolve the locked joints. The universe and the floating base joint can not be locked.
+  for(int i = 0; i < locked_joint_names_in.size(); i++){
+    if (!full_model->model.existJointName(locked_joint_names_in[i])){
+      std::cerr << "[ReducedRobotModel] Error. Joint " << locked_joint_names_in[i] << " does not exist. It will not be locked." << std::endl;
+      continue;
+    }
+    pinocchio::JointIndex id = full_model->model.getJointId(locked_joint_names_in[i]);
+    if (id < VAL_MODEL_JOINT_INDX_OFFSET){
+      std::cerr << "[ReducedRobotModel] Error. Joint " << locked_joint_names_in[i] << " is the floating base. It will not be locked." << std::endl;
+      continue;
+    }
+    if (std::find(locked_joint_ids.begin(), locked_joint_ids.end(), id) == locked_joint_ids.end()){
+      locked_joint_ids.push_back(id);
+    }
+  }
+  std::sort(locked_joint_ids.begin(), locked_joint_ids.end());
+  for(int i = 0; i < locked_joint_ids.size(); i++){
+    locked_joint_names.push_back(full_model->model.names[locked_joint_ids[i]]);
+  }
+
+  bool geom_data_flag = (full_model->geomData != nullptr);
+  if (geom_data_flag){
+    pinocchio::buildReducedModel(full_model->model, full_model->geomModel, locked_joint_ids, q_full_reference, model, geomModel);
+    // Geometry objects keep their order. Keep the collision pairs of the full model (e.g. after srdf removal).
+    if ((geomModel.collisionPairs.size() == 0) && (geomModel.ngeoms == full_model->geomModel.ngeoms)){
+      for(int i = 0; i < full_model->geomModel.collisionPairs.size(); i++){
+        geomModel.addCollisionPair(full_model->geomModel.collisionPairs[i]);
+      }
+    }
+  }else{
+    pinocchio::buildReducedModel(full_model->model, locked_joint_ids, q_full_reference, model);
+  }
+
+  commonInitialization(geom_data_flag);
+  updateGeomWithKinematics = full_model->updateGeomWithKinematics;
+  buildIndexMaps();
+  fullToReducedConfig(q_full_reference, q_current);
+}
+
+ReducedRobotModel::~ReducedRobotModel(){
+}
+
+void ReducedRobotModel::buildIndexMaps(){
+  q_reduced_to_full.resize(model.nq);
+  v_reduced_to_full.resize(model.nv);
+  // Joint 0 is the universe
+  for(int j = 1; j < model.njoints; j++){
+    pinocchio::JointIndex full_id = full_model->model.getJointId(model.names[j]);
+    for(int k = 0; k < model.joints[j].nq(); k++){
+      q_reduced_to_full[model.joints[j].idx_q() + k] = full_model->model.joints[full_id].idx_q() + k;
+    }
+    for(int k = 0; k < model.joints[j].nv(); k++){
+      v_reduced_to_full[model.joints[j].idx_v() + k] = full_model->model.joints[full_id].idx_v() + k;
+    }
+  }
+}
+
+void ReducedRobotModel::fullToReducedConfig(const Eigen::VectorXd & q_full, Eigen::VectorXd & q_reduced){
+  q_reduced.resize(model.nq);
+  for(int i = 0; i < q_reduced_to_full.size(); i++){
+    q_reduced[i] = q_full[q_reduced_to_full[i]];
+  }
+}
+
+void ReducedRobotModel::reducedToFullConfig(const Eigen::VectorXd & q_reduced, Eigen::VectorXd & q_full){
+  q_full = q_full_reference;
+  for(int i = 0; i < q_reduced_to_full.size(); i++){
+    q_full[q_reduced_to_full[i]] = q_reduced[i];
+  }
+}
+
+void ReducedRobotModel::fullToReducedVelocity(const Eigen::VectorXd & qdot_full, Eigen::VectorXd & qdot_reduced){
+  qdot_reduced.resize(model.nv);
+  for(int i = 0; i < v_reduced_to_full.size(); i++){
+    qdot_reduced[i] = qdot_full[v_reduced_to_full[i]];
+  }
+}
+
+void ReducedRobotModel::reducedToFullVelocity(const Eigen::VectorXd & qdot_reduced, Eigen::VectorXd & qdot_full){
+  qdot_full = Eigen::VectorXd::Zero(full_model->model.nv);
+  for(int i = 0; i < v_reduced_to_full.size(); i++){
+    qdot_full[v_reduced_to_full[i]] = qdot_reduced[i];
+  }
+}
+
+std::shared_ptr<RobotModel> ReducedRobotModel::getFullModel(){
+  return full_model;
+}
+
+const std::vector<std::string> & ReducedRobotModel::getLockedJointNames(){
+  return locked_joint_names;
+}
+
+const Eigen::VectorXd & ReducedRobotModel::getFullReferenceConfig(){
+  return q_full_reference;
+}
+
+const std::vector<int> & ReducedRobotModel::getConfigIndexMap(){
+  return q_reduced_to_full;
+}
+
+const std::vector<int> & ReducedRobotModel::getVelocityIndexMap(){
+  return v_reduced_to_full;
+}
@@ -54,10 +54,22 @@ namespace planner{
     }
     bool NodePtr_Compare_key::operator() (const shared_ptr<Node> & lhs, const shared_ptr<Node> &rhs) const{
         {
-        return (lhs->key.compare(rhs->key) < 0);
+        return (lhs->key < rhs->key);
         }
     }
 
+    NodePtr_Hash_key::NodePtr_Hash_key(){
+    }
+    std::size_t NodePtr_Hash_key::operator() (const shared_ptr<Node> & node) const{
+        return key_hash(node->key);
+    }
+
+    NodePtr_Equal_key::NodePtr_Equal_key(){
+    }
+    bool NodePtr_Equal_key::operator() (const shared_ptr<Node> & lhs, const shared_ptr<Node> &rhs) const{
+        return (lhs->key == rhs->key);
+    }
+
     // Node class Implementation ------------------------------
     Node::Node(){
             
@@ -68,6 +80,144 @@ namespace planner{
             
     }
 
+    // IndexedNodeHeap Implementation ------------------------------
+    IndexedNodeHeap::IndexedNodeHeap(){
+    }
+
+    IndexedNodeHeap::~IndexedNodeHeap(){
+        clear();
+    }
+
+    void IndexedNodeHeap::push(const shared_ptr<Node> & node){
+        heap.push_back(node);
+        node->open_set_index = heap.size() - 1;
+        siftUp(node->open_set_index);
+    }
+
+    shared_ptr<Node> IndexedNodeHeap::remove(const int index){
+        shared_ptr<Node> removed_node = heap[index];
+        int last_index = heap.size() - 1;
+        // Move the last node into the vacated position and restore the heap ordering
+        if (index != last_index){
+            swapNodes(index, last_index);
+        }
+        heap.pop_back();
+        removed_node->open_set_index = -1;
+        if (index < heap.size()){
+            shared_ptr<Node> moved_node = heap[index];
+            siftUp(index);
+            siftDown(moved_node->open_set_index);
+        }
+        return removed_node;
+    }
+
+    shared_ptr<Node> IndexedNodeHeap::pop(){
+        return remove(0);
+    }
+
+    void IndexedNodeHeap::update(const shared_ptr<Node> & node){
+        if (!contains(node)){
+            return;
+        }
+        // The f_score may have decreased or increased. Only one of these will move the node
+        siftUp(node->open_set_index);
+        siftDown(node->open_set_index);
+    }
+
+    bool IndexedNodeHeap::contains(const shared_ptr<Node> & node) const{
+        return (node->open_set_index >= 0) && (node->open_set_index < heap.size()) && (heap[node->open_set_index] == node);
+    }
+
+    const shared_ptr<Node> & IndexedNodeHeap::top() const{
+        return heap[0];
+    }
+
+    const shared_ptr<Node> & IndexedNodeHeap::operator[](const int index) const{
+        return heap[index];
+    }
+
+    void IndexedNodeHeap::getTopNodes(const int k, std::vector< shared_ptr<Node> > & top_nodes) const{
+        top_nodes.clear();
+        // Best-first walk of the heap. The next smallest node is always a child of a node already taken.
+        std::vector<int> frontier;
+        if (!heap.empty()){
+            frontier.push_back(0);
+        }
+        int n = heap.size();
+        while ((top_nodes.size() < k) && (!frontier.empty())){
+            int best = 0;
+            for(int i = 1; i < frontier.size(); i++){
+                if (node_compare_fcost_obj(heap[frontier[i]], heap[frontier[best]])){
+                    best = i;
+                }
+            }
+            int index = frontier[best];
+            frontier.erase(frontier.begin() + best);
+            top_nodes.push_back(heap[index]);
+            if ((2*index + 1) < n){
+                frontier.push_back(2*index + 1);
+            }
+            if ((2*index + 2) < n){
+                frontier.push_back(2*index + 2);
+            }
+        }
+    }
+
+    size_t IndexedNodeHeap::size() const{
+        return heap.size();
+    }
+
+    bool IndexedNodeHeap::empty() const{
+        return heap.empty();
+    }
+
+    void IndexedNodeHeap::clear(){
+        for(int i = 0; i < heap.size(); i++){
+            heap[i]->open_set_index = -1;
+        }
+        heap.clear();
+    }
+
+    void IndexedNodeHeap::siftUp(int index){
+        int parent_index;
+        while (index > 0){
+            parent_index = (index - 1) / 2;
+            if (node_compare_fcost_obj(heap[index], heap[parent_index])){
+                swapNodes(index, parent_index);
+                index = parent_index;
+            }else{
+                break;
+            }
+        }
+    }
+
+    void IndexedNodeHeap::siftDown(int index){
+        int n = heap.size();
+        int left_index, right_index, smallest_index;
+        while (true){
+            left_index = 2*index + 1;
+            right_index = 2*index + 2;
+            smallest_index = index;
+            if ((left_index < n) && node_compare_fcost_obj(heap[left_index], heap[smallest_index])){
+                smallest_index = left_index;
+            }
+            if ((right_index < n) && node_compare_fcost_obj(heap[right_index], heap[smallest_index])){
+                smallest_index = right_index;
+            }
+            if (smallest_index == index){
+                break;
+            }
+            swapNodes(index, smallest_index);
+            index = smallest_index;
+        }
+    }
+
+    void IndexedNodeHeap::swapNodes(const int i, const int j){
+        std::swap(heap[i], heap[j]);
+        heap[i]->open_set_index = i;
+        heap[j]->open_set_index = j;
+    }
+
     XYNode::XYNode(){       
         commonInitialization();
     }
@@ -78,7 +228,7 @@ namespace planner{
         commonInitialization();
         x = x_in;
         y = y_in;
-        key = (to_string(x) + "-" + to_string(y));  
+        computeKey();
     }
 
     void XYNode::commonInitialization(){
@@ -86,7 +236,15 @@ namespace planner{
         y = 0.0;
         g_score = 100000;
         f_score = 100000;
-        key = (to_string(x) + "-" + to_string(y));  
+        computeKey();
+    }
+
+    void XYNode::computeKey(){
+        double factor = 1000000.0;
+        LatticeKeyBuilder key_builder;
+        key_builder.append((long long)round(x*factor), 64);
+        key_builder.append((long long)round(y*factor), 64);
+        key = key_builder.getKey();
     }
 
     XYPlanner::XYPlanner(){ 
@@ -204,8 +362,7 @@ namespace planner{
 
         s = s_in;
         
-
-        key = (to_string((int)round(xLF*1000)) + "_" + to_string((int)round(yLF*1000)) + "_" + to_string((int)round(xRF*1000)) + "_" + to_string((int)round(yRF*1000)) + "_" + to_string(thetaLF) + "_" + to_string(thetaRF) + "_" + (turn) + "_" + to_string(s));  
+        computeKeyFootstep();
     }
 
     void FootstepNode::commonInitializationFootstep(){
@@ -223,8 +380,34 @@ namespace planner{
         s = 0.0;
         step_num = 0;
 
-        key = (to_string((int)round(xLF*1000)) + "_" + to_string((int)round(yLF*1000)) + "_" + to_string((int)round(xRF*1000)) + "_" + to_string((int)round(yRF*1000)) + "_" + to_string(thetaLF) + "_" + to_string(thetaRF) + "_" + (turn) + "_" + to_string(s));  
+        computeKeyFootstep();
+    }
 
+    // Wraps an angle to (-pi, pi]
+    static double wrapAngle(double theta){
+        theta = fmod(theta + M_PI, 2.0*M_PI);
+        if (theta <= 0.0){
+            theta += 2.0*M_PI;
+        }
+        return theta - M_PI;
+    }
+
+    void FootstepNode::computeKeyFootstep(){
+        // Positions are quantized to mm. Angles and s are quantized to 1e-4
+        // Field widths cover positions within 262m, headings wrapped to (-pi, pi] and s < 1.6
+        double pos_factor = 1000.0;
+        double factor = 10000.0;
+        LatticeKeyBuilder key_builder;
+        key_builder.append((long long)round(xLF*pos_factor), 19);
+        key_builder.append((long long)round(yLF*pos_factor), 19);
+        key_builder.append((long long)round(xRF*pos_factor), 19);
+        key_builder.append((long long)round(yRF*pos_factor), 19);
+        // headings accumulate over turning steps
+        key_builder.append((long long)round(wrapAngle(thetaLF)*factor), 17);
+        key_builder.append((long long)round(wrapAngle(thetaRF)*factor), 17);
+        key_builder.append((turn == "LF") ? 1 : 0, 1);
+        key_builder.append((long long)round(s*factor), 15);
+        key = key_builder.getKey();
     }
 
     FootstepPlanner::FootstepPlanner(){ 
@@ -485,6 +668,12 @@ namespace planner{
         return neighbors;
     }
 
+    void A_starPlanner::clearSearchNodes(){
+    }
+
+    void A_starPlanner::releaseNode(const shared_ptr<Node> & node){
+    }
+
     //returns the optimal path
 
     bool A_starPlanner::constructPath(){
@@ -492,7 +681,7 @@ namespace planner{
         optimal_path.clear();
         // Set Current node to the achieved goal
         shared_ptr<Node> current_node = achieved_goal;
-        while (begin->key.compare(current_node->key) != 0) {
+        while (begin->key != current_node->key) {
             optimal_path.push_back(current_node);
             current_node = current_node->parent;    
         }
@@ -554,14 +743,14 @@ namespace planner{
         return result;
     }
     
-    void A_starPlanner::checkSetValidity(const std::set< std::shared_ptr<Node>, NodePtr_Compare_key> & current_set,
+    void A_starPlanner::checkSetValidity(const NodeKeySet & current_set,
                                         const set_type type){
 
         // Initialize candidates list
         std::vector< std::shared_ptr<Node> > candidates;
 
         // For each node in the current set, check if there is a path to the start node
-        for (std::set< std::shared_ptr<Node> >::iterator it = current_set.begin(); it!=current_set.end(); ++it){
+        for (NodeKeySet::const_iterator it = current_set.begin(); it!=current_set.end(); ++it){
            // Assign whether the vertex is in the open set or closed set
             vertexAssignment[*it] = type;
             if (checkPathToStartExists(*it, candidates)){
@@ -600,7 +789,7 @@ namespace planner{
         // For each valid node, add it back to the Open, Explored, and ClosedSets
         for (std::set< std::shared_ptr<Node> >::iterator it = validNodes.begin(); it!=validNodes.end(); ++it){
             if (vertexAssignment[*it] == A_STAR_SET_TYPE_OPEN){
-                OpenSet.push_back(*it);
+                OpenSet.push(*it);
                 ExploredSet.insert(*it);
             }else if (vertexAssignment[*it] == A_STAR_SET_TYPE_CLOSED){
                 ClosedSet.insert(*it);
@@ -617,9 +806,6 @@ namespace planner{
 
     bool A_starPlanner::doAstar(){
         start_time = Clock::now();
-        NodePtr_Compare_key node_ptr_compare_key_obj;
-        NodePtr_Compare_Fcost node_compare_fcost_obj;
-
         //Initialize starting node with g score and f score
         begin->g_score = 0;
         begin->f_score = heuristicCost(begin,goal);
@@ -631,12 +817,12 @@ namespace planner{
         OpenSet.clear();
         ClosedSet.clear();
         ExploredSet.clear();
+        clearSearchNodes();
 
-        std::vector< shared_ptr<Node> >::iterator node_it;
-        std::set< std::shared_ptr<Node> >::iterator es_it;
-        std::set< shared_ptr<Node> >::iterator node_set_it;
+        NodeKeySet::iterator es_it;
+        NodeKeySet::iterator node_set_it;
         
-        OpenSet.push_back(begin); //append starting node to open set
+        OpenSet.push(begin); //append starting node to open set
 
 
         // Create random number generator
@@ -657,10 +843,9 @@ namespace planner{
                     index_offset = u_distribution_int(generator);
                     std:: cout << "    index_offset = " << index_offset << std::endl;
                 }else{
-                    // Perform usual method of obtaining the node from the open set
+                    // Perform usual method of obtaining the node from the open set.
+                    // The top of the heap has the lowest f_score
                     index_offset = 0;
-                    //sort the open set
-                    std::sort(OpenSet.begin(), OpenSet.end(), node_compare_fcost_obj);
                 }
 
                 //choose top value / randomly chosen node of open set as current node;
@@ -708,9 +893,7 @@ namespace planner{
                     }else{
                         // This node will have no neighbors, so perform the necessary set operations and continue
                         //pop current node off the open list
-                        node_it = OpenSet.begin() + index_offset;
-                        *node_it = std::move(OpenSet.back());
-                        OpenSet.pop_back();
+                        OpenSet.remove(index_offset);
                         //Erase node from the explored set
                         ExploredSet.erase(current_node);
                         //insert current node onto closed set
@@ -727,9 +910,7 @@ namespace planner{
                 //current node not equal to goal
 
                 //pop current node off the open list
-                node_it = OpenSet.begin() + index_offset;
-                *node_it = std::move(OpenSet.back());
-                OpenSet.pop_back();
+                OpenSet.remove(index_offset);
 
                 //Erase node from the explored set
                 ExploredSet.erase(current_node);
@@ -765,16 +946,23 @@ namespace planner{
                                 (*es_it)->step_num = neighbors[i]->step_num; 
                                 (*es_it)->g_score = tentative_gscore; 
                                 (*es_it)->f_score = tentative_gscore + heuristicCost(neighbors[i],goal); 
+                                // decrease the key of the node in the open set
+                                OpenSet.update(*es_it);
                             
                             }
+                            // The neighbor is a duplicate of the explored node
+                            releaseNode(neighbors[i]);
 
                         }
                         else{
                             neighbors[i]->g_score = current_node->g_score + gScore(current_node,neighbors[i]);
                             neighbors[i]->f_score = neighbors[i]->g_score + heuristicCost(neighbors[i],goal);
-                            OpenSet.push_back(neighbors[i]);
+                            OpenSet.push(neighbors[i]);
                             ExploredSet.insert(neighbors[i]);
                         }       
+                    }else{
+                        // The neighbor is a duplicate of a closed node
+                        releaseNode(neighbors[i]);
                     }
                 }
             
@@ -0,0 +1,126 @@
+#include <avatar_locomanipulation/planners/feasibility_cache.hpp>
+#include <avatar_locomanipulation/planners/lattice_key.hpp> // mixBits
+#include <cmath>
+#include <iostream>
+#include <iterator>
+
+namespace planner{
+
+    // FeasibilityCacheKey Implementation ------------------------------
+    bool FeasibilityCacheKey::operator==(const FeasibilityCacheKey & rhs) const{
+        return values == rhs.values;
+    }
+
+    std::size_t FeasibilityCacheKeyHash::operator()(const FeasibilityCacheKey & key) const{
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for(std::size_t i = 0; i < key.values.size(); i++){
+            h = mixBits(h ^ static_cast<uint64_t>(key.values[i]));
+        }
+        return static_cast<std::size_t>(h);
+    }
+
+    // FeasibilityCache Implementation ------------------------------
+    FeasibilityCache::FeasibilityCache(){
+        capacity = 100000;
+        resolution = 1e-4;
+        resetCounters();
+    }
+
+    FeasibilityCache::FeasibilityCache(const std::size_t capacity_in, const double resolution_in){
+        capacity = capacity_in;
+        resolution = resolution_in;
+        resetCounters();
+    }
+
+    FeasibilityCache::~FeasibilityCache(){
+    }
+
+    void FeasibilityCache::computeKey(const Eigen::Ref<const Eigen::VectorXd> & raw_datum, FeasibilityCacheKey & key) const{
+        key.values.resize(raw_datum.size());
+        for(int i = 0; i < raw_datum.size(); i++){
+            key.values[i] = static_cast<int64_t>(std::llround(raw_datum[i] / resolution));
+        }
+    }
+
+    bool FeasibilityCache::lookup(const Eigen::Ref<const Eigen::VectorXd> & raw_datum, double & score){
+        computeKey(raw_datum, tmp_key);
+        std::unordered_map<FeasibilityCacheKey, EntryList::iterator, FeasibilityCacheKeyHash>::iterator it = entry_map.find(tmp_key);
+        if (it == entry_map.end()){
+            num_misses++;
+            return false;
+        }
+        // Move the entry to the front
+        entries.splice(entries.begin(), entries, it->second);
+        score = it->second->second;
+        num_hits++;
+        return true;
+    }
+
+    void FeasibilityCache::insert(const Eigen::Ref<const Eigen::VectorXd> & raw_datum, const double score){
+        if (capacity == 0){
+            return;
+        }
+        computeKey(raw_datum, tmp_key);
+        std::unordered_map<FeasibilityCacheKey, EntryList::iterator, FeasibilityCacheKeyHash>::iterator it = entry_map.find(tmp_key);
+        if (it != entry_map.end()){
+            it->second->second = score;
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        // Reuse the least recently used entry when full
+        if (entries.size() >= capacity){
+            entry_map.erase(entries.back().first);
+            entries.splice(entries.begin(), entries, std::prev(entries.end()));
+            entries.front().first.values.swap(tmp_key.values);
+            entries.front().second = score;
+        }else{
+            entries.push_front(std::make_pair(tmp_key, score));
+        }
+        entry_map[entries.front().first] = entries.begin();
+    }
+
+    void FeasibilityCache::setResolution(const double resolution_in){
+        if (resolution_in <= 0.0){
+            std::cerr << "[FeasibilityCache] Error. The resolution must be positive. Got " << resolution_in << std::endl;
+            return;
+        }
+        resolution = resolution_in;
+        clear();
+    }
+
+    void FeasibilityCache::setCapacity(const std::size_t capacity_in){
+        capacity = capacity_in;
+        clear();
+    }
+
+    double FeasibilityCache::getResolution() const{
+        return resolution;
+    }
+
+    std::size_t FeasibilityCache::getCapacity() const{
+        return capacity;
+    }
+
+    void FeasibilityCache::clear(){
+        entries.clear();
+        entry_map.clear();
+    }
+
+    void FeasibilityCache::resetCounters(){
+        num_hits = 0;
+        num_misses = 0;
+    }
+
+    std::size_t FeasibilityCache::size() const{
+        return entries.size();
+    }
+
+    std::size_t FeasibilityCache::getNumHits() const{
+        return num_hits;
+    }
+
+    std::size_t FeasibilityCache::getNumMisses() const{
+        return num_misses;
+    }
+
+}
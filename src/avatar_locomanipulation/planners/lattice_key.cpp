@@ -0,0 +1,105 @@
+#include <avatar_locomanipulation/planners/lattice_key.hpp>
+#include <iostream>
+#include <iomanip>
+
+namespace planner{
+
+    // LatticeKey Implementation ------------------------------
+    LatticeKey::LatticeKey(){
+        words[0] = 0;
+        words[1] = 0;
+    }
+
+    LatticeKey::~LatticeKey(){
+    }
+
+    bool LatticeKey::operator==(const LatticeKey & rhs) const{
+        return (words[0] == rhs.words[0]) && (words[1] == rhs.words[1]);
+    }
+
+    bool LatticeKey::operator!=(const LatticeKey & rhs) const{
+        return !(*this == rhs);
+    }
+
+    bool LatticeKey::operator<(const LatticeKey & rhs) const{
+        if (words[1] != rhs.words[1]){
+            return words[1] < rhs.words[1];
+        }
+        return words[0] < rhs.words[0];
+    }
+
+    std::ostream & operator<<(std::ostream & os, const LatticeKey & key){
+        std::ios::fmtflags flags = os.flags();
+        char fill = os.fill();
+        os << "0x" << std::hex << std::setfill('0') << std::setw(16) << key.words[1] << std::setw(16) << key.words[0];
+        os.flags(flags);
+        os.fill(fill);
+        return os;
+    }
+
+    // LatticeKeyBuilder Implementation ------------------------------
+    LatticeKeyBuilder::LatticeKeyBuilder(){
+        bit_offset = 0;
+    }
+
+    LatticeKeyBuilder::~LatticeKeyBuilder(){
+    }
+
+    bool LatticeKeyBuilder::append(const long long value, const int num_bits){
+        if ((num_bits <= 0) || (num_bits > 64) || (bit_offset + num_bits > 128)){
+            std::cerr << "[LatticeKeyBuilder] Error. Cannot append a " << num_bits << " bit field at bit offset " << bit_offset << std::endl;
+            return false;
+        }
+        // Two's complement range of the field
+        if (num_bits < 64){
+            long long max_value = (1LL << (num_bits - 1)) - 1;
+            if ((value > max_value) || (value < -max_value - 1)){
+                std::cerr << "[LatticeKeyBuilder] Error. Value " << value << " does not fit in a " << num_bits << " bit field" << std::endl;
+                bit_offset += num_bits;
+                return false;
+            }
+        }
+        uint64_t mask = (num_bits == 64) ? ~0ULL : ((1ULL << num_bits) - 1ULL);
+        uint64_t field = static_cast<uint64_t>(value) & mask;
+
+        int word_index = bit_offset / 64;
+        int shift = bit_offset % 64;
+        key.words[word_index] |= (field << shift);
+        // Carry the upper bits of the field over to the next word
+        if ((shift + num_bits > 64) && (word_index == 0)){
+            key.words[1] |= (field >> (64 - shift));
+        }
+        bit_offset += num_bits;
+        return true;
+    }
+
+    const LatticeKey & LatticeKeyBuilder::getKey() const{
+        return key;
+    }
+
+    std::size_t LatticeKeyHash::operator()(const LatticeKey & key) const{
+        return static_cast<std::size_t>(mixBits(key.words[0] ^ mixBits(key.words[1])));
+    }
+
+    // LatticeEdgeKey Implementation ------------------------------
+    LatticeEdgeKey::LatticeEdgeKey(){
+    }
+
+    LatticeEdgeKey::LatticeEdgeKey(const LatticeKey & from_in, const LatticeKey & to_in){
+        from = from_in;
+        to = to_in;
+    }
+
+    LatticeEdgeKey::~LatticeEdgeKey(){
+    }
+
+    bool LatticeEdgeKey::operator==(const LatticeEdgeKey & rhs) const{
+        return (from == rhs.from) && (to == rhs.to);
+    }
+
+    std::size_t LatticeEdgeKeyHash::operator()(const LatticeEdgeKey & key) const{
+        LatticeKeyHash key_hash;
+        return static_cast<std::size_t>(mixBits(key_hash(key.from) + 0x9e3779b97f4a7c15ULL) ^ key_hash(key.to));
+    }
+
+}
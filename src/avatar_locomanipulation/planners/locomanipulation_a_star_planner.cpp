@@ -1,6 +1,25 @@
 #include <avatar_locomanipulation/planners/locomanipulation_a_star_planner.hpp>
+#include <omp.h>
 
 namespace planner{
+  // Configurations of different sizes, e.g. an unverified vertex with an empty q_init, never match
+  static bool sameConfiguration(const Eigen::VectorXd & q_a, const Eigen::VectorXd & q_b){
+    return (q_a.size() == q_b.size()) && (q_a == q_b);
+  }
+
+  static void getParamPos(ParamHandler & param_handler, const std::string & param_name, Eigen::Vector3d & pos){
+    param_handler.getNestedValue({param_name, "x"}, pos[0]);
+    param_handler.getNestedValue({param_name, "y"}, pos[1]);
+    param_handler.getNestedValue({param_name, "z"}, pos[2]);
+  }
+
+  static void getParamOri(ParamHandler & param_handler, const std::string & param_name, Eigen::Quaterniond & ori){
+    param_handler.getNestedValue({param_name, "x"}, ori.x());
+    param_handler.getNestedValue({param_name, "y"}, ori.y());
+    param_handler.getNestedValue({param_name, "z"}, ori.z());
+    param_handler.getNestedValue({param_name, "w"}, ori.w());
+  }
+
   // Constructor
   LMVertex::LMVertex(){
     common_initialization();
@@ -53,22 +72,57 @@ namespace planner{
   void LMVertex::common_initialization(){
     g_score = 100000;
     f_score = 100000;
+    // Pack the quantized s, foot positions and foot yaw angles into the lattice key.
+    // Values are quantized to 1e-3. Field widths cover s < 2, positions within 2km and angles within pi.
     double factor = 1000.0;
-    key = (to_string((int)round(s*factor)) + "/" + "lx:" + to_string((int)round(left_foot.position[0] * factor)) + "-"
-                                                 + "ly:" + to_string((int)round(left_foot.position[1] * factor)) + "-"
-                                                 + "lt:" + to_string((int)round(getAngle(left_foot.orientation) * factor)) + "/"
-                                                 + "rx:" + to_string((int)round(right_foot.position[0] * factor)) + "-"
-                                                 + "ry:" + to_string((int)round(right_foot.position[1] * factor)) + "-"
-                                                 + "rt:" + to_string((int)round(getAngle(right_foot.orientation) * factor))
-          );
-
+    LatticeKeyBuilder key_builder;
+    key_builder.append((long long)round(s*factor), 12);
+    key_builder.append((long long)round(left_foot.position[0] * factor), 22);
+    key_builder.append((long long)round(left_foot.position[1] * factor), 22);
+    key_builder.append((long long)round(getAngle(left_foot.orientation) * factor), 13);
+    key_builder.append((long long)round(right_foot.position[0] * factor), 22);
+    key_builder.append((long long)round(right_foot.position[1] * factor), 22);
+    key_builder.append((long long)round(getAngle(right_foot.orientation) * factor), 13);
+    key = key_builder.getKey();
+  }
 
+  void LMVertex::initialize(double s_in, const Footstep & left_foot_in, const Footstep & right_foot_in){
+    s = s_in;
+    parent.reset();
+    step_num = 0;
+    isStartNode = false;
+    open_set_index = -1;
+    take_a_step = false;
+    feasibility_score = -1.0;
+    // The configuration of the previous vertex stored in this slot must not be mistaken for a verified one
+    q_init.resize(0);
+    left_foot.setPosOriSide(left_foot_in.position, left_foot_in.orientation, left_foot_in.robot_side);
+    right_foot.setPosOriSide(right_foot_in.position, right_foot_in.orientation, right_foot_in.robot_side);
+    // Compute the midfeet based on the left and right feet
+    mid_foot.computeMidfeet(left_foot, right_foot, mid_foot);
+    mid_foot.setMidFoot();
+    common_initialization();
   }
 
   void LMVertex::setRobotConfig(const Eigen::VectorXd & q_input){
     q_init = q_input;
   }
 
+  // EdgeVerificationWorker
+  EdgeVerificationWorker::EdgeVerificationWorker(){}
+
+  EdgeVerificationWorker::EdgeVerificationWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<ManipulationFunction> f_s_in, std::shared_ptr<ConfigTrajectoryGenerator> ctg_in){
+    robot_model = robot_model_in;
+    f_s = f_s_in;
+    ctg = ctg_in;
+  }
+
+  EdgeVerificationWorker::~EdgeVerificationWorker(){}
+
+  // EdgeVerificationResult
+  EdgeVerificationResult::EdgeVerificationResult(){}
+  EdgeVerificationResult::~EdgeVerificationResult(){}
+
   // Constructor
   LocomanipulationPlanner::LocomanipulationPlanner(){
     int num_threads = Eigen::nbThreads();
@@ -290,7 +344,7 @@ namespace planner{
     optimal_path.clear();
     // Set Current node to the achieved goal
     shared_ptr<Node> current_node = achieved_goal;
-    while (begin->key.compare(current_node->key) != 0) {
+    while (begin->key != current_node->key) {
       optimal_path.push_back(current_node);
       current_node = current_node->parent;  
     }
@@ -557,7 +611,7 @@ namespace planner{
 
       // Check if edge has already been computed before
       if (!store_output){
-        std::string edge_key = getEdgeKey(parent_, current_);
+        LatticeEdgeKey edge_key = getEdgeKey(parent_, current_);
         if (edge_to_trajectory.count(edge_key) > 0){
           // If so, get the trajectory
           tmp_traj_q_config = edge_to_trajectory.at(edge_key);
@@ -645,7 +699,7 @@ namespace planner{
               // Store the trajectory to the global path
               tmp_traj_q_config.set_pos(j, q_tmp);    
             }
-            edge_to_trajectory.insert( std::pair<std::string, TrajEuclidean>(getEdgeKey(parent_, current_), tmp_traj_q_config) );
+            edge_to_trajectory.insert( std::pair<LatticeEdgeKey, TrajEuclidean>(getEdgeKey(parent_, current_), tmp_traj_q_config) );
             // ---- Copy Trajectory
         }
 
@@ -866,14 +920,24 @@ namespace planner{
     nn_delta_s =  (to_node->s - from_node->s);
     double s_local_min = 0.0;
 
+    // With the CPP neural network, all s samples are queried in a single forward pass
+    if (enable_cpp_nn){
+      appendHandTrajectoryRows(from_node, to_node, 0);
+      evaluateClassifierRows();
+    }
+
     // For each s, check the neural network for feasibility. 
     for(int i = 0; i < (N_s+1); i++){
       s_local = from_node->s + (static_cast<double>(i)/static_cast<double>(N_s))*nn_delta_s;
-      // Update hand/s pose/s and convert to stance frame
-      setHandPoses(s_local);
 
-      // Query the neural network classifier 
-      nn_prediction_score = getClassifierResult();
+      if (enable_cpp_nn){
+        nn_prediction_score = cpp_nn_batch_pred(i, 0);
+      }else{
+        // Update hand/s pose/s and convert to stance frame
+        setHandPoses(s_local);
+        // Query the neural network classifier 
+        nn_prediction_score = getClassifierResult();
+      }
 
       // Keep track of the lowest result
       if (nn_prediction_score < nn_feasibility_score){
@@ -953,9 +1017,106 @@ namespace planner{
     return nn_feasibility_score;
   }
 
+  int LocomanipulationPlanner::appendHandTrajectoryRows(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node, int row){
+    double s_local = 0.0;
+    nn_delta_s =  (to_node->s - from_node->s);
+    for(int i = 0; i < (N_s+1); i++){
+      s_local = from_node->s + (static_cast<double>(i)/static_cast<double>(N_s))*nn_delta_s;
+      setHandPoses(s_local);
+      setClassifierInputRow(row + i);
+    }
+    return (N_s+1);
+  }
+
+  int LocomanipulationPlanner::appendFeasibilityRows(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node, int row){
+    // Same edge cases as getFeasibility()
+    bool left_step_taken = edgeHasStepTaken(from_node, to_node, LEFT_FOOTSTEP);
+    bool right_step_taken = edgeHasStepTaken(from_node, to_node, RIGHT_FOOTSTEP);
+
+    bool step_taken = left_step_taken || right_step_taken;
+    bool s_var_moved = edgeHasSVarMoved(from_node, to_node);
+
+    int num_rows = 0;
+    if (step_taken){
+      if (left_step_taken){
+        setStanceSwingPelvisNNVariables(from_node, to_node, LEFT_FOOTSTEP);        
+      }else if (right_step_taken){
+        setStanceSwingPelvisNNVariables(from_node, to_node, RIGHT_FOOTSTEP);                
+      }
+      if (!s_var_moved){
+        setHandPoses(from_node->s);
+        setClassifierInputRow(row);
+        num_rows = 1;
+      }else{
+        num_rows = appendHandTrajectoryRows(from_node, to_node, row);
+      }
+    }else if (s_var_moved){
+      // In place right and left footsteps while the hand moves
+      setStanceSwingPelvisNNVariables(from_node, from_node, RIGHT_FOOTSTEP);        
+      num_rows = appendHandTrajectoryRows(from_node, to_node, row);
+      setStanceSwingPelvisNNVariables(from_node, from_node, LEFT_FOOTSTEP);
+      num_rows += appendHandTrajectoryRows(from_node, to_node, row + num_rows);
+    }else{
+      std::cout << "Error. No step has been taken and the s variable did not move. Something must be wrong with the neighbor generation or the edge type transition checks " << std::endl;
+    }
+    return num_rows;
+  }
+
+  void LocomanipulationPlanner::computeNeighborFeasibilities(){
+    shared_ptr<LMVertex> neighbor_vertex;
+    // The ROS classifier service takes one datum per call
+    if (!enable_cpp_nn){
+      for(int i = 0; i < neighbors.size(); i++){
+        neighbor_vertex = static_pointer_cast<LMVertex>(neighbors[i]);
+        neighbor_vertex->feasibility_score = getFeasibility(current_, neighbor_vertex);
+      }
+      return;
+    }
+
+    // Assemble the queries of every neighbor edge into one input matrix
+    neighbor_row_offsets.resize(neighbors.size() + 1);
+    int num_rows = 0;
+    for(int i = 0; i < neighbors.size(); i++){
+      neighbor_row_offsets[i] = num_rows;
+      num_rows += appendFeasibilityRows(current_, static_pointer_cast<LMVertex>(neighbors[i]), num_rows);
+    }
+    neighbor_row_offsets[neighbors.size()] = num_rows;
+    evaluateClassifierRows();
+
+    // The feasibility of an edge is its lowest score
+    double score;
+    for(int i = 0; i < neighbors.size(); i++){
+      score = 1.0;
+      for(int j = neighbor_row_offsets[i]; j < neighbor_row_offsets[i+1]; j++){
+        if (cpp_nn_batch_pred(j, 0) < score){
+          score = cpp_nn_batch_pred(j, 0);
+        }
+      }
+      static_pointer_cast<LMVertex>(neighbors[i])->feasibility_score = score;
+    }
+  }
+
+  void LocomanipulationPlanner::filterInfeasibleNeighbors(){
+    computeNeighborFeasibilities();
+    // Keep the neighbors within the threshold in their generation order
+    int num_feasible = 0;
+    shared_ptr<LMVertex> neighbor_vertex;
+    for(int i = 0; i < neighbors.size(); i++){
+      neighbor_vertex = static_pointer_cast<LMVertex>(neighbors[i]);
+      if (neighbor_vertex->feasibility_score < feasibility_threshold){
+        vertex_arena.release(neighbor_vertex.get());
+        continue;
+      }
+      neighbors[num_feasible] = neighbors[i];
+      num_feasible++;
+    }
+    neighbors.resize(num_feasible);
+  }
+
 
   void LocomanipulationPlanner::setClassifierClient(ros::ServiceClient & classifier_client_in){
     classifier_client = classifier_client_in;
+    feasibility_cache.clear();
     print_classifier_results = true;
     use_classifier = true;
   }
@@ -972,6 +1133,47 @@ namespace planner{
     cpp_nn_input_size = 1;
     cpp_nn_data_input = Eigen::MatrixXd::Zero(cpp_nn_input_size, 32);
     cpp_nn_pred = Eigen::MatrixXd::Zero(cpp_nn_input_size,1);
+    cpp_nn_batch_pred = Eigen::MatrixXd::Zero(N_s+1, 1);
+    cpp_nn_batch_input = Eigen::MatrixXd::Zero(N_s+1, 32);
+    cpp_nn_batch_raw = Eigen::MatrixXd::Zero(32, N_s+1);
+    cpp_nn_batch_input_pred = Eigen::MatrixXd::Zero(N_s+1, 1);
+    cpp_nn_batch_rows.resize(N_s+1);
+    cpp_nn_num_pending_rows = 0;
+
+    feasibility_cache.clear();
+  }
+
+  void LocomanipulationPlanner::setNeuralNetworkPrecision(InferencePrecision precision){
+    if (nn_model == nullptr){
+      std::cout << "[LocomanipulationPlanner] Error. setNeuralNetwork() must be called before setting the inference precision" << std::endl;
+      return;
+    }
+    nn_model->SetInferencePrecision(precision);
+    // Stored scores were computed with the previous precision
+    feasibility_cache.clear();
+    std::cout << "[LocomanipulationPlanner] Neural network inference precision: " << nn_model->GetInferencePrecision() << std::endl;
+  }
+
+  bool LocomanipulationPlanner::calibrateNeuralNetwork(const std::vector<std::string> & transition_data_files){
+    if (nn_model == nullptr){
+      std::cout << "[LocomanipulationPlanner] Error. setNeuralNetwork() must be called before the calibration" << std::endl;
+      return false;
+    }
+    Eigen::MatrixXd calibration_data(transition_data_files.size(), 32);
+    int num_data = 0;
+    for(int i = 0; i < transition_data_files.size(); i++){
+      if (loadTransitionDatum(transition_data_files[i])){
+        calibration_data.row(num_data) = cpp_nn_normalized_datum.transpose();
+        num_data++;
+      }
+    }
+    if (num_data == 0){
+      std::cout << "[LocomanipulationPlanner] Error. No transition data could be loaded for the neural network calibration" << std::endl;
+      return false;
+    }
+    std::cout << "[LocomanipulationPlanner] Calibrating the neural network with " << num_data << " transitions" << std::endl;
+    nn_model->Calibrate(calibration_data.topRows(num_data));
+    return true;
   }
 
   // Locomanipulation gscore
@@ -1032,7 +1234,12 @@ namespace planner{
     double feasibility_cost = 0.0; 
     
     if ((use_classifier) && (!classifier_lazy_evaluate)){
-      feasibility_cost =  w_feasibility*(1.0 - getFeasibility(current_, neighbor_));      
+      // Reuse the score computed when the neighbor was generated
+      if ((neighbor_->parent == current) && (neighbor_->feasibility_score >= 0.0)){
+        feasibility_cost =  w_feasibility*(1.0 - neighbor_->feasibility_score);
+      }else{
+        feasibility_cost =  w_feasibility*(1.0 - getFeasibility(current_, neighbor_));      
+      }
     }
 
     double delta_g = s_cost + distance_cost + step_cost + transition_distance_cost + feasibility_cost;
@@ -1119,10 +1326,7 @@ namespace planner{
         //                                                             parent_->s, delta_s, 
         //                                                             parent_->q_init, 
         //                                                            input_footstep_list);
-        convergence = ctg->computeConfigurationTrajectory(f_s,  
-                                                          parent_->s, delta_s, 
-                                                          parent_->q_init, 
-                                                          input_footstep_list);
+        convergence = verifyCurrentEdge();
 
         // if store mistakes
         if ((use_classifier) && (classifier_store_mistakes)){
@@ -1140,7 +1344,7 @@ namespace planner{
         }
 
         if (convergence){
-          ctg->traj_q_config.get_pos(ctg->getDiscretizationSize() - 1, q_tmp);
+          tmp_traj_q_config.get_pos(ctg->getDiscretizationSize() - 1, q_tmp);
           // std::cout << "goal q_tmp = " << q_tmp.transpose() << std::endl;
           current_->setRobotConfig(q_tmp);       
         }
@@ -1215,23 +1419,15 @@ namespace planner{
      // Create the neighbor only if the proposed s is not close to 0.0.
       if ( fabs(delta_s_vals[i]) > 1e-6){
         // ensure that s is bounded between 0 and 1.
-        shared_ptr<Node> neighbor (std::make_shared<LMVertex>( clamp_s_variable(current_->s + delta_s_vals[i]), current_->left_foot, current_->right_foot));
+        LMVertex* neighbor_vertex = vertex_arena.allocate();
+        neighbor_vertex->initialize(clamp_s_variable(current_->s + delta_s_vals[i]), current_->left_foot, current_->right_foot);
+        shared_ptr<Node> neighbor = vertex_arena.getHandle<Node>(neighbor_vertex);
         // Update the neighbor (probably make this a function to call)
         neighbor_change = static_pointer_cast<LMVertex>(neighbor);
         neighbor_change->parent = static_pointer_cast<Node>(current_);
         // neighbor = static_pointer_cast<Node>(neighbor_change);
 
-        // TODO: Add feasibility check here and only add to neighbors if it's greater than our threshold
-
-
-        if ((use_classifier) && (!classifier_lazy_evaluate)) {
-          // Skip this neighbor if it is not within the threshold
-          double feas_score = getFeasibility(current_, neighbor_change);
-          if (feas_score < feasibility_threshold){
-            continue;
-          }
-        }
-
+        // Feasibility of non-lazy evaluation is checked for all neighbors at once in filterInfeasibleNeighbors()
         neighbors.push_back(neighbor);
       }
     }
@@ -1322,31 +1518,23 @@ namespace planner{
 
 
 
-              shared_ptr<Node> neighbor;
+              LMVertex* neighbor_vertex = vertex_arena.allocate();
               // Landing foot should go to the correct footstep. the stance foot remains unchanged
               if (footstep_side == RIGHT_FOOTSTEP){
-                 neighbor = std::make_shared<LMVertex>(clamp_s_variable(current_->s + delta_s_vals[i]), 
+                 neighbor_vertex->initialize(clamp_s_variable(current_->s + delta_s_vals[i]), 
                                                                       current_->left_foot, 
                                                                       landing_foot);
               }else{
-                 neighbor = std::make_shared<LMVertex>(clamp_s_variable(current_->s + delta_s_vals[i]), 
+                 neighbor_vertex->initialize(clamp_s_variable(current_->s + delta_s_vals[i]), 
                                                                       landing_foot,
                                                                       current_->right_foot);
               }
+              shared_ptr<Node> neighbor = vertex_arena.getHandle<Node>(neighbor_vertex);
               // Update the neighbor's parent
               neighbor_change = static_pointer_cast<LMVertex>(neighbor);
               neighbor_change->parent = static_pointer_cast<Node>(current_);
 
-              // TODO: Add feasibility check here and only add to neighbors if it's greater than our threshold
-              if ((use_classifier) && (!classifier_lazy_evaluate)) {
-                // Skip this neighbor if it is not within the threshold
-                double feas_score = getFeasibility(current_, neighbor_change);
-                if (feas_score < feasibility_threshold){
-                  continue;
-                }
-              }
-
-              // Add landing foot 
+              // Add landing foot. Feasibility of non-lazy evaluation is checked in filterInfeasibleNeighbors()
               neighbors.push_back(neighbor);
 
               // Increment counter
@@ -1412,10 +1600,7 @@ namespace planner{
         //                                                             parent_->s, delta_s, 
         //                                                             parent_->q_init, 
         //                                                             input_footstep_list);
-        convergence = ctg->computeConfigurationTrajectory(f_s,  
-                                                          parent_->s, delta_s, 
-                                                          parent_->q_init, 
-                                                          input_footstep_list);
+        convergence = verifyCurrentEdge();
 
         edgeFeasibilityTimeStop();
         std::cout << "  Converged: " << (convergence ? "True" : "False") << std::endl;       
@@ -1442,19 +1627,10 @@ namespace planner{
         // If it converges, update the configuration of the current node
         if (convergence){
           // Store config for this edge 
-          // --- Copy Trajectory
-          int N_size = ctg->getDiscretizationSize();
-          for(int j = 0; j < N_size; j++){
-            // Get the configuration at this local trajectory
-            ctg->traj_q_config.get_pos(j, q_tmp);
-            // Store the trajectory to the global path
-            tmp_traj_q_config.set_pos(j, q_tmp);    
-          }
-          edge_to_trajectory.insert( std::pair<std::string, TrajEuclidean>(getEdgeKey(parent_, current_), tmp_traj_q_config) );
-          // ---- Copy Trajectory
+          edge_to_trajectory.insert( std::pair<LatticeEdgeKey, TrajEuclidean>(getEdgeKey(parent_, current_), tmp_traj_q_config) );
 
           // Get the final configuration.
-          ctg->traj_q_config.get_pos(ctg->getDiscretizationSize() - 1, q_tmp);
+          tmp_traj_q_config.get_pos(ctg->getDiscretizationSize() - 1, q_tmp);
           // std::cout << "q_tmp = " << q_tmp.transpose() << std::endl;
           current_->setRobotConfig(q_tmp);
         }else{
@@ -1475,6 +1651,9 @@ namespace planner{
       generateFootstepNeighbors(LEFT_FOOTSTEP);
       std::cout << " -- gen. right footstep neighbors --" << std::endl;
       generateFootstepNeighbors(RIGHT_FOOTSTEP);
+      if ((use_classifier) && (!classifier_lazy_evaluate)){
+        filterInfeasibleNeighbors();
+      }
       std::cout << "num neighbors generated: " << neighbors.size() << std::endl;
 
       return neighbors;
@@ -1499,12 +1678,59 @@ namespace planner{
       std::cout << " -- gen. right footstep neighbors --" << std::endl;
       generateFootstepNeighbors(RIGHT_FOOTSTEP);
     }
+    if ((use_classifier) && (!classifier_lazy_evaluate)){
+      filterInfeasibleNeighbors();
+    }
     std::cout << "num neighbors generated: " << neighbors.size() << std::endl;
 
 
     return neighbors;
   }
 
+  void LocomanipulationPlanner::clearSearchNodes(){
+    // The previous result stays valid after the arena is reset
+    detachResultNodes();
+    vertex_arena.reset();
+    prefetched_edges.clear();
+    // The ctg settings may change between searches
+    edge_worker_settings_synced = false;
+    if (use_classifier && use_feasibility_cache){
+      std::cout << "[LocomanipulationPlanner] Feasibility cache: " << feasibility_cache.getNumHits() << " hits, " 
+                << feasibility_cache.getNumMisses() << " misses, " << feasibility_cache.size() << " entries" << std::endl;
+    }
+  }
+
+  void LocomanipulationPlanner::releaseNode(const shared_ptr<Node> & node){
+    vertex_arena.release(static_cast<LMVertex*>(node.get()));
+  }
+
+  void LocomanipulationPlanner::detachResultNodes(){
+    // Arena vertex -> owned copy. The parents of the copies point to the copies of the parents.
+    std::map<Node*, shared_ptr<Node> > copies;
+    std::vector< shared_ptr<Node>* > results;
+    for(int i = 0; i < optimal_path.size(); i++){
+      results.push_back(&optimal_path[i]);
+    }
+    for(int i = 0; i < forward_order_optimal_path.size(); i++){
+      results.push_back(&forward_order_optimal_path[i]);
+    }
+    results.push_back(&achieved_goal);
+
+    for(int i = 0; i < results.size(); i++){
+      // Copy the vertex and its arena ancestors
+      std::vector< shared_ptr<Node>* > chain;
+      for(shared_ptr<Node>* link = results[i]; vertex_arena.owns(static_cast<LMVertex*>(link->get())); link = &(copies[link->get()]->parent)){
+        if (copies.count(link->get()) == 0){
+          copies[link->get()] = std::allocate_shared<LMVertex>(Eigen::aligned_allocator<LMVertex>(), *static_cast<LMVertex*>(link->get()));
+        }
+        chain.push_back(link);
+      }
+      for(int j = chain.size() - 1; j >= 0; j--){
+        *chain[j] = copies[chain[j]->get()];
+      }
+    }
+  }
+
   // Print the node path
   void LocomanipulationPlanner::printPath(){
   }
@@ -1592,58 +1818,136 @@ namespace planner{
   }
 
 
+  void LocomanipulationPlanner::computeClassifierDatum(){
+    // std::cout << "constructing input" << std::endl;
+    // Construct the input to the neural network
+    // Stance and Manipulation Type
+    cpp_nn_rawDatum[0] = nn_stance_origin;
+    cpp_nn_rawDatum[1] = nn_manipulation_type;
+    // Swing Foot Pos, Ori
+    cpp_nn_rawDatum[2] = nn_swing_foot_start_pos[0];
+    cpp_nn_rawDatum[3] = nn_swing_foot_start_pos[1];
+    cpp_nn_rawDatum[4] = nn_swing_foot_start_pos[2];
+    tmp_ori_vec3 = quatToVec(nn_swing_foot_start_ori);
+    cpp_nn_rawDatum[5] = tmp_ori_vec3[0];
+    cpp_nn_rawDatum[6] = tmp_ori_vec3[1];
+    cpp_nn_rawDatum[7] = tmp_ori_vec3[2];
+    // Pelvis Pos, Ori
+    cpp_nn_rawDatum[8] = nn_pelvis_pos[0];
+    cpp_nn_rawDatum[9] = nn_pelvis_pos[1];
+    cpp_nn_rawDatum[10] = nn_pelvis_pos[2];
+    tmp_ori_vec3 = quatToVec(nn_pelvis_ori);
+    cpp_nn_rawDatum[11] = tmp_ori_vec3[0];
+    cpp_nn_rawDatum[12] = tmp_ori_vec3[1];
+    cpp_nn_rawDatum[13] = tmp_ori_vec3[2];
+    // Landing Foot Pos, Ori
+    cpp_nn_rawDatum[14] = nn_landing_foot_pos[0];
+    cpp_nn_rawDatum[15] = nn_landing_foot_pos[1];
+    cpp_nn_rawDatum[16] = nn_landing_foot_pos[2];
+    tmp_ori_vec3 = quatToVec(nn_landing_foot_ori);
+    cpp_nn_rawDatum[17] = tmp_ori_vec3[0];
+    cpp_nn_rawDatum[18] = tmp_ori_vec3[1];
+    cpp_nn_rawDatum[19] = tmp_ori_vec3[2];
+    // Right Hand Pos Ori
+    cpp_nn_rawDatum[20] = nn_right_hand_start_pos[0];
+    cpp_nn_rawDatum[21] = nn_right_hand_start_pos[1];
+    cpp_nn_rawDatum[22] = nn_right_hand_start_pos[2];
+    tmp_ori_vec3 = quatToVec(nn_right_hand_start_ori);
+    cpp_nn_rawDatum[23] = tmp_ori_vec3[0];
+    cpp_nn_rawDatum[24] = tmp_ori_vec3[1];
+    cpp_nn_rawDatum[25] = tmp_ori_vec3[2];
+    // Left Hand Pos Ori
+    cpp_nn_rawDatum[26] = nn_left_hand_start_pos[0];
+    cpp_nn_rawDatum[27] = nn_left_hand_start_pos[1];
+    cpp_nn_rawDatum[28] = nn_left_hand_start_pos[2];
+    tmp_ori_vec3 = quatToVec(nn_left_hand_start_ori);
+    cpp_nn_rawDatum[29] = tmp_ori_vec3[0];
+    cpp_nn_rawDatum[30] = tmp_ori_vec3[1];
+    cpp_nn_rawDatum[31] = tmp_ori_vec3[2];
+  
+    // std::cout << "normalizing input input" << std::endl;
+    // Normalize the input  
+    normalizeInputCalculate(cpp_nn_rawDatum, nn_mean, nn_std, cpp_nn_normalized_datum);
+  }
+
+  bool LocomanipulationPlanner::loadTransitionDatum(const std::string & filepath){
+    ParamHandler param_handler;
+    param_handler.load_yaml_file(filepath);
+
+    std::string stance_origin, manipulation_type;
+    if (!(param_handler.getString("stance_origin", stance_origin) && param_handler.getString("manipulation_type", manipulation_type))){
+      std::cout << "[LocomanipulationPlanner] Error. " << filepath << " is not a transition data file" << std::endl;
+      return false;
+    }
+    nn_stance_origin = (stance_origin.compare("left_foot") == 0) ? CONTACT_TRANSITION_DATA_LEFT_FOOT_STANCE : CONTACT_TRANSITION_DATA_RIGHT_FOOT_STANCE;
+    nn_manipulation_type = CONTACT_TRANSITION_DATA_RIGHT_HAND;
+    if (manipulation_type.compare("left_hand") == 0){
+      nn_manipulation_type = CONTACT_TRANSITION_DATA_LEFT_HAND;
+    }else if (manipulation_type.compare("both_hands") == 0){
+      nn_manipulation_type = CONTACT_TRANSITION_DATA_BOTH_HANDS;
+    }
+
+    getParamPos(param_handler, "swing_foot_starting_position", nn_swing_foot_start_pos);
+    getParamOri(param_handler, "swing_foot_starting_orientation", nn_swing_foot_start_ori);
+    getParamPos(param_handler, "pelvis_starting_position", nn_pelvis_pos);
+    getParamOri(param_handler, "pelvis_starting_orientation", nn_pelvis_ori);
+    getParamPos(param_handler, "landing_foot_position", nn_landing_foot_pos);
+    getParamOri(param_handler, "landing_foot_orientation", nn_landing_foot_ori);
+    getParamPos(param_handler, "right_hand_starting_position", nn_right_hand_start_pos);
+    getParamOri(param_handler, "right_hand_starting_orientation", nn_right_hand_start_ori);
+    getParamPos(param_handler, "left_hand_starting_position", nn_left_hand_start_pos);
+    getParamOri(param_handler, "left_hand_starting_orientation", nn_left_hand_start_ori);
+
+    computeClassifierDatum();
+    return true;
+  }
+
+  void LocomanipulationPlanner::setClassifierInputRow(int row){
+    computeClassifierDatum();
+    if (row >= cpp_nn_batch_pred.rows()){
+      cpp_nn_batch_pred.conservativeResize(std::max(row + 1, 2*static_cast<int>(cpp_nn_batch_pred.rows())), 1);
+    }
+    if (use_feasibility_cache && feasibility_cache.lookup(cpp_nn_rawDatum, cpp_nn_batch_pred(row, 0))){
+      return;
+    }
+
+    // Queue the row for the forward pass
+    int k = cpp_nn_num_pending_rows;
+    if (k >= cpp_nn_batch_input.rows()){
+      int num_rows = std::max(k + 1, 2*static_cast<int>(cpp_nn_batch_input.rows()));
+      cpp_nn_batch_input.conservativeResize(num_rows, cpp_nn_batch_input.cols());
+      cpp_nn_batch_raw.conservativeResize(cpp_nn_batch_raw.rows(), num_rows);
+      cpp_nn_batch_input_pred.resize(num_rows, 1);
+      cpp_nn_batch_rows.resize(num_rows);
+    }
+    cpp_nn_batch_input.row(k) = cpp_nn_normalized_datum;
+    cpp_nn_batch_raw.col(k) = cpp_nn_rawDatum;
+    cpp_nn_batch_rows[k] = row;
+    cpp_nn_num_pending_rows++;
+  }
+
+  void LocomanipulationPlanner::evaluateClassifierRows(){
+    int num_pending = cpp_nn_num_pending_rows;
+    cpp_nn_num_pending_rows = 0;
+    if (num_pending == 0){
+      return;
+    }
+    nn_model->Infer(cpp_nn_batch_input.topRows(num_pending), cpp_nn_batch_input_pred.topRows(num_pending));
+    for(int k = 0; k < num_pending; k++){
+      cpp_nn_batch_pred(cpp_nn_batch_rows[k], 0) = cpp_nn_batch_input_pred(k, 0);
+      if (use_feasibility_cache){
+        feasibility_cache.insert(cpp_nn_batch_raw.col(k), cpp_nn_batch_input_pred(k, 0));
+      }
+    }
+  }
+
   double LocomanipulationPlanner::getClassifierResult(){
     // Using CPP neural network
     if (enable_cpp_nn){
-      // std::cout << "constructing input" << std::endl;
-      // Construct the input to the neural network
-      // Stance and Manipulation Type
-      cpp_nn_rawDatum[0] = nn_stance_origin;
-      cpp_nn_rawDatum[1] = nn_manipulation_type;
-      // Swing Foot Pos, Ori
-      cpp_nn_rawDatum[2] = nn_swing_foot_start_pos[0];
-      cpp_nn_rawDatum[3] = nn_swing_foot_start_pos[1];
-      cpp_nn_rawDatum[4] = nn_swing_foot_start_pos[2];
-      tmp_ori_vec3 = quatToVec(nn_swing_foot_start_ori);
-      cpp_nn_rawDatum[5] = tmp_ori_vec3[0];
-      cpp_nn_rawDatum[6] = tmp_ori_vec3[1];
-      cpp_nn_rawDatum[7] = tmp_ori_vec3[2];
-      // Pelvis Pos, Ori
-      cpp_nn_rawDatum[8] = nn_pelvis_pos[0];
-      cpp_nn_rawDatum[9] = nn_pelvis_pos[1];
-      cpp_nn_rawDatum[10] = nn_pelvis_pos[2];
-      tmp_ori_vec3 = quatToVec(nn_pelvis_ori);
-      cpp_nn_rawDatum[11] = tmp_ori_vec3[0];
-      cpp_nn_rawDatum[12] = tmp_ori_vec3[1];
-      cpp_nn_rawDatum[13] = tmp_ori_vec3[2];
-      // Landing Foot Pos, Ori
-      cpp_nn_rawDatum[14] = nn_landing_foot_pos[0];
-      cpp_nn_rawDatum[15] = nn_landing_foot_pos[1];
-      cpp_nn_rawDatum[16] = nn_landing_foot_pos[2];
-      tmp_ori_vec3 = quatToVec(nn_landing_foot_ori);
-      cpp_nn_rawDatum[17] = tmp_ori_vec3[0];
-      cpp_nn_rawDatum[18] = tmp_ori_vec3[1];
-      cpp_nn_rawDatum[19] = tmp_ori_vec3[2];
-      // Right Hand Pos Ori
-      cpp_nn_rawDatum[20] = nn_right_hand_start_pos[0];
-      cpp_nn_rawDatum[21] = nn_right_hand_start_pos[1];
-      cpp_nn_rawDatum[22] = nn_right_hand_start_pos[2];
-      tmp_ori_vec3 = quatToVec(nn_right_hand_start_ori);
-      cpp_nn_rawDatum[23] = tmp_ori_vec3[0];
-      cpp_nn_rawDatum[24] = tmp_ori_vec3[1];
-      cpp_nn_rawDatum[25] = tmp_ori_vec3[2];
-      // Left Hand Pos Ori
-      cpp_nn_rawDatum[26] = nn_left_hand_start_pos[0];
-      cpp_nn_rawDatum[27] = nn_left_hand_start_pos[1];
-      cpp_nn_rawDatum[28] = nn_left_hand_start_pos[2];
-      tmp_ori_vec3 = quatToVec(nn_left_hand_start_ori);
-      cpp_nn_rawDatum[29] = tmp_ori_vec3[0];
-      cpp_nn_rawDatum[30] = tmp_ori_vec3[1];
-      cpp_nn_rawDatum[31] = tmp_ori_vec3[2];
-  
-      // std::cout << "normalizing input input" << std::endl;
-      // Normalize the input  
-      normalizeInputCalculate(cpp_nn_rawDatum, nn_mean, nn_std, cpp_nn_normalized_datum);
+      computeClassifierDatum();
+      if (use_feasibility_cache && feasibility_cache.lookup(cpp_nn_rawDatum, prediction_result)){
+        return prediction_result;
+      }
 
       // std::cout << "placing to a row" << std::endl;      
       // Put normalized datum as part of the neural net input matrix
@@ -1651,10 +1955,13 @@ namespace planner{
         cpp_nn_data_input.row(i) = cpp_nn_normalized_datum;
       }
 
-      cpp_nn_pred = nn_model->GetOutput(cpp_nn_data_input);
+      nn_model->Infer(cpp_nn_data_input, cpp_nn_pred);
       // Get the first result only
       prediction_result = cpp_nn_pred(0,0);
       // std::cout << "Prediction: " << prediction_result << std::endl;
+      if (use_feasibility_cache){
+        feasibility_cache.insert(cpp_nn_rawDatum, prediction_result);
+      }
       return prediction_result;
 
     }else{
@@ -1669,6 +1976,12 @@ namespace planner{
                                                 nn_landing_foot_pos, nn_landing_foot_ori,
                                                 nn_right_hand_start_pos, nn_right_hand_start_ori,
                                                 nn_left_hand_start_pos, nn_left_hand_start_ori);
+      // Skip the service round trip if this input has already been queried
+      Eigen::Map<const Eigen::VectorXd> classifier_x(classifier_srv.request.x.data(), classifier_srv.request.x.size());
+      if (use_feasibility_cache && feasibility_cache.lookup(classifier_x, prediction_result)){
+        return prediction_result;
+      }
+
       // Reset prediction result to a negative value
       prediction_result = -1.0;
       
@@ -1691,6 +2004,10 @@ namespace planner{
 
       }
 
+      if (use_feasibility_cache){
+        feasibility_cache.insert(classifier_x, prediction_result);
+      }
+
 
       return prediction_result;
     }
@@ -1768,8 +2085,162 @@ namespace planner{
     file_output_stream << out.c_str(); 
   }
 
-  std::string LocomanipulationPlanner::getEdgeKey(shared_ptr<LMVertex> from_node, shared_ptr<LMVertex> to_node){
-    return from_node->key + "_" + to_node->key;
+  LatticeEdgeKey LocomanipulationPlanner::getEdgeKey(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node){
+    return LatticeEdgeKey(from_node->key, to_node->key);
+  }
+
+  void LocomanipulationPlanner::getEdgeFootstepList(const shared_ptr<LMVertex> & from_node, const shared_ptr<LMVertex> & to_node, std::vector<Footstep> & footstep_list){
+    footstep_list.clear();
+    if (edgeHasStepTaken(from_node, to_node, LEFT_FOOTSTEP)) {
+      footstep_list.push_back(to_node->left_foot);
+    }else if (edgeHasStepTaken(from_node, to_node, RIGHT_FOOTSTEP)){
+      footstep_list.push_back(to_node->right_foot);        
+    }
+  }
+
+  void LocomanipulationPlanner::addEdgeVerificationWorker(std::shared_ptr<RobotModel> robot_model_in, std::shared_ptr<ManipulationFunction> f_s_in, std::shared_ptr<ConfigTrajectoryGenerator> ctg_in){
+    // Worker trajectories are copied into tmp_traj_q_config and must have the same size
+    ctg_in->initializeDiscretization(N_size_per_edge);
+    edge_workers.push_back(EdgeVerificationWorker(robot_model_in, f_s_in, ctg_in));
+    edge_worker_settings_synced = false;
+    std::cout << "[LocomanipulationPlanner] Added edge verification worker " << edge_workers.size() << std::endl;
+  }
+
+  void LocomanipulationPlanner::setNumEdgeVerificationWorkers(int num_workers){
+    edge_workers.clear();
+    prefetched_edges.clear();
+    if ((robot_model == nullptr) || (f_s == nullptr) || (ctg == nullptr)){
+      std::cout << "[LocomanipulationPlanner] Error. initializeLocomanipulationVariables() must be called before setting the edge verification workers" << std::endl;
+      parallel_edge_verification = false;
+      return;
+    }
+    // Each worker has its own model workspace, manipulation function interpolators, and IK modules
+    for(int i = 0; i < num_workers; i++){
+      std::shared_ptr<RobotModel> worker_model(new RobotModelContext(robot_model));
+      std::shared_ptr<ConfigTrajectoryGenerator> worker_ctg(new ConfigTrajectoryGenerator(worker_model, N_size_per_edge));
+      addEdgeVerificationWorker(worker_model, f_s->clone(), worker_ctg);
+    }
+    parallel_edge_verification = (num_workers > 1);
+    std::cout << "[LocomanipulationPlanner] Parallel edge verification: " << (parallel_edge_verification ? "True" : "False") << std::endl;
+  }
+
+  void LocomanipulationPlanner::syncEdgeWorkerSettings(){
+    // Every worker is configured from the same snapshot of the ctg settings
+    ConfigTrajectorySettings settings = ctg->getSettings();
+    for(int i = 0; i < edge_workers.size(); i++){
+      edge_workers[i].ctg->applySettings(settings);
+    }
+    edge_worker_settings_synced = true;
+  }
+
+  bool LocomanipulationPlanner::verifyCurrentEdge(){
+    if (parallel_edge_verification && (edge_workers.size() > 0)){
+      prefetchEdgeVerifications();
+    }
+    return verifyEdge();
+  }
+
+  bool LocomanipulationPlanner::verifyEdge(){
+    std::unordered_map<LatticeEdgeKey, EdgeVerificationResult, LatticeEdgeKeyHash>::iterator it = prefetched_edges.find(getEdgeKey(parent_, current_));
+    if (it != prefetched_edges.end()){
+      // The parent configuration must match. Otherwise the parent was reached through a different path.
+      bool convergence = it->second.convergence;
+      bool valid_result = sameConfiguration(it->second.q_start, parent_->q_init);
+      if (valid_result && convergence){
+        int N_size = ctg->getDiscretizationSize();
+        for(int j = 0; j < N_size; j++){
+          it->second.traj_q_config.get_pos(j, q_tmp);
+          tmp_traj_q_config.set_pos(j, q_tmp);
+        }
+      }
+      prefetched_edges.erase(it);
+      if (valid_result){
+        return convergence;
+      }
+    }
+
+    bool convergence = ctg->computeConfigurationTrajectory(f_s,  
+                                                           parent_->s, delta_s, 
+                                                           parent_->q_init, 
+                                                           input_footstep_list);
+    if (convergence){
+      // --- Copy Trajectory
+      int N_size = ctg->getDiscretizationSize();
+      for(int j = 0; j < N_size; j++){
+        // Get the configuration at this local trajectory
+        ctg->traj_q_config.get_pos(j, q_tmp);
+        // Store the trajectory to the global path
+        tmp_traj_q_config.set_pos(j, q_tmp);    
+      }
+      // ---- Copy Trajectory
+    }
+    return convergence;
+  }
+
+  void LocomanipulationPlanner::prefetchEdgeVerifications(){
+    // Candidates are the current vertex followed by the open set vertices most likely to be expanded next.
+    // Vertices whose edge has already been verified from the same parent configuration are skipped.
+    OpenSet.getTopNodes(num_parallel_edge_candidates - 1, edge_candidates);
+    edge_candidates.insert(edge_candidates.begin(), current_);
+
+    int num_candidates = 0;
+    shared_ptr<LMVertex> candidate, candidate_parent;
+    std::unordered_map<LatticeEdgeKey, EdgeVerificationResult, LatticeEdgeKeyHash>::iterator it;
+    for(int i = 0; i < edge_candidates.size(); i++){
+      candidate = static_pointer_cast<LMVertex>(edge_candidates[i]);
+      candidate_parent = static_pointer_cast<LMVertex>(candidate->parent);
+      // The edge of a vertex whose parent is not verified yet cannot be evaluated
+      if ((candidate_parent == nullptr) || (candidate_parent->q_init.size() == 0)){
+        continue;
+      }
+      it = prefetched_edges.find(getEdgeKey(candidate_parent, candidate));
+      if ((it != prefetched_edges.end()) && sameConfiguration(it->second.q_start, candidate_parent->q_init)){
+        continue;
+      }
+      edge_candidates[num_candidates] = candidate;
+      num_candidates++;
+    }
+    edge_candidates.resize(num_candidates);
+    if (num_candidates == 0){
+      return;
+    }
+
+    // Inputs are prepared serially. edgeHasStepTaken() uses member temporaries.
+    edge_candidate_results.resize(num_candidates);
+    edge_candidate_footsteps.resize(num_candidates);
+    for(int i = 0; i < num_candidates; i++){
+      candidate = static_pointer_cast<LMVertex>(edge_candidates[i]);
+      candidate_parent = static_pointer_cast<LMVertex>(candidate->parent);
+      getEdgeFootstepList(candidate_parent, candidate, edge_candidate_footsteps[i]);
+      edge_candidate_results[i].q_start = candidate_parent->q_init;
+    }
+
+    if (!edge_worker_settings_synced){
+      syncEdgeWorkerSettings();
+    }
+    int num_workers = std::min((int) edge_workers.size(), num_candidates);
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(num_workers)
+    for(int i = 0; i < num_candidates; i++){
+      EdgeVerificationWorker & worker = edge_workers[omp_get_thread_num()];
+      LMVertex* to_node = static_cast<LMVertex*>(edge_candidates[i].get());
+      LMVertex* from_node = static_cast<LMVertex*>(to_node->parent.get());
+      EdgeVerificationResult & result = edge_candidate_results[i];
+
+      result.convergence = worker.ctg->computeConfigurationTrajectory(worker.f_s,
+                                                                      from_node->s, (to_node->s - from_node->s),
+                                                                      result.q_start,
+                                                                      edge_candidate_footsteps[i]);
+      if (result.convergence){
+        result.traj_q_config = worker.ctg->traj_q_config;
+      }
+    }
+
+    // Store the results in candidate order so that the outcome does not depend on thread scheduling
+    for(int i = 0; i < num_candidates; i++){
+      candidate = static_pointer_cast<LMVertex>(edge_candidates[i]);
+      candidate_parent = static_pointer_cast<LMVertex>(candidate->parent);
+      prefetched_edges[getEdgeKey(candidate_parent, candidate)] = edge_candidate_results[i];
+    }
   }
 
 
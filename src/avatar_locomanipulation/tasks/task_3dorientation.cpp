@@ -5,6 +5,7 @@ Task3DOrientation::Task3DOrientation(std::shared_ptr<RobotModel> & input_model,
 	task_dim = 3;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 	J_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	Jdot_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	std::cout << "[Task 3D Orientation] for frame " << frame_name << " Constructed" << std::endl;
@@ -18,11 +19,11 @@ Task3DOrientation::~Task3DOrientation(){
 }
 
 void Task3DOrientation::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
 	J_task = J_tmp.bottomRows(3);
 }
 void Task3DOrientation::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
 	Jdot_task = Jdot_tmp.bottomRows(3);
 }
 
@@ -36,7 +37,7 @@ void Task3DOrientation::getReference(Eigen::Quaterniond & quat_ref_out){
 }
 
 void Task3DOrientation::computeError(){
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 	// Compute Quaternion Error
 	math_utils::compute_quat_error(quat_ref_, quat_current_, quat_error_);
 	error_ = kp_task_gain_*quat_error_;
@@ -6,6 +6,7 @@ Task4DContactNormalTask::Task4DContactNormalTask(std::shared_ptr<RobotModel> & i
 	task_dim = 4;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	J_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	Jdot_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
@@ -39,7 +40,7 @@ Task4DContactNormalTask::~Task4DContactNormalTask(){
 }
 
 void Task4DContactNormalTask::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
 	J_task = J_tmp.bottomRows(4);
 
 	// Compute the top row to be the Jacobian of the distance between the contact point and the plane
@@ -50,7 +51,7 @@ void Task4DContactNormalTask::getTaskJacobian(Eigen::MatrixXd & J_task){
 
 }
 void Task4DContactNormalTask::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
 	Jdot_task = Jdot_tmp.bottomRows(4);
 
 	// Compute the top row to be the Jacobian dot of the distance between the contact point and the plane
@@ -61,7 +62,7 @@ void Task4DContactNormalTask::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 
 void Task4DContactNormalTask::computeError(){
 	// Get current position of the end-effector
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 	
 	// Compute signed perpendicular distance to the plane.
 	// v = end_effector - plane_center
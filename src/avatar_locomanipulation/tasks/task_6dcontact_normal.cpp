@@ -28,7 +28,7 @@ Task6DContactNormalTask::~Task6DContactNormalTask(){
 
 void Task6DContactNormalTask::computeError(){
 	// Get current position of the end-effector
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 	
 	// Compute signed perpendicular distance to the plane.
 	// v = end_effector - plane_center
@@ -5,6 +5,7 @@ Task6DPose::Task6DPose(std::shared_ptr<RobotModel> & input_model, const std::str
 	task_dim = 6;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	error_ = Eigen::VectorXd::Zero(task_dim);
 	vec_ref_ = Eigen::VectorXd::Zero(3);
@@ -18,10 +19,10 @@ Task6DPose::~Task6DPose(){
 }
 
 void Task6DPose::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_task);
+	robot_model->get6DTaskJacobian(frame_handle, J_task);
 }
 void Task6DPose::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_task);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_task);
 }
 
 
@@ -57,7 +58,7 @@ void Task6DPose::getReference(Eigen::Quaterniond & quat_ref_out){
 }
 
 void Task6DPose::computeError(){
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 	// Compute Linear Error
 	error_.head(3) = kp_task_gain_*(vec_ref_ - cur_pos_);
 	// Compute Quaternion Error
@@ -5,6 +5,7 @@ Task6DPoseNoRXRY::Task6DPoseNoRXRY(std::shared_ptr<RobotModel> & input_model, co
 	task_dim = 6;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	error_ = Eigen::VectorXd::Zero(task_dim);
 	vec_ref_ = Eigen::VectorXd::Zero(3);
@@ -18,7 +19,7 @@ Task6DPoseNoRXRY::~Task6DPoseNoRXRY(){
 }
 
 void Task6DPoseNoRXRY::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_task);
+	robot_model->get6DTaskJacobian(frame_handle, J_task);
 	// Remove rx, ry contributions of the floating base
 	// J_task.col(2) = Eigen::VectorXd::Zero(6) ;
 	J_task.col(3) = Eigen::VectorXd::Zero(6) ;
@@ -27,7 +28,7 @@ void Task6DPoseNoRXRY::getTaskJacobian(Eigen::MatrixXd & J_task){
 }
 
 void Task6DPoseNoRXRY::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_task);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_task);
 	// Remove rx, ry contributions of the floating base
 	// Jdot_task.col(2) = Eigen::VectorXd::Zero(6);
 	Jdot_task.col(3) = Eigen::VectorXd::Zero(6);
@@ -65,7 +66,7 @@ void Task6DPoseNoRXRY::getReference(Eigen::Quaterniond & quat_ref_out){
 }
 
 void Task6DPoseNoRXRY::computeError(){
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 	// Compute Linear Error
 	error_.head(3) = kp_task_gain_*(vec_ref_ - cur_pos_);
 	// Compute Quaternion Error
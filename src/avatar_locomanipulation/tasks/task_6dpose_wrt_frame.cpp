@@ -8,6 +8,7 @@ Task6DPosewrtFrame::Task6DPosewrtFrame(std::shared_ptr<RobotModel> & input_model
 	frame_pos.setZero();
 	frame_quat.setIdentity();
 	wrt_frame_name = input_wrt_frame_name;
+	wrt_frame_handle = robot_model->getFrameHandle(wrt_frame_name);
 
 	J_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	J_wrt = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
@@ -23,21 +24,21 @@ Task6DPosewrtFrame::~Task6DPosewrtFrame(){
 }
 
 void Task6DPosewrtFrame::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
-	robot_model->get6DTaskJacobian(wrt_frame_name, J_wrt);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
+	robot_model->get6DTaskJacobian(wrt_frame_handle, J_wrt);
 	J_task = J_tmp - J_wrt;
 }
 void Task6DPosewrtFrame::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
-	robot_model->get6DTaskJacobianDot(wrt_frame_name, Jdot_wrt);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(wrt_frame_handle, Jdot_wrt);
 	Jdot_task = Jdot_tmp - Jdot_wrt;
 }
 
 void Task6DPosewrtFrame::computeError(){
 	// Get Frame Position and Orientation
-	robot_model->getFrameWorldPose(wrt_frame_name, frame_pos, frame_quat);
+	robot_model->getFrameWorldPose(wrt_frame_handle, frame_pos, frame_quat);
 	// Get 6D pose of this link
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 
 	// Compute desired values:
 	des_pos = frame_pos + frame_quat.toRotationMatrix()*vec_ref_;
@@ -6,6 +6,8 @@ Task6DPosewrtMidFeet::Task6DPosewrtMidFeet(std::shared_ptr<RobotModel> & input_m
 	des_quat.setIdentity();
 	left_foot_frame = "leftCOP_Frame";
 	right_foot_frame = "rightCOP_Frame";
+	left_foot_frame_handle = robot_model->getFrameHandle(left_foot_frame);
+	right_foot_frame_handle = robot_model->getFrameHandle(right_foot_frame);
 	right_foot.robot_side = RIGHT_FOOTSTEP;
 	midfeet.robot_side = MID_FOOTSTEP;
 
@@ -30,28 +32,28 @@ Task6DPosewrtMidFeet::~Task6DPosewrtMidFeet(){
 }
 
 void Task6DPosewrtMidFeet::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
-	robot_model->get6DTaskJacobian(left_foot_frame, J_lf);
-	robot_model->get6DTaskJacobian(right_foot_frame, J_rf);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
+	robot_model->get6DTaskJacobian(left_foot_frame_handle, J_lf);
+	robot_model->get6DTaskJacobian(right_foot_frame_handle, J_rf);
 	// 2nd term is the midfeet frame Jacobian
 	J_task = J_tmp - 0.5*(J_lf + J_rf);
 }
 void Task6DPosewrtMidFeet::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
-	robot_model->get6DTaskJacobianDot(left_foot_frame, Jdot_lf);
-	robot_model->get6DTaskJacobianDot(right_foot_frame, Jdot_rf);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(left_foot_frame_handle, Jdot_lf);
+	robot_model->get6DTaskJacobianDot(right_foot_frame_handle, Jdot_rf);
 	Jdot_task = Jdot_tmp - 0.5*(Jdot_lf + Jdot_rf);
 }
 
 void Task6DPosewrtMidFeet::computeError(){
 	// Get Left Foot Pos/Ori. Compute Rotation Matrix
-	robot_model->getFrameWorldPose(left_foot_frame, left_foot.position, left_foot.orientation);
+	robot_model->getFrameWorldPose(left_foot_frame_handle, left_foot.position, left_foot.orientation);
 	left_foot.R_ori = left_foot.orientation.toRotationMatrix();	
 	// Get Right Foot Pos/Ori. Compute Rotation Matrix
-	robot_model->getFrameWorldPose(right_foot_frame, right_foot.position, right_foot.orientation);
+	robot_model->getFrameWorldPose(right_foot_frame_handle, right_foot.position, right_foot.orientation);
 	right_foot.R_ori = right_foot.orientation.toRotationMatrix();	
 	// Get 6D pose of this link.
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 
 	// Compute Midfeet
 	midfeet.computeMidfeet(left_foot, right_foot, midfeet);
@@ -6,6 +6,7 @@ TaskContactNormalTask::TaskContactNormalTask(std::shared_ptr<RobotModel> & input
 	task_dim = 3;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	J_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	Jdot_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
@@ -41,7 +42,7 @@ TaskContactNormalTask::~TaskContactNormalTask(){
 
 void TaskContactNormalTask::getTaskJacobian(Eigen::MatrixXd & J_task){
 	// Get the local frame Jacobian (Body Jacobian)
-	robot_model->get6DTaskJacobianLocal(frame_name, J_tmp);
+	robot_model->get6DTaskJacobianLocal(frame_handle, J_tmp);
 	J_task = J_tmp.bottomRows(3); 
 
 	// Compute the top row to be the Jacobian of the distance between the contact point and the plane
@@ -56,7 +57,7 @@ void TaskContactNormalTask::getTaskJacobian(Eigen::MatrixXd & J_task){
 }
 void TaskContactNormalTask::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 	// Get the local frame Jacobian dot (Body Jacobian Dot)
-	robot_model->get6DTaskJacobianDotLocal(frame_name, Jdot_tmp);
+	robot_model->get6DTaskJacobianDotLocal(frame_handle, Jdot_tmp);
 	Jdot_task = Jdot_tmp.bottomRows(3);
 
 	// Compute the top row to be the Jacobian dot of the distance between the contact point and the plane
@@ -72,7 +73,7 @@ void TaskContactNormalTask::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 
 void TaskContactNormalTask::computeError(){
 	// Get current position of the end-effector w.r.t world
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 
 	// Get z hat vector of the end effector frame
 	R_frame_ori_ = quat_current_.toRotationMatrix();
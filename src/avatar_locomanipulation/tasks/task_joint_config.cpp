@@ -13,7 +13,13 @@ TaskJointConfig::TaskJointConfig(std::shared_ptr<RobotModel> & input_model, cons
 	int joint_index = 0;
 	for(int i = 0; i < joint_names.size(); i++){
 		task_name = task_name + " " + joint_names[i];
-		joint_index = 6 + robot_model->getJointIndexNoFloatingJoints(joint_names[i]);
+		joint_handles_.push_back(robot_model->getJointHandle(joint_names[i]));
+		// Unknown joints keep a zero row
+		if (!joint_handles_[i].valid){
+			std::cerr << "[Task Joint Config] Error. Joint " << joint_names[i] << " is not part of the model" << std::endl;
+			continue;
+		}
+		joint_index = 6 + robot_model->getJointIndexNoFloatingJoints(joint_handles_[i]);
 		J_config(i, joint_index) = 1;
 	}
 	std::cout << "[Task Joint Config] for joints " << task_name << " Constructed" << std::endl;
@@ -42,7 +48,9 @@ void TaskJointConfig::getReference(Eigen::VectorXd & vec_ref_out){
 }
 void TaskJointConfig::computeError(){
 	for(int i = 0; i < joint_names_.size(); i++){
-		cur_joint_pos[i] = robot_model->q_current[robot_model->getJointIndex(joint_names_[i])];
+		if (joint_handles_[i].valid){
+			cur_joint_pos[i] = robot_model->q_current[robot_model->getJointIndex(joint_handles_[i])];
+		}
 	}
 	error_ = kp_task_gain_*(vec_ref_ - cur_joint_pos);
 }
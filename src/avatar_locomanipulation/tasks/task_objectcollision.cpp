@@ -5,6 +5,7 @@ TaskObjectCollision::TaskObjectCollision(std::shared_ptr<RobotModel> & input_mod
 	task_dim = 1;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	link_name = link_name_in;
 
@@ -27,14 +28,22 @@ TaskObjectCollision::~TaskObjectCollision(){
 
 void TaskObjectCollision::getTaskJacobian(Eigen::MatrixXd & J_task){
 	std::cout << "ot1\n";
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
 	std::cout << "ot2\n";
 	J_task = Eigen::MatrixXd::Zero(1, robot_model->getDimQdot());
 
+	// Relative jacobian of the near points. The frame origin stands in for the near point unless proxies are used
+	Eigen::MatrixXd J_rel = -J_tmp.topRows(3);
+	if(collision_env->using_proxy_geometry()){
+		Eigen::MatrixXd Jp_from, Jp_to;
+		collision_env->get_point_jacobians(robot_model, collision_env->directed_vectors[collision_env->closest], Jp_from, Jp_to);
+		J_rel = Jp_from - Jp_to;
+	}
+
 	// If the links are in collision then we want higher safety distance
 	if(collision_env->directed_vectors[collision_env->closest].using_worldFramePose){
 		// Set this to J_task
-		J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.2)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * (- J_tmp.topRows(3));
+		J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.2)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * J_rel;
 		return;
 	} 
 	// Else we want lower safety distance
@@ -42,12 +51,12 @@ void TaskObjectCollision::getTaskJacobian(Eigen::MatrixXd & J_task){
 		// If magnitude inside safety distance
 		if(collision_env->directed_vectors[collision_env->closest].magnitude < 0.075){
   			// Add this to J_task
-  			J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.075)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * (- J_tmp.topRows(3));
+  			J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.075)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * J_rel;
   		}	
 	} 	
 }
 void TaskObjectCollision::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
 	Jdot_task = Eigen::MatrixXd::Zero(1, robot_model->getDimQdot());
 
 	
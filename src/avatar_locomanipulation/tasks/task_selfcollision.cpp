@@ -5,6 +5,7 @@ TaskSelfCollision::TaskSelfCollision(std::shared_ptr<RobotModel> & input_model,
 	task_dim = 1;
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	link_name = link_name_in;
 
@@ -30,18 +31,26 @@ void TaskSelfCollision::getTaskJacobian(Eigen::MatrixXd & J_task){
 	Eigen::MatrixXd Jp_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 
 	std::cout << "st1\n";
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
 	std::cout << "st2\n";
 	J_task = Eigen::MatrixXd::Zero(1, robot_model->getDimQdot());
 
 	std::cout << "collision_env->directed_vectors[collision_env->closest].from: " << collision_env->directed_vectors[collision_env->closest].from << std::endl;
 	robot_model->get6DTaskJacobian(collision_env->directed_vectors[collision_env->closest].from, Jp_tmp);
 
+	// Relative jacobian of the near points. The frame origins stand in for the near points unless proxies are used
+	Eigen::MatrixXd J_rel = Jp_tmp.topRows(3) - J_tmp.topRows(3);
+	if(collision_env->using_proxy_geometry()){
+		Eigen::MatrixXd Jp_from, Jp_to;
+		collision_env->get_point_jacobians(robot_model, collision_env->directed_vectors[collision_env->closest], Jp_from, Jp_to);
+		J_rel = Jp_from - Jp_to;
+	}
+
 	// If the links are in collision then we want higher safety distance
 	if(collision_env->directed_vectors[collision_env->closest].using_worldFramePose){
 		// Add this to J_task
 		std::cout << "Task1" << std::endl;
-		J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.2)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * (Jp_tmp.topRows(3) - J_tmp.topRows(3));
+		J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.2)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * J_rel;
 		return;
 	} 
 	// Else we want lower safety distance
@@ -50,7 +59,7 @@ void TaskSelfCollision::getTaskJacobian(Eigen::MatrixXd & J_task){
 		if(collision_env->directed_vectors[collision_env->closest].magnitude < 0.075){
   			// Add this to J_task
   			std::cout << "Task2" << std::endl;
-  			J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.075)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * (Jp_tmp.topRows(3) - J_tmp.topRows(3));
+  			J_task = eta * ( (1/(collision_env->directed_vectors[collision_env->closest].magnitude)) - (1/(0.075)) ) * ((-1)/(std::pow((collision_env->directed_vectors[collision_env->closest].magnitude),2))) * (1/((collision_env->directed_vectors[collision_env->closest].magnitude))) * ((collision_env->directed_vectors[collision_env->closest].magnitude)*(collision_env->directed_vectors[collision_env->closest].direction).transpose()) * J_rel;
   		}	
 	} 
 
@@ -61,7 +70,7 @@ void TaskSelfCollision::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 	Eigen::MatrixXd Jpdot_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 
 
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
 	Jdot_task = Eigen::MatrixXd::Zero(1, robot_model->getDimQdot());
 
 	
@@ -28,7 +28,7 @@ TaskXDPose::~TaskXDPose(){
 }
 
 void TaskXDPose::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
 	for(int i = 0 ; i < task_dimensions.size(); i++){
 		J_out.row(i) = J_tmp.row(task_dimensions[i]); 
 	}
@@ -36,7 +36,7 @@ void TaskXDPose::getTaskJacobian(Eigen::MatrixXd & J_task){
 	J_task = J_out;
 }
 void TaskXDPose::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
 	for(int i = 0 ; i < task_dimensions.size(); i++){
 		Jdot_out.row(i) = Jdot_tmp.row(task_dimensions[i]); 
 	}
@@ -45,7 +45,7 @@ void TaskXDPose::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 }
 
 void TaskXDPose::computeError(){
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 	// Compute Linear Error
 	error_tmp.head(3) = kp_task_gain_*(vec_ref_ - cur_pos_);
 	// Compute Quaternion Error
@@ -14,6 +14,7 @@ TaskXDPosewrtFrame::TaskXDPosewrtFrame(std::shared_ptr<RobotModel> & input_model
 	task_dim = task_dimensions.size();
 	task_name = input_frame_name;
 	frame_name = input_frame_name;
+	frame_handle = robot_model->getFrameHandle(frame_name);
 
 	error_tmp = Eigen::VectorXd::Zero(6);
 	vec_ref_ = Eigen::VectorXd::Zero(3);
@@ -25,6 +26,7 @@ TaskXDPosewrtFrame::TaskXDPosewrtFrame(std::shared_ptr<RobotModel> & input_model
 	frame_pos.setZero();
 	frame_quat.setIdentity();
 	wrt_frame_name = input_wrt_frame_name;
+	wrt_frame_handle = robot_model->getFrameHandle(wrt_frame_name);
 
 	J_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	J_wrt = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
@@ -45,8 +47,8 @@ TaskXDPosewrtFrame::~TaskXDPosewrtFrame(){
 }
 
 void TaskXDPosewrtFrame::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
-	robot_model->get6DTaskJacobian(wrt_frame_name, J_wrt);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
+	robot_model->get6DTaskJacobian(wrt_frame_handle, J_wrt);
 
 	for(int i = 0 ; i < task_dimensions.size(); i++){
 		J_out.row(i) = J_tmp.row(task_dimensions[i])- J_wrt.row(task_dimensions[i]); 
@@ -55,8 +57,8 @@ void TaskXDPosewrtFrame::getTaskJacobian(Eigen::MatrixXd & J_task){
 
 }
 void TaskXDPosewrtFrame::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
-	robot_model->get6DTaskJacobianDot(wrt_frame_name, Jdot_wrt);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(wrt_frame_handle, Jdot_wrt);
 
 	for(int i = 0 ; i < task_dimensions.size(); i++){
 		Jdot_out.row(i) = Jdot_tmp.row(task_dimensions[i])- Jdot_wrt.row(task_dimensions[i]); 
@@ -67,9 +69,9 @@ void TaskXDPosewrtFrame::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 
 void TaskXDPosewrtFrame::computeError(){
 	// Get Frame Position and Orientation
-	robot_model->getFrameWorldPose(wrt_frame_name, frame_pos, frame_quat);
+	robot_model->getFrameWorldPose(wrt_frame_handle, frame_pos, frame_quat);
 	// Get 6D pose of this link
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 
 	// Compute desired values:
 	des_pos = frame_pos + frame_quat.toRotationMatrix()*vec_ref_;
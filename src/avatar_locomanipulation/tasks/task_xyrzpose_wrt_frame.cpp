@@ -15,6 +15,7 @@ TaskXYRZPosewrtFrame::TaskXYRZPosewrtFrame(std::shared_ptr<RobotModel> & input_m
 	frame_pos.setZero();
 	frame_quat.setIdentity();
 	wrt_frame_name = input_wrt_frame_name;
+	wrt_frame_handle = robot_model->getFrameHandle(wrt_frame_name);
 
 	J_tmp = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
 	J_wrt = Eigen::MatrixXd::Zero(6, robot_model->getDimQdot());
@@ -30,16 +31,16 @@ TaskXYRZPosewrtFrame::~TaskXYRZPosewrtFrame(){
 }
 
 void TaskXYRZPosewrtFrame::getTaskJacobian(Eigen::MatrixXd & J_task){
-	robot_model->get6DTaskJacobian(frame_name, J_tmp);
-	robot_model->get6DTaskJacobian(wrt_frame_name, J_wrt);
+	robot_model->get6DTaskJacobian(frame_handle, J_tmp);
+	robot_model->get6DTaskJacobian(wrt_frame_handle, J_wrt);
 	J_task = J_tmp.topRows(3) - J_wrt.topRows(3);
 	J_task.row(2) = J_tmp.row(5) - J_wrt.row(5);
 
 
 }
 void TaskXYRZPosewrtFrame::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
-	robot_model->get6DTaskJacobianDot(frame_name, Jdot_tmp);
-	robot_model->get6DTaskJacobianDot(wrt_frame_name, Jdot_wrt);
+	robot_model->get6DTaskJacobianDot(frame_handle, Jdot_tmp);
+	robot_model->get6DTaskJacobianDot(wrt_frame_handle, Jdot_wrt);
 	Jdot_task = Jdot_tmp.topRows(3) - Jdot_wrt.topRows(3);
 	Jdot_task.row(2) = Jdot_tmp.row(5) - Jdot_wrt.row(5);
 
@@ -47,9 +48,9 @@ void TaskXYRZPosewrtFrame::getTaskJacobianDot(Eigen::MatrixXd & Jdot_task){
 
 void TaskXYRZPosewrtFrame::computeError(){
 	// Get Frame Position and Orientation
-	robot_model->getFrameWorldPose(wrt_frame_name, frame_pos, frame_quat);
+	robot_model->getFrameWorldPose(wrt_frame_handle, frame_pos, frame_quat);
 	// Get 6D pose of this link
-	robot_model->getFrameWorldPose(frame_name, cur_pos_, quat_current_);
+	robot_model->getFrameWorldPose(frame_handle, cur_pos_, quat_current_);
 
 	// Compute desired values:
 	des_pos = frame_pos + frame_quat.toRotationMatrix()*vec_ref_;
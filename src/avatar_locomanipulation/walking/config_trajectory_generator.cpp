@@ -1,4 +1,6 @@
 #include <avatar_locomanipulation/walking/config_trajectory_generator.hpp>
+#include <algorithm>
+#include <numeric>
 
 // Constructor
 ConfigTrajectoryGenerator::ConfigTrajectoryGenerator(){	
@@ -67,6 +69,22 @@ void ConfigTrajectoryGenerator::setRobotModel(std::shared_ptr<RobotModel> & robo
 
 	q_start = Eigen::VectorXd::Zero(robot_model->getDimQ());
 	q_current = Eigen::VectorXd::Zero(robot_model->getDimQ());
+
+	// Resolve the frames and joints used at every trajectory computation
+	left_cop_frame_handle = robot_model->getFrameHandle("leftCOP_Frame");
+	right_cop_frame_handle = robot_model->getFrameHandle("rightCOP_Frame");
+	pelvis_frame_handle = robot_model->getFrameHandle("pelvis");
+
+	zero_posture_joint_handles.clear();
+	std::vector<std::string> zero_posture_joint_names = {"torsoYaw", "torsoPitch", "torsoRoll", "rightWristRoll", "rightWristPitch", "leftWristRoll", "leftWristPitch"};
+	removeLockedJoints(zero_posture_joint_names);
+	JointHandle joint;
+	for(int i = 0; i < zero_posture_joint_names.size(); i++){
+		joint = robot_model->getJointHandle(zero_posture_joint_names[i]);
+		if (joint.valid){
+			zero_posture_joint_handles.push_back(joint);
+		}
+	}
 }
 
 void ConfigTrajectoryGenerator::initializeDiscretization(const int & N_size_in){
@@ -113,6 +131,50 @@ void ConfigTrajectoryGenerator::setSolveEvenWithPartialDivergence(bool solve_wit
 	solve_with_partial_divergence = solve_with_partial_divergence_in;
 }
 
+void ConfigTrajectoryGenerator::setUsePredictorWarmStart(bool use_predictor_warm_start_in){
+	use_predictor_warm_start = use_predictor_warm_start_in;
+}
+
+void ConfigTrajectoryGenerator::setPredictorGain(double predictor_gain_in){
+	predictor_gain = predictor_gain_in;
+}
+
+bool ConfigTrajectoryGenerator::getUsePredictorWarmStart(){
+	return use_predictor_warm_start;
+}
+
+double ConfigTrajectoryGenerator::getPredictorGain(){
+	return predictor_gain;
+}
+
+const std::vector<int> & ConfigTrajectoryGenerator::getLastTrajectoryIKIterations(){
+	return last_traj_ik_iters;
+}
+
+const std::vector<int> & ConfigTrajectoryGenerator::getLastTrajectoryIKMinorIterations(){
+	return last_traj_ik_minor_iters;
+}
+
+int ConfigTrajectoryGenerator::getLastTrajectoryNumIKSolves(){
+	return last_traj_ik_iters.size();
+}
+
+void ConfigTrajectoryGenerator::setRecordColdStartIterations(bool record_cold_start_iterations_in){
+	record_cold_start_iterations = record_cold_start_iterations_in;
+}
+
+const std::vector<int> & ConfigTrajectoryGenerator::getLastTrajectoryColdStartIKIterations(){
+	return last_traj_cold_start_ik_iters;
+}
+
+int ConfigTrajectoryGenerator::getLastTrajectoryIKIterationSavings(){
+	if (last_traj_cold_start_ik_iters.size() != last_traj_ik_iters.size()){
+		return 0;
+	}
+	return std::accumulate(last_traj_cold_start_ik_iters.begin(), last_traj_cold_start_ik_iters.end(), 0) -
+	       std::accumulate(last_traj_ik_iters.begin(), last_traj_ik_iters.end(), 0);
+}
+
 void ConfigTrajectoryGenerator::initializeTasks(){
 	pelvis_ori_task = std::shared_ptr<Task>(new Task3DOrientation(robot_model, "pelvis"));
 	com_task = std::shared_ptr<Task>(new TaskCOM(robot_model));
@@ -131,6 +193,14 @@ void ConfigTrajectoryGenerator::initializeTasks(){
     std::vector<std::string> right_wrist_joint_names = {"rightWristRoll", "rightWristPitch"};
     std::vector<std::string> left_wrist_joint_names = {"leftWristRoll", "leftWristPitch"};
 
+    // Joints locked in a ReducedRobotModel are not part of the posture tasks
+    removeLockedJoints(torso_joint_names);
+    removeLockedJoints(neck_joint_names);
+    removeLockedJoints(left_arm_joint_names);
+    removeLockedJoints(right_arm_joint_names);
+    removeLockedJoints(right_wrist_joint_names);
+    removeLockedJoints(left_wrist_joint_names);
+
     torso_posture_task = std::shared_ptr<Task>(new TaskJointConfig(robot_model, torso_joint_names));
     neck_posture_task = std::shared_ptr<Task>(new TaskJointConfig(robot_model, neck_joint_names));
     rarm_posture_task = std::shared_ptr<Task>(new TaskJointConfig(robot_model, right_arm_joint_names));
@@ -226,6 +296,11 @@ void ConfigTrajectoryGenerator::createTaskStack(){
 		vec_posture_task_stack.push_back(torso_posture_task);	
 	}
 
+	removeEmptyTasks(vec_task_stack_start_config);
+	removeEmptyTasks(vec_task_stack);
+	removeEmptyTasks(vec_manip_stack_1);
+	removeEmptyTasks(vec_posture_task_stack);
+
 	// Clear the task hierarchy in the IK module
 	ik_starting_config_module->clearTaskHierarchy();
 	ik_locomanipulation_module->clearTaskHierarchy();
@@ -261,6 +336,74 @@ int ConfigTrajectoryGenerator::getDiscretizationSize(){
 	return N_size;
 }
 
+ConfigTrajectorySettings ConfigTrajectoryGenerator::getSettings(){
+	ConfigTrajectorySettings settings;
+	settings.N_size = N_size;
+
+	settings.use_right_hand = use_right_hand;
+	settings.use_left_hand = use_left_hand;
+	settings.use_torso_joint_position = use_torso_joint_position;
+	settings.use_arm_lower_priority_posture_task = use_arm_lower_priority_posture_task;
+
+	settings.verbosity_level = verbosity_level;
+	settings.max_manipulation_task_ik_error = max_manipulation_task_ik_error;
+	settings.solve_with_partial_divergence = solve_with_partial_divergence;
+	settings.traj_error_tol = traj_error_tol;
+	settings.manipulation_only_time = manipulation_only_time;
+
+	settings.use_predictor_warm_start = use_predictor_warm_start;
+	settings.predictor_gain = predictor_gain;
+	settings.record_cold_start_iterations = record_cold_start_iterations;
+
+	settings.wpg_gravity = wpg.gravity;
+	settings.wpg_z_vrp = wpg.z_vrp;
+	settings.wpg_b = wpg.b;
+	settings.wpg_t_ds = wpg.t_ds;
+	settings.wpg_t_ss = wpg.t_ss;
+	settings.wpg_t_settle = wpg.t_settle;
+	settings.wpg_t_transfer = wpg.t_transfer;
+	settings.wpg_swing_height = wpg.swing_height;
+
+	settings.ik_starting_config_parameters = ik_starting_config_module->getParameters();
+	settings.ik_locomanipulation_parameters = ik_locomanipulation_module->getParameters();
+	settings.ik_manipulation_only_parameters = ik_manipulation_only_module->getParameters();
+	return settings;
+}
+
+void ConfigTrajectoryGenerator::applySettings(const ConfigTrajectorySettings & settings){
+	use_right_hand = settings.use_right_hand;
+	use_left_hand = settings.use_left_hand;
+	use_torso_joint_position = settings.use_torso_joint_position;
+	use_arm_lower_priority_posture_task = settings.use_arm_lower_priority_posture_task;
+
+	setVerbosityLevel(settings.verbosity_level);
+	max_manipulation_task_ik_error = settings.max_manipulation_task_ik_error;
+	solve_with_partial_divergence = settings.solve_with_partial_divergence;
+	traj_error_tol = settings.traj_error_tol;
+	manipulation_only_time = settings.manipulation_only_time;
+
+	use_predictor_warm_start = settings.use_predictor_warm_start;
+	predictor_gain = settings.predictor_gain;
+	record_cold_start_iterations = settings.record_cold_start_iterations;
+
+	wpg.gravity = settings.wpg_gravity;
+	wpg.z_vrp = settings.wpg_z_vrp;
+	wpg.b = settings.wpg_b;
+	wpg.t_ds = settings.wpg_t_ds;
+	wpg.t_ss = settings.wpg_t_ss;
+	wpg.t_settle = settings.wpg_t_settle;
+	wpg.t_transfer = settings.wpg_t_transfer;
+	wpg.swing_height = settings.wpg_swing_height;
+
+	initializeDiscretization(settings.N_size);
+	// The task stack clears the per task pseudo inverse methods of the IK modules. So it is created before setting the IK parameters.
+	createTaskStack();
+
+	ik_starting_config_module->setParameters(settings.ik_starting_config_parameters);
+	ik_locomanipulation_module->setParameters(settings.ik_locomanipulation_parameters);
+	ik_manipulation_only_module->setParameters(settings.ik_manipulation_only_parameters);
+}
+
 
 void ConfigTrajectoryGenerator::setPostureTaskReference(std::shared_ptr<Task> & posture_task, const Eigen::VectorXd & q_config){
 	Eigen::VectorXd q_ref;
@@ -272,6 +415,26 @@ void ConfigTrajectoryGenerator::setPostureTaskReference(std::shared_ptr<Task> &
 	posture_task->setReference(q_ref);
 }
 
+void ConfigTrajectoryGenerator::removeEmptyTasks(std::vector< std::shared_ptr<Task> > & tasks){
+	std::vector< std::shared_ptr<Task> > non_empty_tasks;
+	for(int i = 0; i < tasks.size(); i++){
+		if (tasks[i]->task_dim > 0){
+			non_empty_tasks.push_back(tasks[i]);
+		}
+	}
+	tasks = non_empty_tasks;
+}
+
+void ConfigTrajectoryGenerator::removeLockedJoints(std::vector<std::string> & joint_names){
+	std::vector<std::string> model_joint_names;
+	for(int i = 0; i < joint_names.size(); i++){
+		if (robot_model->model.existJointName(joint_names[i])){
+			model_joint_names.push_back(joint_names[i]);
+		}
+	}
+	joint_names = model_joint_names;
+}
+
 void ConfigTrajectoryGenerator::getSelectedPostureTaskReferences(std::vector<std::string> & selected_names, const Eigen::VectorXd & q_config, Eigen::VectorXd & q_ref){
   Eigen::VectorXd q_des;
   q_des = Eigen::VectorXd::Zero(selected_names.size());
@@ -285,16 +448,53 @@ void ConfigTrajectoryGenerator::getSelectedPostureTaskReferences(std::vector<std
 }
 
 
-bool ConfigTrajectoryGenerator::computeInitialConfigForFlatGround(const Eigen::VectorXd & q_guess, Eigen::VectorXd & q_out){
-	// Set the starting config
-	setStartingConfig(q_guess);
+void ConfigTrajectoryGenerator::setNumInitialConfigThreads(int num_threads_in){
+	initial_config_num_threads = std::max(num_threads_in, 1);
+}
+
+void ConfigTrajectoryGenerator::setInitialConfigMultiStart(int num_seeds_in, double seed_perturbation_in){
+	initial_config_num_seeds = std::max(num_seeds_in, 1);
+	initial_config_seed_perturbation = seed_perturbation_in;
+}
+
+int ConfigTrajectoryGenerator::getLastInitialConfigSeedIdx(){
+	return last_initial_config_seed_idx;
+}
+
+std::vector< std::shared_ptr<Task> > ConfigTrajectoryGenerator::getStartingConfigReferenceTasks(){
+	return {pelvis_ori_task, com_task, rfoot_task, lfoot_task, torso_posture_task, neck_posture_task, rarm_posture_task, larm_posture_task, rwrist_posture_task, lwrist_posture_task};
+}
+
+void ConfigTrajectoryGenerator::prepareInitialConfigSolver(){
+	// The workers solve the same starting configuration IK with the same settings
+	while(initial_config_workers.size() < (initial_config_num_threads - 1)){
+		std::shared_ptr<RobotModel> worker_model(new RobotModelContext(robot_model));
+		initial_config_workers.push_back(std::shared_ptr<ConfigTrajectoryGenerator>(new ConfigTrajectoryGenerator(worker_model, N_size)));
+	}
+	initial_config_workers.resize(initial_config_num_threads - 1);
+
+	initial_config_solver.clearWorkers();
+	initial_config_solver.addWorker(robot_model, ik_starting_config_module, getStartingConfigReferenceTasks());
+
+	ConfigTrajectorySettings settings = getSettings();
+	int ik_verbosity_level = verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_3 ? IK_VERBOSITY_HIGH : IK_VERBOSITY_LOW;
+	ik_starting_config_module->setVerbosityLevel(ik_verbosity_level);
+	for(int i = 0; i < initial_config_workers.size(); i++){
+		initial_config_workers[i]->applySettings(settings);
+		initial_config_workers[i]->ik_starting_config_module->setVerbosityLevel(ik_verbosity_level);
+		initial_config_solver.addWorker(initial_config_workers[i]->robot_model, initial_config_workers[i]->ik_starting_config_module,
+		                                initial_config_workers[i]->getStartingConfigReferenceTasks());
+	}
+}
+
+bool ConfigTrajectoryGenerator::createInitialConfigJob(const Eigen::VectorXd & q_guess, BatchIKJob & job){
 	// Update robot kinematics
 	robot_model->updateFullKinematics(q_guess);
 
 	// get x,y,z of left and right feet. pelvis orientation and com position 
-	robot_model->getFrameWorldPose("leftCOP_Frame", tmp_left_foot.position, tmp_left_foot.orientation);
-	robot_model->getFrameWorldPose("rightCOP_Frame", tmp_right_foot.position, tmp_right_foot.orientation);	
-	robot_model->getFrameWorldPose("pelvis", tmp_pelvis_pos, tmp_pelvis_ori);	
+	robot_model->getFrameWorldPose(left_cop_frame_handle, tmp_left_foot.position, tmp_left_foot.orientation);
+	robot_model->getFrameWorldPose(right_cop_frame_handle, tmp_right_foot.position, tmp_right_foot.orientation);	
+	robot_model->getFrameWorldPose(pelvis_frame_handle, tmp_pelvis_pos, tmp_pelvis_ori);	
 	tmp_com_pos = robot_model->x_com;
 
     // Snap foot orientation to flat ground
@@ -307,11 +507,10 @@ bool ConfigTrajectoryGenerator::computeInitialConfigForFlatGround(const Eigen::V
     tmp_right_foot.orientation.normalize();
 
     // Need to check for orientation.
-    // Set q_out to q_guess if the foot is already touching the ground
+    // The IK is not needed if the foot is already touching the ground
     if ((fabs(tmp_left_foot.position[2]) <= 1e-4) && (fabs(tmp_left_foot.position[2]) <= 1e-4)) {
         std::cout << "[ConfigTrajectoryGenerator] Feet are already flat on the ground. Initial Config for flat ground solver will not run." << std::endl;
-        q_out = q_guess;
-        return true;
+        return false;
     }
 
 	// bring feet to z = 0.0;
@@ -320,60 +519,121 @@ bool ConfigTrajectoryGenerator::computeInitialConfigForFlatGround(const Eigen::V
 	tmp_right_foot.position[2] = 0.0;
 	tmp_com_pos[2] = wpg.z_vrp; //1.0;
 
-	// Set Task References
-	pelvis_ori_task->setReference(tmp_pelvis_ori);
-	com_task->setReference(tmp_com_pos);
-	rfoot_task->setReference(tmp_right_foot.position, tmp_right_foot.orientation);
-	lfoot_task->setReference(tmp_left_foot.position, tmp_left_foot.orientation);
-
-	setPostureTaskReference(torso_posture_task, q_start);
-	setPostureTaskReference(neck_posture_task, q_start);
-	setPostureTaskReference(rarm_posture_task, q_start);
-	setPostureTaskReference(larm_posture_task, q_start);
-	setPostureTaskReference(rwrist_posture_task, q_start);
-	setPostureTaskReference(lwrist_posture_task, q_start);
+	// Set Task References in the order of getStartingConfigReferenceTasks()
+	job = BatchIKJob(q_guess);
+	job.addReference(0, tmp_pelvis_ori);
+	job.addReference(1, tmp_com_pos);
+	job.addReference(2, tmp_right_foot.position, tmp_right_foot.orientation);
+	job.addReference(3, tmp_left_foot.position, tmp_left_foot.orientation);
 
+	std::vector< std::shared_ptr<Task> > posture_tasks = {torso_posture_task, neck_posture_task, rarm_posture_task, larm_posture_task, rwrist_posture_task, lwrist_posture_task};
+	std::vector<std::string> posture_task_joint_names;
+	Eigen::VectorXd q_ref;
+	for(int i = 0; i < posture_tasks.size(); i++){
+		posture_task_joint_names = std::static_pointer_cast<TaskJointConfig>(posture_tasks[i])->getJointNames();
+		getSelectedPostureTaskReferences(posture_task_joint_names, q_guess, q_ref);
+		job.addReference(4 + i, q_ref);
+	}
+	return true;
+}
 
-	// Prepare IK output
-    int solve_result;
-    double total_error_norm;
-    std::vector<double> task_error_norms;
-    Eigen::VectorXd q_sol = Eigen::VectorXd::Zero(robot_model->getDimQdot());	
-    int ik_verbosity_level = verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_3 ? IK_VERBOSITY_HIGH : IK_VERBOSITY_LOW;
-    bool primary_task_convergence = false;
+void ConfigTrajectoryGenerator::printInitialConfigResult(const BatchIKResult & result){
+	if ((result.convergence) && verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_1) {
+		std::cout << "[ConfigTrajectoryGenerator] IK for computing configuration for flat ground converged" << std::endl;
+		std::cout << "    first_task_error_norm = " << result.task_error_norms[0] << std::endl; 
+	}else if (!result.convergence){
+		std::cout << "[ConfigTrajectoryGenerator] IK for computing configuration for flat ground did not converge" << std::endl;
+		std::cout << "    first_task_error_norm = " << result.task_error_norms[0] << std::endl;
+	}
+}
 
-    // Set Verbosity Level
-    ik_starting_config_module->setVerbosityLevel(ik_verbosity_level);
+bool ConfigTrajectoryGenerator::computeInitialConfigForFlatGround(const Eigen::VectorXd & q_guess, Eigen::VectorXd & q_out){
+	// Set the starting config
+	setStartingConfig(q_guess);
+	last_initial_config_seed_idx = 0;
 
-    // Solve IK
-	primary_task_convergence = ik_starting_config_module->solveIK(solve_result, task_error_norms, total_error_norm, q_sol);
-	if (verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_4){
-		ik_starting_config_module->printSolutionResults();
+	// Set q_out to q_guess if the foot is already touching the ground
+	BatchIKJob job;
+	if (!createInitialConfigJob(q_guess, job)){
+		q_out = q_guess;
+		return true;
 	}
 
-	if ((primary_task_convergence) && verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_1) {
-		std::cout << "[ConfigTrajectoryGenerator] IK for computing configuration for flat ground converged" << std::endl;
-		std::cout << "    first_task_error_norm = " << task_error_norms[0] << std::endl; 
+	prepareInitialConfigSolver();
+
+	// Solve IK
+	BatchIKResult result;
+	if (initial_config_num_seeds <= 1){
+		std::vector<BatchIKResult> results;
+		initial_config_solver.solve({job}, results);
+		result = results[0];
+		if (verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_4){
+			ik_starting_config_module->printSolutionResults();
+		}
 	}else{
-		std::cout << "[ConfigTrajectoryGenerator] IK for computing configuration for flat ground did not converge" << std::endl;
-		std::cout << "    first_task_error_norm = " << task_error_norms[0] << std::endl;
+		// Nominal stance: the floating base of q_guess with all joints at zero
+		Eigen::VectorXd q_nominal = q_guess;
+		q_nominal.tail(robot_model->getDimQ() - VAL_MODEL_NUM_FLOATING_JOINTS).setZero();
+		std::vector<Eigen::VectorXd> seeds;
+		BatchIKSolver::generateSeeds(robot_model, q_guess, q_nominal, initial_config_num_seeds, initial_config_seed_perturbation, 0, seeds);
+		initial_config_solver.solveMultiStart(job, seeds, result);
+		last_initial_config_seed_idx = result.seed_idx;
+		if (verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_1){
+			std::cout << "[ConfigTrajectoryGenerator] Flat ground multi-start IK used seed " << result.seed_idx << " of " << seeds.size() << std::endl;
+		}
 	}
+	printInitialConfigResult(result);
 
 	// Set solution
-    q_out = q_sol;
+    q_out = result.q_sol;
 
     // Check if first task converged
-    return primary_task_convergence;
+    return result.convergence;
 
 }
 
+int ConfigTrajectoryGenerator::computeInitialConfigsForFlatGround(const std::vector<Eigen::VectorXd> & q_guess_list, std::vector<Eigen::VectorXd> & q_out_list, std::vector<bool> & convergence_list){
+	q_out_list = q_guess_list;
+	convergence_list.assign(q_guess_list.size(), true);
+
+	// Guesses with the feet already flat on the ground are their own solution
+	std::vector<BatchIKJob> jobs;
+	std::vector<int> job_guess_indices;
+	BatchIKJob job;
+	for(int i = 0; i < q_guess_list.size(); i++){
+		if (createInitialConfigJob(q_guess_list[i], job)){
+			jobs.push_back(job);
+			job_guess_indices.push_back(i);
+		}
+	}
+
+	prepareInitialConfigSolver();
+	std::vector<BatchIKResult> results;
+	initial_config_solver.solve(jobs, results);
+
+	for(int i = 0; i < results.size(); i++){
+		printInitialConfigResult(results[i]);
+		q_out_list[job_guess_indices[i]] = results[i].q_sol;
+		convergence_list[job_guess_indices[i]] = results[i].convergence;
+	}
+
+	int num_converged = 0;
+	for(int i = 0; i < convergence_list.size(); i++){
+		if (convergence_list[i]){
+			num_converged++;
+		}
+	}
+	return num_converged;
+}
+
 
 void ConfigTrajectoryGenerator::printIntermediateIKTrajectoryresult(int & index, bool & primary_task_converge_result, double & total_error_norm, std::vector<double> & task_error_norms_in){
 	if (index == 0){
 		std::cout << "[ConfigTrajectoryGenerator]" << std::endl;
-		std::cout << "index | 1st task converged? | Acceptable? | total error norm | task error norms " << std::endl;	
+		std::cout << "index | 1st task converged? | Acceptable? | IK iterations | total error norm | task error norms " << std::endl;	
 	}
-	std::cout << index << " | " << (primary_task_converge_result ? "True" : "False") << " | " << (didTrajectoryConverge()? "True" : "False") << " | " << total_error_norm << " | ";
+	std::cout << index << " | " << (primary_task_converge_result ? "True" : "False") << " | " << (didTrajectoryConverge()? "True" : "False") << " | " 
+	          << last_traj_ik_iters.back() << " | " << total_error_norm << " | ";
 
 	for(int i = 0; i < task_error_norms_in.size(); i++){
 		std::cout << task_error_norms_in[i] << " ";
@@ -384,6 +644,19 @@ void ConfigTrajectoryGenerator::printIntermediateIKTrajectoryresult(int & index,
 
 void ConfigTrajectoryGenerator::printIKTrajectoryresult(){
 	std::cout << "[ConfigTrajectoryGenerator] Trajectory converged: " << (didTrajectoryConverge() ? "True" : "False") << ", max first task error norm = " << max_first_task_ik_error << std::endl;
+	if (last_traj_ik_iters.size() == 0){
+		return;
+	}
+	int max_iters = *std::max_element(last_traj_ik_iters.begin(), last_traj_ik_iters.end());
+	double mean_iters = std::accumulate(last_traj_ik_iters.begin(), last_traj_ik_iters.end(), 0.0)/last_traj_ik_iters.size();
+	double mean_minor_iters = std::accumulate(last_traj_ik_minor_iters.begin(), last_traj_ik_minor_iters.end(), 0.0)/last_traj_ik_minor_iters.size();
+	std::cout << "    IK iterations per solve: mean = " << mean_iters << " (" << mean_minor_iters << " minor), max = " << max_iters
+	          << " over " << last_traj_ik_iters.size() << " solves" << (use_predictor_warm_start ? " with predictor warm start" : "") << std::endl;
+	if (last_traj_cold_start_ik_iters.size() == last_traj_ik_iters.size()){
+		double mean_cold_start_iters = std::accumulate(last_traj_cold_start_ik_iters.begin(), last_traj_cold_start_ik_iters.end(), 0.0)/last_traj_cold_start_ik_iters.size();
+		std::cout << "    Cold start IK iterations per solve: mean = " << mean_cold_start_iters
+		          << ", iterations saved over the trajectory = " << getLastTrajectoryIKIterationSavings() << std::endl;
+	}
 }
 
 
@@ -479,25 +752,20 @@ bool ConfigTrajectoryGenerator::computeConfigurationTrajectory(const Eigen::Vect
 	robot_model->updateFullKinematics(q_init);
 
 	// Get the initial footstep stances
-	robot_model->getFrameWorldPose("leftCOP_Frame", tmp_left_foot.position, tmp_left_foot.orientation);
-	robot_model->getFrameWorldPose("rightCOP_Frame", tmp_right_foot.position, tmp_right_foot.orientation);	
+	robot_model->getFrameWorldPose(left_cop_frame_handle, tmp_left_foot.position, tmp_left_foot.orientation);
+	robot_model->getFrameWorldPose(right_cop_frame_handle, tmp_right_foot.position, tmp_right_foot.orientation);	
 	// Get the initial CoM position
 	tmp_com_pos = robot_model->x_com;
 
 	// Get the initial pelvis orientation
-	robot_model->getFrameWorldPose("pelvis", tmp_pelvis_pos, tmp_pelvis_ori);	
+	robot_model->getFrameWorldPose(pelvis_frame_handle, tmp_pelvis_pos, tmp_pelvis_ori);	
 
 	// set joint position task reference.
 	Eigen::VectorXd q_posture = q_start;
-	q_posture[robot_model->getJointIndex("torsoYaw")] = 0.0;
-	q_posture[robot_model->getJointIndex("torsoPitch")] = 0.0;
-	q_posture[robot_model->getJointIndex("torsoRoll")] = 0.0;
-
-	q_posture[robot_model->getJointIndex("rightWristRoll")] = 0.0;
-	q_posture[robot_model->getJointIndex("rightWristPitch")] = 0.0;
-
-	q_posture[robot_model->getJointIndex("leftWristRoll")] = 0.0;
-	q_posture[robot_model->getJointIndex("leftWristPitch")] = 0.0;
+	// torso and wrist joints are set to zero
+	for(int i = 0; i < zero_posture_joint_handles.size(); i++){
+		q_posture[robot_model->getJointIndex(zero_posture_joint_handles[i])] = 0.0;
+	}
 
 	setPostureTaskReference(torso_posture_task, q_posture);
 	setPostureTaskReference(neck_posture_task, q_posture);
@@ -545,6 +813,12 @@ bool ConfigTrajectoryGenerator::computeConfigurationTrajectory(const Eigen::Vect
     bool primary_task_convergence = false;
     int ik_verbosity_level = verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_3 ? IK_VERBOSITY_HIGH : IK_VERBOSITY_LOW;
 
+    // Cold start baseline IK outputs
+    int cold_start_solve_result;
+    std::vector<double> cold_start_task_error_norms;
+    double cold_start_total_error_norm;
+    Eigen::VectorXd q_cold_start_sol;
+
     // Set IK Module descent and convergence options
     ik_to_use_module->setSequentialDescent(false);
     ik_to_use_module->setReturnWhenFirstTaskConverges(true);
@@ -556,6 +830,11 @@ bool ConfigTrajectoryGenerator::computeConfigurationTrajectory(const Eigen::Vect
     // Reset max_ik_error
     max_first_task_ik_error = -1e3;
 
+    // Reset the IK statistics of the trajectory
+    last_traj_ik_iters.clear();
+    last_traj_ik_minor_iters.clear();
+    last_traj_cold_start_ik_iters.clear();
+
     if (verbosity_level >= CONFIG_TRAJECTORY_VERBOSITY_LEVEL_1){
     	std::cout << "[ConfigTrajectoryGenerator] Computing wholebody configuration trajectory..." << std::endl;
     }
@@ -567,6 +846,17 @@ bool ConfigTrajectoryGenerator::computeConfigurationTrajectory(const Eigen::Vect
 			traj_q_config.get_pos(i-1, q_current);
 			// Set the starting configuration for the IK
 			setCurrentConfig(q_current);
+			// Predictor: extrapolate the seed from the two previous solutions. q_current stays the latest solution.
+			if (use_predictor_warm_start && (i > 1)){
+				traj_q_config.get_pos(i-2, q_prev);
+				robot_model->configDifference(q_prev, q_current, dq_predictor);
+				robot_model->forwardIntegrate(q_current, predictor_gain*dq_predictor, q_seed);
+				// Only the joint positions are clamped. The floating base quaternion must stay normalized.
+				int num_joints = robot_model->getDimQ() - VAL_MODEL_NUM_FLOATING_JOINTS;
+				q_seed.tail(num_joints) = q_seed.tail(num_joints).cwiseMax(robot_model->q_lower_pos_limit.tail(num_joints))
+				                                                 .cwiseMin(robot_model->q_upper_pos_limit.tail(num_joints));
+				ik_to_use_module->setInitialConfig(q_seed);
+			}
 			// Update robot kinematics
 			robot_model->updateFullKinematics(q_current);			
 		}
@@ -597,6 +887,8 @@ bool ConfigTrajectoryGenerator::computeConfigurationTrajectory(const Eigen::Vect
 
 		// Compute IK
 		primary_task_convergence = ik_to_use_module->solveIK(solve_result, task_error_norms, total_error_norm, q_sol);
+		last_traj_ik_iters.push_back(ik_to_use_module->getLastNumIterations());
+		last_traj_ik_minor_iters.push_back(ik_to_use_module->getLastNumMinorIterations());
 
 		// Update max first task ik error.
 		if (task_error_norms[0] >= max_first_task_ik_error){
@@ -613,6 +905,17 @@ bool ConfigTrajectoryGenerator::computeConfigurationTrajectory(const Eigen::Vect
 			ik_to_use_module->printSolutionResults();
 		}
 
+		// Cold start baseline: solve the predicted points again from q_{i-1} only
+		if (record_cold_start_iterations){
+			if (use_predictor_warm_start && (i > 1)){
+				ik_to_use_module->setInitialConfig(q_current);
+				ik_to_use_module->solveIK(cold_start_solve_result, cold_start_task_error_norms, cold_start_total_error_norm, q_cold_start_sol);
+				last_traj_cold_start_ik_iters.push_back(ik_to_use_module->getLastNumIterations());
+			}else{
+				last_traj_cold_start_ik_iters.push_back(last_traj_ik_iters.back());
+			}
+		}
+
 		// If converged or continue solving with partial error divergence
 		if ((didTrajectoryConverge()) || (solve_with_partial_divergence)){
 			q_current = q_sol;
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <avatar_locomanipulation/models/robot_model.hpp>
+#include <avatar_locomanipulation/collision_environment/collision_environment.h>
+
+#include "pinocchio/utils/timer.hpp"
+
+// Fits the capsule proxies of the Valkyrie collision bodies (with --fit), then compares the proxy
+// distances and jacobians of the right palm against the mesh distances.
+
+void initialize_config(std::shared_ptr<RobotModel> & valkyrie, Eigen::VectorXd & q_start){
+  q_start = Eigen::VectorXd::Zero(valkyrie->getDimQ());
+  q_start[6] = 1.0; // identity quaternion
+  q_start[2] = 1.0; // pelvis height
+
+  q_start[valkyrie->getJointIndex("leftHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("leftKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("rightKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("leftAnklePitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightAnklePitch")] = -0.3;
+
+  // Right palm close to the pelvis
+  q_start[valkyrie->getJointIndex("rightShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("rightShoulderRoll")] = 0.9;
+  q_start[valkyrie->getJointIndex("rightElbowPitch")] = 1.2;
+  q_start[valkyrie->getJointIndex("rightForearmYaw")] = 1.5;
+
+  q_start[valkyrie->getJointIndex("leftShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("leftShoulderRoll")] = -1.1;
+  q_start[valkyrie->getJointIndex("leftElbowPitch")] = -0.4;
+  q_start[valkyrie->getJointIndex("leftForearmYaw")] = 1.5;
+}
+
+// Magnitude of the directed vector coming from the frame from_name, -1 if there is none
+double get_magnitude(std::shared_ptr<CollisionEnvironment> & collision, const std::string & from_name, DirectedVectors & dvec){
+  for(int i = 0; i < collision->directed_vectors.size(); i++){
+    if (collision->directed_vectors[i].from == from_name){
+      dvec = collision->directed_vectors[i];
+      return dvec.magnitude;
+    }
+  }
+  return -1.0;
+}
+
+int main(int argc, char ** argv){
+  std::string urdf_filename = THIS_PACKAGE_PATH"models/valkyrie_simplified_collisions.urdf";
+  std::string srdf_filename = THIS_PACKAGE_PATH"models/valkyrie_disable_collisions.srdf";
+  std::string meshDir = THIS_PACKAGE_PATH"../val_model/";
+  std::string proxy_filename = THIS_PACKAGE_PATH"models/valkyrie_collision_proxies.yaml";
+
+  std::shared_ptr<RobotModel> valkyrie(new RobotModel(urdf_filename, meshDir, srdf_filename));
+  std::shared_ptr<CollisionEnvironment> collision(new CollisionEnvironment(valkyrie));
+
+  if ((argc > 1) && (std::string(argv[1]) == "--fit")){
+    std::cout << "Fitting the proxies to " << proxy_filename << std::endl;
+    collision->fit_link_proxies(proxy_filename);
+  }
+  collision->load_link_proxies(proxy_filename);
+
+  Eigen::VectorXd q_start;
+  initialize_config(valkyrie, q_start);
+  valkyrie->updateFullKinematics(q_start);
+
+  PinocchioTicToc timer = PinocchioTicToc(PinocchioTicToc::MS);
+  int num_queries = 1000;
+
+  // Mesh distances
+  collision->enable_proxy_geometry(false);
+  timer.tic();
+  for(int i = 0; i < num_queries; i++){
+    collision->directed_vectors.clear();
+    collision->build_self_directed_vectors("rightPalm", q_start);
+  }
+  double mesh_time = timer.toc(PinocchioTicToc::MS)/num_queries;
+  std::vector<DirectedVectors> mesh_vectors = collision->directed_vectors;
+
+  // Proxy distances
+  collision->enable_proxy_geometry(true);
+  collision->reset_pair_counters();
+  timer.tic();
+  for(int i = 0; i < num_queries; i++){
+    collision->directed_vectors.clear();
+    collision->build_self_directed_vectors("rightPalm", q_start);
+  }
+  double proxy_time = timer.toc(PinocchioTicToc::MS)/num_queries;
+  collision->print_pair_counters();
+
+  // The proxies cover the collision geometry, so their distances are smaller than the mesh distances
+  DirectedVectors dvec;
+  int num_not_conservative = 0;
+  for(int i = 0; i < mesh_vectors.size(); i++){
+    double proxy_distance = get_magnitude(collision, mesh_vectors[i].from, dvec);
+    std::cout << "  " << mesh_vectors[i].from << " mesh: " << mesh_vectors[i].magnitude << " proxy: " << proxy_distance << std::endl;
+    if (proxy_distance > mesh_vectors[i].magnitude + 1e-6){
+      num_not_conservative++;
+    }
+  }
+  std::cout << "Time per query: mesh " << mesh_time << "ms, proxy " << proxy_time << "ms" << std::endl;
+  std::cout << "Proxy distances larger than the mesh distance: " << num_not_conservative << std::endl;
+
+  // Jacobian of the closest proxy distance against a finite difference
+  collision->directed_vectors.clear();
+  collision->build_self_directed_vectors("rightPalm", q_start);
+  collision->get_collision_potential();
+  dvec = collision->directed_vectors[collision->closest];
+
+  Eigen::MatrixXd J_from, J_to;
+  valkyrie->updateFullKinematics(q_start);
+  collision->get_point_jacobians(valkyrie, dvec, J_from, J_to);
+
+  Eigen::VectorXd dq = Eigen::VectorXd::Random(valkyrie->getDimQdot());
+  dq.head(6).setZero();
+  double eps = 1e-6;
+  Eigen::VectorXd q_step;
+  valkyrie->forwardIntegrate(q_start, eps*dq, q_step);
+
+  collision->directed_vectors.clear();
+  collision->build_self_directed_vectors("rightPalm", q_step);
+  DirectedVectors dvec_step;
+  double magnitude_step = get_magnitude(collision, dvec.from, dvec_step);
+
+  double analytic = dvec.direction.dot((J_to - J_from)*dq);
+  double numeric = (magnitude_step - dvec.magnitude)/eps;
+  std::cout << "Closest pair " << dvec.from << " - " << dvec.to << " distance rate analytic: " << analytic << " numeric: " << numeric << std::endl;
+
+  return 0;
+}
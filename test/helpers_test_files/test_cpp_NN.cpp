@@ -1,4 +1,5 @@
 #include <avatar_locomanipulation/helpers/NeuralNetModel.hpp>
+#include <avatar_locomanipulation/helpers/FixedNeuralNet.hpp>
 
 # include <cstdlib>
 # include <iostream>
@@ -55,6 +56,10 @@ int main(int argc, char ** argv){
   NeuralNetModel nn_transition(model, false);
   std::cout << "Loaded" << std::endl;
 
+  // Same parameters with the layer sizes fixed at compile time
+  NeuralNetModel nn_transition_fixed(model, false);
+  nn_transition_fixed.SetFixedNetwork(FixedNeuralNet<32, 64, 64, 64, 1>::Create(model));
+
   double stance_origin = CONTACT_TRANSITION_DATA_LEFT_FOOT_STANCE;
   double manipulation_type = CONTACT_TRANSITION_DATA_RIGHT_HAND;
 
@@ -144,6 +149,28 @@ int main(int argc, char ** argv){
     std::cout << " freq = " << (1.0/time_span) << " Hz" << std::endl;
     std::cout << " " << std::endl;
 
+    // Allocation free inference with preallocated workspaces
+    t1 = Clock::now();    
+    nn_transition.Infer(data, pred);
+    t2 = Clock::now();
+
+    time_span = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+    std::cout << "  " << input_size << " Infer pred = " << pred.transpose() << std::endl;
+    std::cout << " inference time = " << time_span << " seconds" << std::endl;
+    std::cout << " freq = " << (1.0/time_span) << " Hz" << std::endl;
+    std::cout << " " << std::endl;
+
+    // Fixed topology inference. Falls back to the dynamic path if the model sizes differ
+    t1 = Clock::now();    
+    nn_transition_fixed.Infer(data, pred);
+    t2 = Clock::now();
+
+    time_span = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+    std::cout << "  " << input_size << " Fixed Infer pred = " << pred.transpose() << std::endl;
+    std::cout << " inference time = " << time_span << " seconds" << std::endl;
+    std::cout << " freq = " << (1.0/time_span) << " Hz" << std::endl;
+    std::cout << " " << std::endl;
+
   }
 
 
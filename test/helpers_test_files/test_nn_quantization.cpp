@@ -0,0 +1,157 @@
+#include <avatar_locomanipulation/helpers/NeuralNetModel.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <avatar_locomanipulation/helpers/IOUtilities.hpp>
+#include <avatar_locomanipulation/helpers/param_handler.hpp>
+#include <Eigen/Dense>
+
+#include <chrono>
+typedef std::chrono::high_resolution_clock Clock;
+
+#define CONTACT_TRANSITION_DATA_LEFT_FOOT_STANCE 0
+#define CONTACT_TRANSITION_DATA_RIGHT_FOOT_STANCE 1
+
+#define CONTACT_TRANSITION_DATA_LEFT_HAND 0
+#define CONTACT_TRANSITION_DATA_RIGHT_HAND 1
+#define CONTACT_TRANSITION_DATA_BOTH_HANDS 2
+
+// Calibrates the int8 classifier on stored transition data and reports the drift of
+// the float32 and int8 inference modes against the double model on a held out evaluation split.
+// Usage: test_nn_quantization transition_data_1.yaml transition_data_2.yaml ...
+// eg: test_nn_quantization ~/Data/param_set_1/right_hand/transitions_data_with_task_space_info/*/*.yaml
+// Every EVALUATION_SPLIT_PERIOD-th file is held out for the evaluation. The remaining files are used for the calibration.
+#define EVALUATION_SPLIT_PERIOD 5
+
+Eigen::Vector3d quatToVec(const Eigen::Quaterniond & ori){
+  Eigen::AngleAxisd tmp_ori(ori.normalized()); // gets the normalized version of ori and sets it to an angle axis representation
+  Eigen::Vector3d ori_vec = tmp_ori.axis()*tmp_ori.angle();
+  return ori_vec;
+}
+
+void getParamPos(ParamHandler & param_handler, const std::string param_name, Eigen::Vector3d & pos){
+  param_handler.getNestedValue({param_name, "x"}, pos[0]);
+  param_handler.getNestedValue({param_name, "y"}, pos[1]);
+  param_handler.getNestedValue({param_name, "z"}, pos[2]);  
+}
+
+void getParamOri(ParamHandler & param_handler, const std::string param_name, Eigen::Quaterniond & ori){
+  param_handler.getNestedValue({param_name, "x"}, ori.x());
+  param_handler.getNestedValue({param_name, "y"}, ori.y());
+  param_handler.getNestedValue({param_name, "z"}, ori.z());  
+  param_handler.getNestedValue({param_name, "w"}, ori.w());      
+}
+
+// Builds the raw classifier datum from a transition stored by the planner or the data generator
+void loadTransitionDatum(const std::string & filepath, Eigen::VectorXd & rawDatum){
+  ParamHandler param_handler;
+  param_handler.load_yaml_file(filepath);
+
+  std::string stance_origin, manipulation_type;
+  param_handler.getString("stance_origin", stance_origin);
+  param_handler.getString("manipulation_type", manipulation_type);
+
+  Eigen::Vector3d swing_foot_start_pos, pelvis_pos, landing_foot_pos, right_hand_start_pos, left_hand_start_pos;
+  Eigen::Quaterniond swing_foot_start_ori, pelvis_ori, landing_foot_ori, right_hand_start_ori, left_hand_start_ori;
+  getParamPos(param_handler, "swing_foot_starting_position", swing_foot_start_pos);
+  getParamOri(param_handler, "swing_foot_starting_orientation", swing_foot_start_ori);
+  getParamPos(param_handler, "pelvis_starting_position", pelvis_pos);
+  getParamOri(param_handler, "pelvis_starting_orientation", pelvis_ori);
+  getParamPos(param_handler, "landing_foot_position", landing_foot_pos);
+  getParamOri(param_handler, "landing_foot_orientation", landing_foot_ori);
+  getParamPos(param_handler, "right_hand_starting_position", right_hand_start_pos);
+  getParamOri(param_handler, "right_hand_starting_orientation", right_hand_start_ori);
+  getParamPos(param_handler, "left_hand_starting_position", left_hand_start_pos);
+  getParamOri(param_handler, "left_hand_starting_orientation", left_hand_start_ori);
+
+  double stance = (stance_origin.compare("left_foot") == 0) ? CONTACT_TRANSITION_DATA_LEFT_FOOT_STANCE : CONTACT_TRANSITION_DATA_RIGHT_FOOT_STANCE;
+  double manipulation = CONTACT_TRANSITION_DATA_RIGHT_HAND;
+  if (manipulation_type.compare("left_hand") == 0){
+    manipulation = CONTACT_TRANSITION_DATA_LEFT_HAND;
+  }else if (manipulation_type.compare("both_hands") == 0){
+    manipulation = CONTACT_TRANSITION_DATA_BOTH_HANDS;
+  }
+
+  rawDatum << stance, manipulation,
+    swing_foot_start_pos, quatToVec(swing_foot_start_ori),
+    pelvis_pos, quatToVec(pelvis_ori),
+    landing_foot_pos, quatToVec(landing_foot_ori),
+    right_hand_start_pos, quatToVec(right_hand_start_ori),
+    left_hand_start_pos, quatToVec(left_hand_start_ori);
+}
+
+int main(int argc, char ** argv){
+  std::vector<std::string> data_files;
+  for(int i = 1; i < argc; i++){
+    data_files.push_back(argv[i]);
+  }
+  if (data_files.size() < 2){
+    std::cerr << "[test_nn_quantization] Error. Requires a list of at least 2 transition data files (calibration and evaluation splits)." << std::endl;
+    std::cerr << "  Usage: test_nn_quantization transition_data_1.yaml transition_data_2.yaml ..." << std::endl;
+    return 1;
+  }
+
+  std::string model_path = THIS_PACKAGE_PATH"nn_models/layer3_20000pts/cpp_model/layer3_model.yaml";
+  std::cout << "Loading Model..." << std::endl;
+  myYAML::Node model = myYAML::LoadFile(model_path);
+  NeuralNetModel nn_transition(model, false);
+  std::cout << "Loaded" << std::endl;
+
+  //Normalization Params
+  ParamHandler param_handler;
+  param_handler.load_yaml_file(THIS_PACKAGE_PATH"nn_models/layer3_20000pts/cpp_model/normalization_params.yaml");
+  std::vector<double> vmean;
+  param_handler.getVector("x_train_mean", vmean);
+  std::vector<double> vstd_dev;
+  param_handler.getVector("x_train_std", vstd_dev);
+
+  Eigen::VectorXd mean(32);
+  Eigen::VectorXd std_dev(32);
+  for (int ii = 0; ii < 32; ii++){
+    mean[ii] = vmean[ii];
+    std_dev[ii] = vstd_dev[ii];
+  }
+
+  // Normalized transition data. One datum per row
+  int num_evaluation = (data_files.size() + EVALUATION_SPLIT_PERIOD - 1) / EVALUATION_SPLIT_PERIOD;
+  int num_calibration = data_files.size() - num_evaluation;
+  Eigen::VectorXd rawDatum(32);
+  Eigen::MatrixXd calibration_data(num_calibration, 32);
+  Eigen::MatrixXd data(num_evaluation, 32);
+  int calibration_row = 0;
+  int evaluation_row = 0;
+  for(int i = 0; i < data_files.size(); i++){
+    loadTransitionDatum(data_files[i], rawDatum);
+    if ((i % EVALUATION_SPLIT_PERIOD) == 0){
+      data.row(evaluation_row) = (rawDatum - mean).cwiseQuotient(std_dev);
+      evaluation_row++;
+    }else{
+      calibration_data.row(calibration_row) = (rawDatum - mean).cwiseQuotient(std_dev);
+      calibration_row++;
+    }
+  }
+  std::cout << "Calibration split: " << num_calibration << " transitions. Evaluation split: " << num_evaluation << " transitions." << std::endl;
+
+  nn_transition.Calibrate(calibration_data);
+  nn_transition.ReportPrecisionDrift(data, 0.5);
+
+  // Compare inference times on the evaluation split
+  Eigen::MatrixXd pred(data.rows(), 1);
+  std::vector<InferencePrecision> modes = {DoublePrecision, SinglePrecision, Int8Quantized};
+  std::vector<std::string> mode_names = {"double", "float32", "int8"};
+  int num_runs = 1000;
+  for(int m = 0; m < modes.size(); m++){
+    nn_transition.SetInferencePrecision(modes[m]);
+    auto t1 = Clock::now();
+    for(int i = 0; i < num_runs; i++){
+      nn_transition.Infer(data, pred);
+    }
+    auto t2 = Clock::now();
+    double time_span = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+    std::cout << mode_names[m] << " inference time per batch = " << (time_span/num_runs) << " seconds" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <avatar_locomanipulation/ik_module/batch_ik_solver.hpp>
+
+#include <avatar_locomanipulation/tasks/task_6dpose.hpp>
+#include <avatar_locomanipulation/tasks/task_joint_config.hpp>
+#include <avatar_locomanipulation/tasks/task_stack.hpp>
+
+#include <omp.h>
+
+void initialize_config(std::shared_ptr<RobotModel> & valkyrie, Eigen::VectorXd & q_start){
+  q_start = Eigen::VectorXd::Zero(valkyrie->getDimQ());
+  q_start[6] = 1.0; // identity quaternion
+  q_start[2] = 1.0; // pelvis height
+
+  q_start[valkyrie->getJointIndex("leftHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("leftKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("rightKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("leftAnklePitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightAnklePitch")] = -0.3;
+
+  q_start[valkyrie->getJointIndex("rightShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("rightShoulderRoll")] = 1.1;
+  q_start[valkyrie->getJointIndex("rightElbowPitch")] = 0.4;
+  q_start[valkyrie->getJointIndex("rightForearmYaw")] = 1.5;
+
+  q_start[valkyrie->getJointIndex("leftShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("leftShoulderRoll")] = -1.1;
+  q_start[valkyrie->getJointIndex("leftElbowPitch")] = -0.4;
+  q_start[valkyrie->getJointIndex("leftForearmYaw")] = 1.5;
+}
+
+// Builds the same IK problem on the given model: feet fixed, right palm pose, then posture.
+// The right palm task is returned as reference task 0.
+std::shared_ptr<IKModule> build_ik_problem(std::shared_ptr<RobotModel> & robot_model, const Eigen::VectorXd & q_start, std::vector< std::shared_ptr<Task> > & reference_tasks){
+  std::shared_ptr<Task> lfoot_task(new Task6DPose(robot_model, "leftCOP_Frame"));
+  std::shared_ptr<Task> rfoot_task(new Task6DPose(robot_model, "rightCOP_Frame"));
+  std::shared_ptr<Task> rpalm_task(new Task6DPose(robot_model, "rightPalm"));
+  std::shared_ptr<Task> posture_task(new TaskJointConfig(robot_model, robot_model->joint_names));
+  posture_task->setTaskGain(1e-1);
+
+  // Feet and posture references are the starting configuration
+  Eigen::Vector3d pos;
+  Eigen::Quaterniond ori;
+  robot_model->updateFullKinematics(q_start);
+  robot_model->getFrameWorldPose("leftCOP_Frame", pos, ori);
+  lfoot_task->setReference(pos, ori);
+  robot_model->getFrameWorldPose("rightCOP_Frame", pos, ori);
+  rfoot_task->setReference(pos, ori);
+  posture_task->setReference(q_start.tail(robot_model->getDimQ() - VAL_MODEL_NUM_FLOATING_JOINTS));
+
+  std::shared_ptr<Task> feet_stack(new TaskStack(robot_model, {lfoot_task, rfoot_task}));
+
+  std::shared_ptr<IKModule> ik_module(new IKModule(robot_model));
+  ik_module->setVerbosityLevel(IK_VERBOSITY_LOW);
+  ik_module->addTasktoHierarchy(feet_stack);
+  ik_module->addTasktoHierarchy(rpalm_task);
+  ik_module->addTasktoHierarchy(posture_task);
+
+  reference_tasks.clear();
+  reference_tasks.push_back(rpalm_task);
+  return ik_module;
+}
+
+int main(int argc, char ** argv){
+  int num_jobs = 2000;
+  int num_workers = omp_get_max_threads();
+
+  std::string urdf_filename = THIS_PACKAGE_PATH"models/valkyrie_simplified_collisions.urdf";
+  std::string srdf_filename = THIS_PACKAGE_PATH"models/valkyrie_disable_collisions.srdf";
+  std::string meshDir_  = THIS_PACKAGE_PATH"../val_model/";
+  std::shared_ptr<RobotModel> valkyrie(new RobotModel(urdf_filename, meshDir_, srdf_filename));
+
+  Eigen::VectorXd q_start;
+  initialize_config(valkyrie, q_start);
+
+  // Right palm targets around the starting palm pose
+  Eigen::Vector3d rpalm_pos;
+  Eigen::Quaterniond rpalm_ori;
+  valkyrie->updateFullKinematics(q_start);
+  valkyrie->getFrameWorldPose("rightPalm", rpalm_pos, rpalm_ori);
+
+  std::srand(0);
+  std::vector<BatchIKJob> jobs;
+  for(int i = 0; i < num_jobs; i++){
+    Eigen::Vector3d offset = 0.15*Eigen::Vector3d::Random();
+    Eigen::VectorXd des_pos = rpalm_pos + offset;
+    BatchIKJob job(q_start);
+    job.addReference(0, des_pos, rpalm_ori);
+    jobs.push_back(job);
+  }
+
+  // Serial solver with a single worker
+  BatchIKSolver serial_solver;
+  std::vector< std::shared_ptr<Task> > reference_tasks;
+  std::shared_ptr<RobotModel> serial_context(new RobotModelContext(valkyrie));
+  std::shared_ptr<IKModule> serial_ik = build_ik_problem(serial_context, q_start, reference_tasks);
+  serial_solver.addWorker(serial_context, serial_ik, reference_tasks);
+
+  std::vector<BatchIKResult> serial_results;
+  serial_solver.solve(jobs, serial_results);
+  serial_solver.printLastBatchStats();
+
+  // Parallel solver with one worker per thread
+  BatchIKSolver batch_solver;
+  for(int i = 0; i < num_workers; i++){
+    std::shared_ptr<RobotModel> context(new RobotModelContext(valkyrie));
+    std::shared_ptr<IKModule> ik_module = build_ik_problem(context, q_start, reference_tasks);
+    batch_solver.addWorker(context, ik_module, reference_tasks);
+  }
+
+  std::vector<BatchIKResult> batch_results;
+  batch_solver.solve(jobs, batch_results);
+  batch_solver.printLastBatchStats();
+
+  // Results must not depend on the number of workers
+  double max_diff = 0.0;
+  int num_mismatch = 0;
+  for(int i = 0; i < jobs.size(); i++){
+    max_diff = std::max(max_diff, (serial_results[i].q_sol - batch_results[i].q_sol).cwiseAbs().maxCoeff());
+    if ((serial_results[i].solve_result != batch_results[i].solve_result) || (serial_results[i].num_iters != batch_results[i].num_iters)){
+      num_mismatch++;
+    }
+  }
+  std::cout << "max |q_serial - q_batch| = " << max_diff << ", mismatched results: " << num_mismatch << std::endl;
+  std::cout << "speedup: " << serial_solver.getLastBatchTime() / batch_solver.getLastBatchTime() << " with " << num_workers << " workers" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include <avatar_locomanipulation/walking/config_trajectory_generator.hpp>
+
+// Standard
+#include <iostream>
+#include <math.h>
+
+#include <omp.h>
+
+// Timer
+#include <chrono>
+typedef std::chrono::high_resolution_clock Clock;
+
+// Computes the flat ground initial configurations of many guesses serially and as a batch
+// and checks that both give the same results. Then runs the multi-start IK on the first guess.
+
+void initialize_config(Eigen::VectorXd & q_init, std::shared_ptr<RobotModel> & valkyrie){
+  Eigen::VectorXd q_start = Eigen::VectorXd::Zero(valkyrie->getDimQ());
+  q_start[6] = 1.0; // identity quaternion
+  q_start[2] = 1.0; // pelvis height
+
+  q_start[valkyrie->getJointIndex("leftHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("leftKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("rightKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("leftAnklePitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightAnklePitch")] = 0.0;
+
+  q_start[valkyrie->getJointIndex("rightShoulderPitch")] = 0.2;
+  q_start[valkyrie->getJointIndex("rightShoulderRoll")] = 1.1;
+  q_start[valkyrie->getJointIndex("rightElbowPitch")] = 1.0;
+  q_start[valkyrie->getJointIndex("rightForearmYaw")] = 1.5;
+
+  q_start[valkyrie->getJointIndex("leftShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("leftShoulderRoll")] = -1.1;
+  q_start[valkyrie->getJointIndex("leftElbowPitch")] = -0.4;
+  q_start[valkyrie->getJointIndex("leftForearmYaw")] = 1.5;
+
+  q_init = q_start;
+}
+
+int main(int argc, char ** argv){
+  int num_guesses = 32;
+  int num_threads = omp_get_max_threads();
+
+  std::string urdf_filename = THIS_PACKAGE_PATH"models/valkyrie_no_fingers.urdf";
+  std::shared_ptr<RobotModel> valkyrie_model(new RobotModel(urdf_filename));
+
+  Eigen::VectorXd q_start;
+  initialize_config(q_start, valkyrie_model);
+
+  // Guesses around the starting configuration: pelvis height and leg joints perturbed
+  std::vector<std::string> leg_joint_names = {"leftHipPitch", "rightHipPitch", "leftKneePitch", "rightKneePitch", "leftAnklePitch", "rightAnklePitch"};
+  std::srand(0);
+  std::vector<Eigen::VectorXd> q_guess_list;
+  for(int i = 0; i < num_guesses; i++){
+    Eigen::VectorXd q_guess = q_start;
+    q_guess[2] += 0.05*Eigen::VectorXd::Random(1)[0];
+    for(int j = 0; j < leg_joint_names.size(); j++){
+      q_guess[valkyrie_model->getJointIndex(leg_joint_names[j])] += 0.1*Eigen::VectorXd::Random(1)[0];
+    }
+    q_guess_list.push_back(q_guess);
+  }
+
+  // Serial: one guess at a time
+  ConfigTrajectoryGenerator serial_ctg(valkyrie_model, 60);
+  serial_ctg.setVerbosityLevel(CONFIG_TRAJECTORY_VERBOSITY_LEVEL_0);
+  std::vector<Eigen::VectorXd> serial_q_out(num_guesses);
+  std::vector<bool> serial_convergence(num_guesses);
+  auto t1 = Clock::now();
+  for(int i = 0; i < num_guesses; i++){
+    serial_convergence[i] = serial_ctg.computeInitialConfigForFlatGround(q_guess_list[i], serial_q_out[i]);
+  }
+  auto t2 = Clock::now();
+  double serial_time = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+
+  // Batched: all guesses with one worker per thread
+  ConfigTrajectoryGenerator batch_ctg(valkyrie_model, 60);
+  batch_ctg.setVerbosityLevel(CONFIG_TRAJECTORY_VERBOSITY_LEVEL_0);
+  batch_ctg.setNumInitialConfigThreads(num_threads);
+  std::vector<Eigen::VectorXd> batch_q_out;
+  std::vector<bool> batch_convergence;
+  t1 = Clock::now();
+  int num_converged = batch_ctg.computeInitialConfigsForFlatGround(q_guess_list, batch_q_out, batch_convergence);
+  t2 = Clock::now();
+  double batch_time = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+
+  // Results must not depend on the number of threads
+  double max_diff = 0.0;
+  int num_mismatch = 0;
+  for(int i = 0; i < num_guesses; i++){
+    max_diff = std::max(max_diff, (serial_q_out[i] - batch_q_out[i]).cwiseAbs().maxCoeff());
+    if (serial_convergence[i] != batch_convergence[i]){
+      num_mismatch++;
+    }
+  }
+  std::cout << "converged: " << num_converged << " / " << num_guesses << std::endl;
+  std::cout << "max |q_serial - q_batch| = " << max_diff << ", mismatched convergence: " << num_mismatch << std::endl;
+  std::cout << "serial time = " << serial_time << " seconds, batch time = " << batch_time << " seconds with " << num_threads << " threads" << std::endl;
+
+  // Multi-start on the first guess
+  Eigen::VectorXd q_multi_start;
+  batch_ctg.setInitialConfigMultiStart(num_threads, 0.2);
+  bool multi_start_convergence = batch_ctg.computeInitialConfigForFlatGround(q_guess_list[0], q_multi_start);
+  std::cout << "multi-start convergence = " << (multi_start_convergence ? "true" : "false") << ", seed = " << batch_ctg.getLastInitialConfigSeedIdx() << std::endl;
+
+  if ((max_diff > 1e-9) || (num_mismatch > 0)){
+    std::cout << "[FAILED] the serial and batched initial configurations differ" << std::endl;
+    return 1;
+  }
+  std::cout << "[PASSED] the serial and batched initial configurations match" << std::endl;
+  return 0;
+}
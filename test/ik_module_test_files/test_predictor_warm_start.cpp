@@ -0,0 +1,101 @@
+#include <avatar_locomanipulation/walking/config_trajectory_generator.hpp>
+
+// Standard
+#include <iostream>
+#include <math.h>
+#include <numeric>
+
+// Computes a walking configuration trajectory with the predictor warm start and the cold start baseline,
+// reports the IK iterations saved by the predictor, and checks that recording the baseline does not change the trajectory.
+
+void initialize_config(Eigen::VectorXd & q_init, std::shared_ptr<RobotModel> & valkyrie){
+  Eigen::VectorXd q_start = Eigen::VectorXd::Zero(valkyrie->getDimQ());
+  q_start[6] = 1.0; // identity quaternion
+  q_start[2] = 1.0; // pelvis height
+
+  q_start[valkyrie->getJointIndex("leftHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("leftKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("rightKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("leftAnklePitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightAnklePitch")] = -0.3;
+
+  q_start[valkyrie->getJointIndex("rightShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("rightShoulderRoll")] = 1.1;
+  q_start[valkyrie->getJointIndex("rightElbowPitch")] = 0.4;
+  q_start[valkyrie->getJointIndex("rightForearmYaw")] = 1.5;
+
+  q_start[valkyrie->getJointIndex("leftShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("leftShoulderRoll")] = -1.1;
+  q_start[valkyrie->getJointIndex("leftElbowPitch")] = -0.4;
+  q_start[valkyrie->getJointIndex("leftForearmYaw")] = 1.5;
+
+  q_init = q_start;
+}
+
+// Walks two steps forward and outputs the configuration trajectory
+bool compute_walking_trajectory(ConfigTrajectoryGenerator & ctg, std::shared_ptr<RobotModel> & valkyrie_model, const Eigen::VectorXd & q_start,
+                                std::vector<Eigen::VectorXd> & traj_q){
+  valkyrie_model->updateFullKinematics(q_start);
+  Footstep footstep_1; footstep_1.setRightSide();
+  Footstep footstep_2; footstep_2.setLeftSide();
+  valkyrie_model->getFrameWorldPose("rightCOP_Frame", footstep_1.position, footstep_1.orientation);
+  valkyrie_model->getFrameWorldPose("leftCOP_Frame", footstep_2.position, footstep_2.orientation);
+  footstep_1.position[0] += 0.2;
+  footstep_2.position[0] += 0.2;
+  std::vector<Footstep> input_footstep_list = {footstep_1, footstep_2};
+
+  bool convergence = ctg.computeConfigurationTrajectory(q_start, input_footstep_list);
+
+  traj_q.clear();
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(valkyrie_model->getDimQ());
+  for(int i = 0; i < ctg.traj_q_config.get_trajectory_length(); i++){
+    ctg.traj_q_config.get_pos(i, q);
+    traj_q.push_back(q);
+  }
+  return convergence;
+}
+
+int main(int argc, char ** argv){
+  std::string urdf_filename = THIS_PACKAGE_PATH"models/valkyrie_no_fingers.urdf";
+  std::shared_ptr<RobotModel> valkyrie_model(new RobotModel(urdf_filename));
+
+  int N_resolution = 60;
+  ConfigTrajectoryGenerator ctg(valkyrie_model, N_resolution);
+  ctg.setVerbosityLevel(CONFIG_TRAJECTORY_VERBOSITY_LEVEL_1);
+
+  Eigen::VectorXd q_guess, q_start;
+  initialize_config(q_guess, valkyrie_model);
+  ctg.computeInitialConfigForFlatGround(q_guess, q_start);
+
+  // Predictor warm start without the baseline
+  std::vector<Eigen::VectorXd> traj_q, traj_q_with_baseline;
+  ctg.setUsePredictorWarmStart(true);
+  bool convergence = compute_walking_trajectory(ctg, valkyrie_model, q_start, traj_q);
+  std::vector<int> warm_start_iters = ctg.getLastTrajectoryIKIterations();
+
+  // Predictor warm start with the cold start baseline
+  ctg.setRecordColdStartIterations(true);
+  bool convergence_with_baseline = compute_walking_trajectory(ctg, valkyrie_model, q_start, traj_q_with_baseline);
+  const std::vector<int> & cold_start_iters = ctg.getLastTrajectoryColdStartIKIterations();
+
+  int total_warm_start_iters = std::accumulate(warm_start_iters.begin(), warm_start_iters.end(), 0);
+  int total_cold_start_iters = std::accumulate(cold_start_iters.begin(), cold_start_iters.end(), 0);
+  std::cout << "IK iterations over the trajectory: predictor = " << total_warm_start_iters << ", cold start = " << total_cold_start_iters
+            << ", saved = " << ctg.getLastTrajectoryIKIterationSavings() << " over " << ctg.getLastTrajectoryNumIKSolves() << " solves" << std::endl;
+
+  // The baseline solves must not change the trajectory
+  bool match = (convergence == convergence_with_baseline) && (traj_q.size() == traj_q_with_baseline.size()) && (warm_start_iters == ctg.getLastTrajectoryIKIterations());
+  double max_diff = 0.0;
+  for(int i = 0; match && (i < traj_q.size()); i++){
+    max_diff = std::max(max_diff, (traj_q[i] - traj_q_with_baseline[i]).cwiseAbs().maxCoeff());
+  }
+  std::cout << "max |q - q_with_baseline| = " << max_diff << std::endl;
+
+  if (!match || (max_diff > 1e-9) || (cold_start_iters.size() != warm_start_iters.size())){
+    std::cout << "[FAILED] recording the cold start baseline changed the trajectory" << std::endl;
+    return 1;
+  }
+  std::cout << "[PASSED] the cold start baseline does not change the trajectory" << std::endl;
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <avatar_locomanipulation/models/robot_model.hpp>
+#include <avatar_locomanipulation/ik_module/ik_module.hpp>
+#include <avatar_locomanipulation/tasks/task_6dpose.hpp>
+#include <avatar_locomanipulation/tasks/task_joint_config.hpp>
+#include <avatar_locomanipulation/tasks/task_stack.hpp>
+
+#include "pinocchio/utils/timer.hpp"
+
+void initialize_config(std::shared_ptr<RobotModel> & valkyrie, Eigen::VectorXd & q_start){
+  q_start = Eigen::VectorXd::Zero(valkyrie->getDimQ());
+  q_start[6] = 1.0; // identity quaternion
+  q_start[2] = 1.0; // pelvis height
+
+  q_start[valkyrie->getJointIndex("leftHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightHipPitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("leftKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("rightKneePitch")] = 0.6;
+  q_start[valkyrie->getJointIndex("leftAnklePitch")] = -0.3;
+  q_start[valkyrie->getJointIndex("rightAnklePitch")] = -0.3;
+
+  q_start[valkyrie->getJointIndex("rightShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("rightShoulderRoll")] = 1.1;
+  q_start[valkyrie->getJointIndex("rightElbowPitch")] = 0.4;
+  q_start[valkyrie->getJointIndex("rightForearmYaw")] = 1.5;
+
+  q_start[valkyrie->getJointIndex("leftShoulderPitch")] = -0.2;
+  q_start[valkyrie->getJointIndex("leftShoulderRoll")] = -1.1;
+  q_start[valkyrie->getJointIndex("leftElbowPitch")] = -0.4;
+  q_start[valkyrie->getJointIndex("leftForearmYaw")] = 1.5;
+}
+
+// Feet fixed, right palm moved by 10cm, then posture. Returns the solution.
+bool solve_rpalm_ik(std::shared_ptr<RobotModel> robot_model, const Eigen::VectorXd & q_start, Eigen::VectorXd & q_sol, double & solve_time){
+  std::shared_ptr<Task> lfoot_task(new Task6DPose(robot_model, "leftCOP_Frame"));
+  std::shared_ptr<Task> rfoot_task(new Task6DPose(robot_model, "rightCOP_Frame"));
+  std::shared_ptr<Task> rpalm_task(new Task6DPose(robot_model, "rightPalm"));
+  std::shared_ptr<Task> posture_task(new TaskJointConfig(robot_model, robot_model->joint_names));
+  posture_task->setTaskGain(1e-1);
+
+  Eigen::Vector3d pos;
+  Eigen::Quaterniond ori;
+  robot_model->updateFullKinematics(q_start);
+  robot_model->getFrameWorldPose("leftCOP_Frame", pos, ori);
+  lfoot_task->setReference(pos, ori);
+  robot_model->getFrameWorldPose("rightCOP_Frame", pos, ori);
+  rfoot_task->setReference(pos, ori);
+  robot_model->getFrameWorldPose("rightPalm", pos, ori);
+  pos[0] += 0.1;
+  rpalm_task->setReference(pos, ori);
+  posture_task->setReference(q_start.tail(robot_model->getDimQ() - VAL_MODEL_NUM_FLOATING_JOINTS));
+
+  std::shared_ptr<Task> feet_stack(new TaskStack(robot_model, {lfoot_task, rfoot_task}));
+
+  IKModule ik_module(robot_model);
+  ik_module.setInitialConfig(q_start);
+  ik_module.addTasktoHierarchy(feet_stack);
+  ik_module.addTasktoHierarchy(rpalm_task);
+  ik_module.addTasktoHierarchy(posture_task);
+  ik_module.prepareNewIKDataStrcutures();
+
+  int solve_result;
+  double total_error_norm;
+  std::vector<double> task_error_norms;
+
+  PinocchioTicToc timer = PinocchioTicToc(PinocchioTicToc::MS);
+  timer.tic();
+  bool convergence = ik_module.solveIK(solve_result, task_error_norms, total_error_norm, q_sol);
+  solve_time = timer.toc(PinocchioTicToc::MS);
+  ik_module.printSolutionResults();
+  return convergence;
+}
+
+int main(int argc, char ** argv){
+  std::string urdf_filename = THIS_PACKAGE_PATH"models/valkyrie_simplified_collisions.urdf";
+  std::string srdf_filename = THIS_PACKAGE_PATH"models/valkyrie_disable_collisions.srdf";
+  std::string meshDir_  = THIS_PACKAGE_PATH"../val_model/";
+  std::shared_ptr<RobotModel> valkyrie(new RobotModel(urdf_filename, meshDir_, srdf_filename));
+
+  Eigen::VectorXd q_start;
+  initialize_config(valkyrie, q_start);
+
+  // The palm task does not need the neck nor the left arm
+  std::vector<std::string> locked_joints = {"lowerNeckPitch", "neckYaw", "upperNeckPitch",
+                                            "leftShoulderPitch", "leftShoulderRoll", "leftShoulderYaw", "leftElbowPitch",
+                                            "leftForearmYaw", "leftWristRoll", "leftWristPitch"};
+  std::shared_ptr<ReducedRobotModel> valkyrie_reduced(new ReducedRobotModel(valkyrie, locked_joints, q_start));
+  std::cout << "full model nv = " << valkyrie->getDimQdot() << ", reduced model nv = " << valkyrie_reduced->getDimQdot() << std::endl;
+
+  // Mappings must round trip
+  Eigen::VectorXd q_red, q_full;
+  valkyrie_reduced->fullToReducedConfig(q_start, q_red);
+  valkyrie_reduced->reducedToFullConfig(q_red, q_full);
+  std::cout << "|q_full - q_start| = " << (q_full - q_start).norm() << std::endl;
+
+  // Frames of the reduced model must match the full model
+  Eigen::Vector3d pos_full, pos_red;
+  Eigen::Quaterniond ori_full, ori_red;
+  valkyrie->updateFullKinematics(q_start);
+  valkyrie_reduced->updateFullKinematics(q_red);
+  valkyrie->getFrameWorldPose("rightPalm", pos_full, ori_full);
+  valkyrie_reduced->getFrameWorldPose("rightPalm", pos_red, ori_red);
+  std::cout << "rightPalm position difference = " << (pos_full - pos_red).norm() << std::endl;
+
+  Eigen::VectorXd q_sol_full, q_sol_red, q_sol_red_full;
+  double time_full, time_red;
+  solve_rpalm_ik(valkyrie, q_start, q_sol_full, time_full);
+  solve_rpalm_ik(valkyrie_reduced, q_red, q_sol_red, time_red);
+  valkyrie_reduced->reducedToFullConfig(q_sol_red, q_sol_red_full);
+
+  // The reduced solution is a valid full configuration with the locked joints at their start values
+  valkyrie->updateFullKinematics(q_sol_red_full);
+  valkyrie->getFrameWorldPose("rightPalm", pos_full, ori_full);
+  std::cout << "rightPalm position of the reduced solution = " << pos_full.transpose() << std::endl;
+  std::cout << "solve time full: " << time_full << "ms, reduced: " << time_red << "ms" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+#include <avatar_locomanipulation/walking/config_trajectory_generator.hpp>
+
+// Planner
+#include <avatar_locomanipulation/planners/a_star_planner.hpp>
+#include <avatar_locomanipulation/planners/locomanipulation_a_star_planner.hpp>
+
+// YAML
+#include <avatar_locomanipulation/helpers/param_handler.hpp>
+#include <avatar_locomanipulation/data_types/manipulation_function.hpp>
+
+// Standard
+#include <iostream>
+#include <math.h>
+
+// Timer
+#include <chrono>
+typedef std::chrono::high_resolution_clock Clock;
+
+using namespace planner;
+
+// Plans the door opening trajectory with serial and with parallel edge verification
+// and checks that both searches return the same path.
+
+void load_initial_robot_door_configuration(Eigen::VectorXd & q_out, Eigen::Vector3d & hinge_pos_out, Eigen::Quaterniond & hinge_ori_out){
+  ParamHandler param_handler;
+  param_handler.load_yaml_file(THIS_PACKAGE_PATH"stored_configurations/robot_door_initial_configuration_v3.yaml");
+
+  // Get the robot configuration vector
+  std::vector<double> robot_q;
+  param_handler.getVector("robot_starting_configuration", robot_q);
+
+  // Get hinge location and orientation
+  double hinge_x, hinge_y, hinge_z, hinge_rx, hinge_ry, hinge_rz, hinge_rw;
+  param_handler.getNestedValue({"hinge_position", "x"}, hinge_x);
+  param_handler.getNestedValue({"hinge_position", "y"}, hinge_y);
+  param_handler.getNestedValue({"hinge_position", "z"}, hinge_z);
+  param_handler.getNestedValue({"hinge_orientation", "x"}, hinge_rx);
+  param_handler.getNestedValue({"hinge_orientation", "y"}, hinge_ry);
+  param_handler.getNestedValue({"hinge_orientation", "z"}, hinge_rz);
+  param_handler.getNestedValue({"hinge_orientation", "w"}, hinge_rw);
+
+  // Convert to Eigen data types
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(robot_q.size());
+  for(int i = 0; i < robot_q.size(); i++){
+    q[i] = robot_q[i];
+  }
+
+  // Set outputs
+  q_out = q;
+  hinge_pos_out = Eigen::Vector3d(hinge_x, hinge_y, hinge_z);
+  hinge_ori_out = Eigen::Quaterniond(hinge_rw, hinge_rx, hinge_ry, hinge_rz);
+}
+
+// Runs the planner and outputs the s and configuration of each vertex of the path and the configuration trajectory
+bool plan_door_opening(int num_edge_verification_threads, std::vector<double> & path_s, std::vector<Eigen::VectorXd> & path_q,
+                       std::vector<Eigen::VectorXd> & traj_q, double & time_span){
+  std::string urdf_filename = THIS_PACKAGE_PATH"models/valkyrie_no_fingers.urdf";
+  std::shared_ptr<RobotModel> valkyrie_model(new RobotModel(urdf_filename));
+
+  Eigen::VectorXd q_start_door;
+  Eigen::Vector3d hinge_position;
+  Eigen::Quaterniond hinge_orientation;
+  load_initial_robot_door_configuration(q_start_door, hinge_position, hinge_orientation);
+
+  std::string door_yaml_file = THIS_PACKAGE_PATH"hand_trajectory/door_open_trajectory_v3.yaml";
+  std::shared_ptr<ManipulationFunction> f_s_manipulate_door(new ManipulationFunction(door_yaml_file));
+  hinge_orientation.normalize();
+  f_s_manipulate_door->setWorldTransform(hinge_position, hinge_orientation);
+
+  // Use non default settings so that any setting missing in the worker ctgs changes the result
+  int N_resolution = 60;
+  std::shared_ptr<ConfigTrajectoryGenerator> ctg(new ConfigTrajectoryGenerator(valkyrie_model, N_resolution));
+  valkyrie_model->updateFullKinematics(q_start_door);
+  ctg->setUseRightHand(true);
+  ctg->setUseTorsoJointPosition(true);
+  ctg->setUseArmLowerPriorityTask(false);
+  ctg->reinitializeTaskStack();
+  ctg->wpg.setDoubleSupportTime(0.2);
+  ctg->wpg.setSettlingPercentage(0.4);
+  ctg->setManipulationOnlyTime(3.0);
+  ctg->setSolveEvenWithPartialDivergence(true);
+  ctg->setUsePredictorWarmStart(true);
+  ctg->setPredictorGain(0.8);
+  int max_iters = 60;
+  ctg->ik_locomanipulation_module->setMaxIters(max_iters);
+  ctg->setVerbosityLevel(CONFIG_TRAJECTORY_VERBOSITY_LEVEL_0);
+
+  LocomanipulationPlanner lm_planner;
+  lm_planner.initializeLocomanipulationVariables(valkyrie_model, f_s_manipulate_door, ctg);
+  if (num_edge_verification_threads > 1){
+    lm_planner.setNumEdgeVerificationWorkers(num_edge_verification_threads);
+  }
+
+  double s_init = 0.0;
+  double s_goal = 0.16;
+  shared_ptr<Node> starting_vertex (std::make_shared<LMVertex>(s_init, q_start_door));
+  shared_ptr<Node> goal_vertex (std::make_shared<LMVertex>(s_goal));
+  lm_planner.setStartNode(starting_vertex);
+  lm_planner.setGoalNode(goal_vertex);
+
+  auto t1 = Clock::now();
+  bool a_star_success = lm_planner.doAstar();
+  auto t2 = Clock::now();
+  time_span = std::chrono::duration_cast< std::chrono::duration<double> >(t2 - t1).count();
+
+  path_s.clear();
+  path_q.clear();
+  traj_q.clear();
+  if (!a_star_success){
+    return false;
+  }
+
+  shared_ptr<LMVertex> vertex;
+  for(int i = 0; i < lm_planner.forward_order_optimal_path.size(); i++){
+    vertex = static_pointer_cast<LMVertex>(lm_planner.forward_order_optimal_path[i]);
+    path_s.push_back(vertex->s);
+    path_q.push_back(vertex->q_init);
+  }
+
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(valkyrie_model->getDimQ());
+  for(int i = 0; i < lm_planner.path_traj_q_config.get_trajectory_length(); i++){
+    lm_planner.path_traj_q_config.get_pos(i, q);
+    traj_q.push_back(q);
+  }
+  return true;
+}
+
+double max_difference(const std::vector<Eigen::VectorXd> & a, const std::vector<Eigen::VectorXd> & b){
+  double max_diff = 0.0;
+  for(int i = 0; i < a.size(); i++){
+    if (a[i].size() != b[i].size()){
+      return 1e12;
+    }
+    max_diff = std::max(max_diff, (a[i] - b[i]).cwiseAbs().maxCoeff());
+  }
+  return max_diff;
+}
+
+int main(int argc, char ** argv){
+  int num_threads = 4;
+  if (argc > 1){
+    num_threads = std::atoi(argv[1]);
+  }
+
+  std::vector<double> serial_s, parallel_s;
+  std::vector<Eigen::VectorXd> serial_q, parallel_q, serial_traj, parallel_traj;
+  double serial_time, parallel_time;
+
+  bool serial_success = plan_door_opening(1, serial_s, serial_q, serial_traj, serial_time);
+  bool parallel_success = plan_door_opening(num_threads, parallel_s, parallel_q, parallel_traj, parallel_time);
+
+  std::cout << "serial   planner: success = " << serial_success << ", path size = " << serial_s.size() << ", time = " << serial_time << " seconds" << std::endl;
+  std::cout << "parallel planner: success = " << parallel_success << ", path size = " << parallel_s.size() << ", time = " << parallel_time << " seconds (" << num_threads << " threads)" << std::endl;
+
+  bool match = (serial_success == parallel_success) && (serial_s == parallel_s) && (serial_traj.size() == parallel_traj.size());
+  double max_q_diff = 0.0;
+  double max_traj_diff = 0.0;
+  if (match){
+    max_q_diff = max_difference(serial_q, parallel_q);
+    max_traj_diff = max_difference(serial_traj, parallel_traj);
+    match = (max_q_diff < 1e-9) && (max_traj_diff < 1e-9);
+  }
+  std::cout << "max vertex configuration difference = " << max_q_diff << std::endl;
+  std::cout << "max trajectory configuration difference = " << max_traj_diff << std::endl;
+
+  if (!match){
+    std::cout << "[FAILED] the serial and parallel plans differ" << std::endl;
+    return 1;
+  }
+  std::cout << "[PASSED] the serial and parallel plans match" << std::endl;
+  return 0;
+}
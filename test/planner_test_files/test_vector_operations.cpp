@@ -162,12 +162,12 @@ int main(int argc, char **argv){
     xy_planner.setStartNode(v_start);
     xy_planner.setGoalNode(v_goal);
 
-    xy_planner.OpenSet.push_back(v2); xy_planner.ExploredSet.insert(v2);
-    xy_planner.OpenSet.push_back(v4); xy_planner.ExploredSet.insert(v4);
-    xy_planner.OpenSet.push_back(v5); xy_planner.ExploredSet.insert(v5);
-    xy_planner.OpenSet.push_back(v10); xy_planner.ExploredSet.insert(v10);
-    xy_planner.OpenSet.push_back(v11); xy_planner.ExploredSet.insert(v11);
-    xy_planner.OpenSet.push_back(v12); xy_planner.ExploredSet.insert(v12);
+    xy_planner.OpenSet.push(v2); xy_planner.ExploredSet.insert(v2);
+    xy_planner.OpenSet.push(v4); xy_planner.ExploredSet.insert(v4);
+    xy_planner.OpenSet.push(v5); xy_planner.ExploredSet.insert(v5);
+    xy_planner.OpenSet.push(v10); xy_planner.ExploredSet.insert(v10);
+    xy_planner.OpenSet.push(v11); xy_planner.ExploredSet.insert(v11);
+    xy_planner.OpenSet.push(v12); xy_planner.ExploredSet.insert(v12);
 
     xy_planner.ClosedSet.insert(v_start);
     xy_planner.ClosedSet.insert(v1);
@@ -183,12 +183,12 @@ int main(int argc, char **argv){
     }
 
     std::cout << "Explored Set" << std::endl;
-    for (std::set< std::shared_ptr<Node> >::iterator it = xy_planner.ExploredSet.begin(); it!=xy_planner.ExploredSet.end(); ++it){
+    for (NodeKeySet::iterator it = xy_planner.ExploredSet.begin(); it!=xy_planner.ExploredSet.end(); ++it){
         std::cout << (*it)->key << std::endl;
     }
 
     std::cout << "Closed Set" << std::endl;
-    for (std::set< std::shared_ptr<Node> >::iterator it = xy_planner.ClosedSet.begin(); it!=xy_planner.ClosedSet.end(); ++it){
+    for (NodeKeySet::iterator it = xy_planner.ClosedSet.begin(); it!=xy_planner.ClosedSet.end(); ++it){
         std::cout << (*it)->key << std::endl;
     }
 
@@ -213,12 +213,12 @@ int main(int argc, char **argv){
     }
 
     std::cout << "Explored Set" << std::endl;
-    for (std::set< std::shared_ptr<Node> >::iterator it = xy_planner.ExploredSet.begin(); it!=xy_planner.ExploredSet.end(); ++it){
+    for (NodeKeySet::iterator it = xy_planner.ExploredSet.begin(); it!=xy_planner.ExploredSet.end(); ++it){
         std::cout << (*it)->key << std::endl;
     }
 
     std::cout << "Closed Set" << std::endl;
-    for (std::set< std::shared_ptr<Node> >::iterator it = xy_planner.ClosedSet.begin(); it!=xy_planner.ClosedSet.end(); ++it){
+    for (NodeKeySet::iterator it = xy_planner.ClosedSet.begin(); it!=xy_planner.ClosedSet.end(); ++it){
         std::cout << (*it)->key << std::endl;
     }
 